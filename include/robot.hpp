@@ -0,0 +1,43 @@
+#pragma once
+
+#include "spf/robotConfig.hpp"
+
+// the robot as it's built: ports, geometry and drive curves. main.cpp makes everything from it,
+// tools/spf_pathc plans the paths for the same drivetrain, and tools/spf_tune scores its turns at
+// the same wheels
+constexpr spf::RobotConfig robot {
+    .leftDrive = {8, -10, 7, 6}, // front, middle, rear, back. Negative is reversed
+    .rightDrive = {-18, 20, -17, -16},
+    .cartridgeRpm = 600, // blue cartridges
+    .wheelDiameter = lemlib::Omniwheel::NEW_325, // using new 3.25" omnis
+    .wheelRpm = 600, // drivetrain rpm is 600
+    .trackWidth = 11, // 11 inch track width
+    .horizontalDrift = 2, // If we had traction wheels, it would have been 8
+    .halfLength = 9, // the 18" robot
+    .trackers = {{
+        {9, false, lemlib::Omniwheel::NEW_325, 5.5}, // right of the tracking center
+        {19, true, lemlib::Omniwheel::NEW_325, -5.5}, // left of it, reversed
+    }},
+    .imu = 1,
+    .frontRange = {11, 7, 0, 0}, // on the front bumper, 7" ahead of the tracking center, facing forwards
+    .leftRange = {12, 0, -6, 270}, // on the left side, 6" left of it, facing left
+    .wings1 = 'C',
+    .wings2 = 'A',
+    .intake = 'B',
+    .throttle = {3, 10, 1.019}, // deadband and minimum output out of 127, expo gain
+    .steer = {3, 10, 1.019},
+};
+static_assert(spf::smartPortsInRange(robot), "smart ports are 1 to 21");
+static_assert(spf::smartPortsUnique(robot), "two devices on the same smart port");
+static_assert(spf::adiPortsValid(robot), "pistons need three-wire ports 'A' to 'H', one each");
+static_assert(spf::drivetrainValid(robot), "drive cartridge, wheels or track width don't make a drivetrain");
+static_assert(spf::geometryValid(robot), "tracking wheels on the same side, or a distance sensor off the robot");
+static_assert(spf::curvesValid(robot), "drive curve deadband or minimum output outside 0 to 126");
+
+// the motion profile limits, for the routes and the paths spf_pathc compiles alike
+constexpr spf::DriveLimits driveLimits {
+    .speedHeadroom = 0.85, // 85% of the 102 in/s free speed
+    .maxAcceleration = 150,
+    .maxDeceleration = 150,
+    .maxLateralAcceleration = 80,
+};
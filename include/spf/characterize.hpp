@@ -0,0 +1,38 @@
+#pragma once
+
+#include "pros/motors.hpp"
+#include "spf/profile.hpp"
+
+namespace spf {
+
+/** the feedforward gains fitted by one characterization run */
+struct Characterization {
+        Feedforward left {};
+        Feedforward right {};
+        float leftFit = 0; // r^2, the share of the voltage the fit explains, 0 to 1
+        float rightFit = 0;
+        int samples = 0; // used in the fit, per side
+        bool valid = false; // enough samples, and gains a drive could have
+};
+
+/**
+ * Drive the robot through ramps and steps of voltage and fit kS, kV and kA for each side
+ *
+ * A quasistatic ramp raises the voltage slowly enough that the drive barely accelerates, which
+ * pins down kS and kV. A step of a fixed voltage accelerates it hard, which pins down kA. Each
+ * runs forwards and then backwards, so the robot ends up about where it started. The drive
+ * encoders are sampled every 10 ms, and each side is fitted by least squares to
+ * V = kS sgn(v) + kV v + kA a.
+ *
+ * It takes 12 s and needs 5 feet clear in front of the robot. Blocks until done, e.g. from autonomous.
+ *
+ * @param model the wheels the encoders are scaled by
+ */
+Characterization characterize(pros::MotorGroup& leftMotors, pros::MotorGroup& rightMotors, const DriveModel& model);
+
+/** write the fitted gains to a text file, e.g. on the SD card. Returns false if it can't be written */
+bool saveCharacterization(const char* name, const Characterization& fit);
+/** give the model the gains saved in a file. Returns false, leaving the model as it was, without a valid one */
+bool loadCharacterization(const char* name, DriveModel& model);
+
+} // namespace spf
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "pros/misc.hpp"
+#include "spf/inputRecord.hpp"
+#include "spf/recordLog.hpp"
+#include "spf/snapshot.hpp"
+
+namespace spf {
+
+/**
+ * The driver's controller, sampled once per tick and recorded, or played back from a recording
+ *
+ * A loop calls update() every 10 ms, ahead of the drive loop, and the drive loop reads the sample
+ * instead of the controller. Every sample goes into an input log on the SD card along with the
+ * robot's pose, so a run can be played back: replay() loads a log, and from the start of driver
+ * control update() takes the recorded samples one per tick instead of reading the controller.
+ * Autonomous plays back by running the recorded route. Moving a stick during a replay hands the
+ * robot back to the driver.
+ */
+class DriverInput {
+    public:
+        /**
+         * @param controller the driver's controller
+         * @param state where the robot's pose is published, recorded to compare replays against
+         */
+        DriverInput(pros::Controller& controller, const SeqLock<RobotState>& state);
+
+        /** start recording, see RecordLog::open */
+        bool record(const char* prefix);
+        /** write out recorded samples, from the logging task */
+        void flush() { log.flush(); }
+        /** load a recording to play back in driver control, false if it isn't one */
+        bool replay(const char* path);
+        /** the route the recording ran in autonomous, 0 if it didn't */
+        int replayRoute() const;
+        bool isReplaying() const { return replaying; }
+
+        /** what the robot is doing, recorded with every sample and used to line a replay up */
+        void setMode(InputMode mode, int route = 0);
+        /** take the next sample, every 10 ms */
+        void update();
+
+        /** stick position in the last sample, -127 to 127 */
+        int analog(pros::controller_analog_e_t axis) const;
+        /** whether a button was down in the last sample */
+        bool held(pros::controller_digital_e_t button) const;
+        /** whether a button went down in the last sample. True once per sample, for the drive loop */
+        bool newPress(pros::controller_digital_e_t button);
+
+        /** how far the replayed pose has been from the recorded one at worst, in inches */
+        float replayError() const { return maxError; }
+    private:
+        static constexpr int buttons = 12;
+        // a stick moved this far, out of 127, takes over from a replay
+        static constexpr int takeOver = 30;
+
+        pros::Controller& controller;
+        const SeqLock<RobotState>& state;
+        RecordLog<InputHeader, InputRecord, 256> log; // 2.5 s at 100 Hz
+        SeqLock<InputRecord> sample;
+        std::uint32_t consumed[buttons] {}; // sample version each button's press was last taken from
+        std::uint16_t previousHeld = 0;
+        std::atomic<InputMode> mode {InputMode::Disabled};
+        std::atomic<int> route {0};
+
+        std::vector<InputRecord> recording;
+        std::size_t next = 0; // next recorded sample to play back
+        bool started = false; // whether playback has reached driver control
+        std::atomic<bool> replaying {false};
+        float maxError = 0;
+};
+
+} // namespace spf
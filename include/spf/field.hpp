@@ -0,0 +1,17 @@
+#pragma once
+
+namespace spf {
+
+/** the field, in inches. It's 144 inches square with the origin in the middle */
+namespace field {
+
+constexpr float perimeter = 72; // the walls are at x and y = -72 and 72
+constexpr float tile = 24;
+constexpr float barrierHalfWidth = 0.7; // the long barrier, its faces are at x = -0.7 and 0.7
+constexpr float barrierHalfLength = 47;
+constexpr float goalDepth = 23; // the goals stand in front of the perimeter at x = -72 and 72
+constexpr float goalHalfWidth = 24;
+
+} // namespace field
+
+} // namespace spf
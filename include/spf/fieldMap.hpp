@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "display/lvgl.h"
+#include "spf/route.hpp"
+
+namespace spf {
+
+/**
+ * The field on the brain screen: the planned route, and the trail the odometry has driven
+ *
+ * Drawn into an LVGL canvas in three layers of pixels. The field and the planned routes are
+ * rendered once, when the routes change. The trail is drawn onto a copy of that, a segment at a
+ * time, and the canvas is that copy with the robot on top. Moving the robot restores the pixels
+ * under it from the layer below and invalidates only the boxes around where it was and where it
+ * is, so a frame costs the same however long the trail gets, and the parts of the screen that
+ * didn't change aren't redrawn at all.
+ */
+class FieldMap {
+    public:
+        static constexpr lv_coord_t size = 216; // px, the field is 144 inches square
+        static constexpr float scale = size / 144.0f; // px per inch
+        static constexpr std::size_t maxRoutes = 6;
+
+        /** @param robotHalfLength half the robot's length and width, in inches, how big it's drawn */
+        explicit FieldMap(float robotHalfLength) : robotHalfSize(robotHalfLength) {}
+
+        /** create the canvas on a parent, at x and y on the screen, hidden */
+        void attach(lv_obj_t* parent, lv_coord_t x, lv_coord_t y);
+        void setHidden(bool hidden);
+
+        /** plan no routes. The field is rendered again on the next update */
+        void clearPlan();
+        /** add a compiled route to the plan, e.g. each piece of skills in turn */
+        void plan(const Route& route);
+        /** start the trail over at the next update, e.g. as autonomous starts. Safe from any task */
+        void clearTrail() { clearRequested.store(true, std::memory_order_relaxed); }
+
+        /**
+         * move the robot to a pose from the odometry, in inches and degrees, extending the trail. Call
+         * from the screen loop, hidden or not, so the trail covers the whole run when the map is opened
+         */
+        void update(float x, float y, float theta);
+
+        lv_obj_t* canvas() const { return object; }
+        /** frames where the robot moved, and the pixels they redrew, whether the map was shown or not */
+        std::uint32_t frames() const { return drawn.load(std::memory_order_relaxed); }
+        std::uint32_t pixels() const { return invalidated.load(std::memory_order_relaxed); }
+    private:
+        using Layer = std::array<lv_color_t, size * size>;
+
+        /** a box of pixels, inclusive, clipped to the canvas */
+        struct Box {
+                lv_coord_t x1, y1, x2, y2;
+        };
+
+        void renderField();
+        void drawRoute(const Route& route);
+        void drawRobot(float x, float y, float theta);
+        /** copy a box of the background back into the canvas */
+        void restore(const Box& box);
+        void invalidate(const Box& box);
+
+        Layer field; // the field and the planned routes
+        Layer background; // and the trail
+        Layer buffer; // and the robot, what the canvas shows
+        const float robotHalfSize; // in
+        lv_obj_t* object = nullptr;
+        lv_coord_t screenX = 0, screenY = 0;
+        std::atomic<bool> hidden {true}; // set from the button callback, on LVGL's task
+
+        std::array<const Route*, maxRoutes> routes {};
+        std::size_t routeCount = 0;
+        bool fieldStale = true;
+        std::atomic<bool> clearRequested {false};
+
+        bool placed = false; // whether the robot has been drawn yet
+        float shownX = 0, shownY = 0, shownTheta = 0; // where it was drawn, in px and degrees
+        Box robot {}; // the pixels it covers
+        float trailX = 0, trailY = 0; // end of the trail, in px
+        bool trailStarted = false;
+
+        std::atomic<std::uint32_t> drawn {0};
+        std::atomic<std::uint32_t> invalidated {0};
+};
+
+} // namespace spf
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "pros/motors.hpp"
+#include "spf/snapshot.hpp"
+
+namespace spf {
+
+/** what the health monitor knows about one drive motor */
+struct MotorStatus {
+        float reported = 0; // C, as the motor reports it, in 5 C steps
+        float temperature = 0; // C, estimated between the steps
+        float current = 0; // A
+        float power = 0; // W
+        float efficiency = 0; // %
+        float timeToThrottle = 0; // s at the recent load, infinity if it never gets there
+};
+
+/** the drivetrain as a whole */
+struct HealthStatus {
+        std::array<MotorStatus, 8> motors {};
+        float maxTemperature = 0; // C, estimated
+        float timeToThrottle = 0; // s, the soonest of any motor
+        float currentLimit = 1; // fraction of the full 2.5 A the drive is derated to
+};
+
+/**
+ * First order thermal model of one motor, fitted as it runs
+ *
+ * The windings heat with the square of the current and cool towards the room:
+ * dT/dt = heating * I^2 - cooling * (T - ambient). The motor only reports temperature in 5 C
+ * steps, so the model fills in between them, and every time the reading steps the true
+ * temperature is known exactly; the heat that went in since the last step is one least squares
+ * sample for the two coefficients.
+ */
+class ThermalModel {
+    public:
+        /** @param ambient room temperature, C */
+        void reset(float ambient);
+        /**
+         * @param reported temperature the motor reports, C
+         * @param current A
+         * @param dt time since the last update, s
+         */
+        void update(float reported, float current, float dt);
+
+        /** estimated winding temperature, C */
+        float temperature() const { return estimate; }
+        /** how long until the motor reaches a temperature with a steady current, in seconds */
+        float timeTo(float target, float currentSquared) const;
+        /** steady current squared that brings the motor to a temperature in a time, A^2 */
+        float currentSquaredFor(float target, float time) const;
+
+        float heating = 0.08; // C per A^2 s, starting from what a V5 motor measures
+        float cooling = 0.004; // 1/s, a four minute time constant
+    private:
+        void fit(float error);
+
+        float ambient = 25;
+        float estimate = 0;
+        float lastReported = -1;
+        bool anchored = false; // whether the estimate has been pinned to a step yet
+        float anchor = 0; // C, the last step
+        // heat in since the last step, and the cooling integral over the same time
+        float heatSum = 0;
+        float coolSum = 0;
+        // least squares covariance of heating and cooling
+        std::array<float, 4> covariance {};
+};
+
+/**
+ * Samples all eight drive motors and keeps them out of firmware thermal throttling
+ *
+ * At 55 C the motor firmware halves the current, and the drivetrain collapses to half its torque
+ * without warning. Each motor's thermal model predicts when that happens at the recent load. When
+ * it would happen before the end of the run, the drive's current limit comes down smoothly until
+ * the hottest motor is predicted to just reach it at the end instead. Limiting current rather than
+ * voltage costs acceleration and pushing force, but keeps the top speed.
+ */
+class HealthMonitor {
+    public:
+        /**
+         * @param motors every drive motor
+         * @param leftMotors left side of the drivetrain, derated with the right so the robot still drives straight
+         * @param rightMotors right side of the drivetrain
+         */
+        HealthMonitor(const std::array<pros::Motor*, 8>& motors, pros::MotorGroup& leftMotors,
+                      pros::MotorGroup& rightMotors);
+
+        /** sample the motors and adjust the derating, every period milliseconds */
+        void update();
+        /** start derating for a run that ends in duration milliseconds, e.g. autonomous or driver control */
+        void startRun(std::uint32_t duration);
+        /** stop derating, the motors get their full current back on the next update */
+        void endRun();
+
+        /** the last sample, safe to read from any task */
+        HealthStatus status() const { return published.read(); }
+
+        static constexpr std::uint32_t period = 100; // ms
+    private:
+        void applyLimit(float limit);
+
+        std::array<pros::Motor*, 8> motors;
+        pros::MotorGroup& leftMotors;
+        pros::MotorGroup& rightMotors;
+        std::array<ThermalModel, 8> models {};
+        std::array<float, 8> currentSquared {}; // recent average, A^2
+        bool started = false;
+        std::uint32_t lastUpdate = 0;
+        std::atomic<std::uint32_t> runEnd {0}; // ms, 0 outside of a run
+        float limit = 1;
+        int appliedLimit = 2500; // mA
+        SeqLock<HealthStatus> published;
+};
+
+} // namespace spf
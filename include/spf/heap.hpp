@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+namespace spf {
+
+/** the heap allocations one task made while the guard was armed */
+struct HeapSite {
+        const char* task;
+        std::uint32_t allocations;
+        std::uint32_t bytes;
+        std::uint32_t first; // ms, when it made the first one
+};
+
+/** what the heap guard has seen since it was first armed */
+struct HeapStats {
+        static constexpr std::size_t maxSites = 8;
+
+        std::uint32_t allocations = 0;
+        std::uint32_t bytes = 0;
+        std::uint32_t sites = 0; // tasks recorded in site, the first ones to allocate
+        HeapSite site[maxSites] {};
+};
+
+/**
+ * Count every operator new from now on, e.g. as autonomous or driver control starts
+ *
+ * Everything the robot needs is allocated in initialize(): routes, paths, logs and queues are
+ * sized up front, so from the start of the match nothing should touch the heap. An allocation
+ * there takes an unbounded time on the kernel's allocator and fragments a heap that has to last a
+ * minute of skills. The guard replaces the global operator new, counts what gets allocated once it
+ * is armed and which tasks asked for it, so it can be tracked down. Arming it
+ * again, from driver control after autonomous, keeps counting.
+ */
+void armHeapGuard();
+HeapStats heapStats();
+/**
+ * write what the guard has seen, to a file and the telemetry sink. Formatting allocates, so take
+ * the stats first
+ */
+void dumpHeap(std::FILE* file = nullptr, const HeapStats& stats = heapStats());
+
+} // namespace spf
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+
+// layout of the driver input log. Shared by the robot and the host tools, so nothing here depends
+// on PROS. Both ends are little endian
+
+namespace spf {
+
+/** what the robot is doing when an input record is taken */
+enum class InputMode : std::uint8_t { Disabled, Autonomous, Driver };
+
+/** start of every input log */
+struct InputHeader {
+        char magic[4] = {'S', 'P', 'F', 'I'};
+        std::uint16_t version = 1;
+        std::uint16_t recordSize = 0; // bytes per record
+        std::uint32_t startTime = 0; // ms since the program started
+};
+
+/** one 10 ms sample of the controller, with the sensor readings a replay is compared against */
+struct InputRecord {
+        std::uint32_t time; // ms since the program started
+        std::int8_t axes[4]; // LX, LY, RX, RY
+        std::uint16_t held; // bit 0 L1 up to bit 11 A, in pros::controller_digital_e_t order
+        std::uint16_t pressed; // buttons that went down since the record before
+        InputMode mode;
+        std::uint8_t route; // autonRoute, while in autonomous
+        std::uint16_t battery; // mV
+        float x; // in
+        float y; // in
+        float theta; // deg
+};
+
+static_assert(sizeof(InputHeader) == 12, "the header is read back byte for byte");
+static_assert(sizeof(InputRecord) == 28, "the record is read back byte for byte");
+
+} // namespace spf
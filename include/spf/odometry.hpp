@@ -0,0 +1,141 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "lemlib/api.hpp"
+#include "spf/ringBuffer.hpp"
+#include "spf/snapshot.hpp"
+
+namespace spf {
+
+/** the fused pose and how far to trust it */
+struct OdometryStatus {
+        float x = 0; // in
+        float y = 0; // in
+        float theta = 0; // deg
+        // pose covariance: x, y in in^2, theta in deg^2, xy in in^2
+        float varianceX = 0;
+        float varianceY = 0;
+        float varianceTheta = 0;
+        float covarianceXY = 0;
+        float slip = 0; // drive wheel speed over ground speed, in/s. Positive when spinning forwards
+        bool slipping = false;
+        // the same for each side of the drive, against the ground under that side, and that ground speed
+        float leftSlip = 0; // in/s
+        float rightSlip = 0; // in/s
+        float leftSpeed = 0; // in/s
+        float rightSpeed = 0; // in/s
+        bool trackerFault = false; // a tracking wheel jumped or disconnected and is being ignored
+        std::uint32_t rangeFixes = 0; // wall distances fused into the pose, see Odometry::addRange
+        std::uint32_t rangeRejected = 0; // and turned away as too far from where the pose puts the wall
+};
+
+/** a distance measured off a wall whose place on the field is known, see Odometry::addRange */
+struct RangeFix {
+        float distance; // in, along the beam
+        float variance; // in^2
+        // where it was measured from on the robot
+        float forward; // in, ahead of the tracking center
+        float right; // in, right of the tracking center
+        float angle; // rad, the way the beam goes, clockwise from straight ahead
+        // the wall: the points (x, y) where nx x + ny y = c, with (nx, ny) a unit vector
+        float nx;
+        float ny;
+        float c;
+};
+
+/**
+ * how far one side of the drive has gone, in inches, like a tracking wheel on the group. Read
+ * motor by motor, the group's own reads return vectors, which allocate every tick
+ *
+ * @param inchesPerDegree how far the wheels roll per degree of the motors, see inchesPerMotorDegree
+ */
+float driveDistance(pros::MotorGroup& motors, float inchesPerDegree);
+/** how fast one side of the drive is going, in inches per second, read the same way */
+float driveVelocity(pros::MotorGroup& motors, float inchesPerDegree);
+
+/**
+ * Odometry from both tracking wheels, the IMU and the drive encoders
+ *
+ * A small Kalman filter over x, y and heading, run every 5 ms instead of LemLib's 10. The
+ * unpowered tracking wheels give the distance travelled and the change in heading. They don't
+ * slip, but they scrub a little in turns, so the heading is also pulled towards the IMU, which
+ * doesn't accumulate scale error. Nothing measures the robot sliding sideways on its omnis in
+ * turns, so that is predicted from the centripetal acceleration. The drive encoders are compared
+ * against the tracking wheels to detect wheel slip, and stand in for a tracking wheel that stops
+ * reading. Distances measured off the field walls, by addRange(), correct the position as well.
+ *
+ * The filter owns the pose and writes it into the chassis every update, so LemLib motions use
+ * it. A chassis.setPose() from anywhere else is picked up as a reset.
+ */
+class Odometry {
+    public:
+        /**
+         * @param chassis the chassis to keep the pose of. Don't calibrate it: that starts LemLib's own odometry
+         * @param drivetrain the drive motors and their wheels
+         * @param inchesPerDegree how far the wheels roll per degree of the drive motors, see inchesPerMotorDegree
+         * @param tracker1 one vertical tracking wheel
+         * @param tracker2 the other vertical tracking wheel, on the other side of the tracking center
+         * @param imu inertial sensor
+         * @param driftTime how far the robot slides outwards in turns: sideways speed over centripetal
+         * acceleration, in seconds. Drive circles and compare the odometry with where the robot ends up
+         * @param halfLength bumpers ahead and behind the tracking center, and the sides either side of it, in inches.
+         * The pose is kept that far inside the field walls
+         */
+        Odometry(lemlib::Chassis& chassis, const lemlib::Drivetrain& drivetrain, float inchesPerDegree,
+                 lemlib::TrackingWheel& tracker1, lemlib::TrackingWheel& tracker2, pros::Imu& imu, float driftTime,
+                 float halfLength);
+
+        /**
+         * calibrate the IMU and zero the encoders, blocking until done. An IMU that fails to
+         * calibrate a few times over is left out, and the heading comes from the tracking wheels
+         */
+        void calibrate();
+        /** fuse the sensors into the pose, every period milliseconds at a higher priority than anything that moves */
+        void update();
+
+        /**
+         * fuse a distance to a wall into the pose at the next update. From one other task, e.g. the
+         * relocalizer. Returns false if too many are already waiting
+         */
+        bool addRange(const RangeFix& fix) { return fixes.push(fix); }
+
+        /** the last update, safe to read from any task */
+        OdometryStatus status() const { return published.read(); }
+
+        static constexpr std::uint32_t period = 5; // ms
+    private:
+        void reset(const lemlib::Pose& pose);
+        bool applyRange(const RangeFix& fix);
+
+        lemlib::Chassis& chassis;
+        lemlib::TrackingWheel& tracker1;
+        lemlib::TrackingWheel& tracker2;
+        pros::MotorGroup& leftDrive;
+        pros::MotorGroup& rightDrive;
+        const float inchesPerDegree; // drive wheel inches per motor degree
+        const float halfTrack; // in
+        pros::Imu& imu;
+        const float driftTime;
+        const float wall; // in, the center can't get closer to the field walls than this
+
+        lemlib::Pose pose {0, 0, 0}; // compass heading in radians
+        lemlib::Pose written {0, 0, 0}; // what was last written into the chassis
+        std::array<float, 9> covariance {}; // x, y, theta, row major
+        float imuOffset = 0; // rad, pose heading minus IMU heading
+        std::array<float, 4> previous {}; // tracker1, tracker2, left drive, right drive, in
+        float slip = 0; // in/s
+        std::array<float, 2> sideSlip {}; // in/s, left and right
+        std::array<float, 2> sideSpeed {}; // in/s, left and right
+        float sideways = 0; // in/s, right is positive
+        std::uint32_t lastUpdate = 0;
+        bool calibrated = false;
+        bool imuOk = false; // the IMU calibrated and its heading is used
+        RingBuffer<RangeFix, 8> fixes;
+        std::uint32_t rangeFixes = 0;
+        std::uint32_t rangeRejected = 0;
+        SeqLock<OdometryStatus> published;
+};
+
+} // namespace spf
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// layout of the compiled path files tools/spf_pathc writes from path.jerryio text files. Shared by
+// the robot and the compiler, so nothing here depends on PROS. Both ends are little endian
+
+namespace spf {
+
+/** start of every compiled path */
+struct PathFileHeader {
+        char magic[4] = {'S', 'P', 'F', 'P'};
+        std::uint16_t version = 1;
+        std::uint16_t pointSize = 0; // bytes per point
+        std::uint32_t count = 0; // points
+        float spacing = 0; // distance between consecutive points, in inches
+        float length = 0; // in
+};
+
+/** one point of a compiled path. Points are evenly spaced, so point i is at i * spacing */
+struct PathFilePoint {
+        float x; // in
+        float y; // in
+        float distance; // along the path, in inches
+        float heading; // direction of travel, compass radians
+        float curvature; // 1/in, positive when curving to the right
+        float velocity; // planned speed, in/s
+        float acceleration; // planned acceleration along the path, in/s^2
+};
+
+static_assert(sizeof(PathFileHeader) == 20, "the header is read back byte for byte");
+static_assert(sizeof(PathFilePoint) == 28, "points are read back byte for byte");
+
+/**
+ * Read-only view of a compiled path, straight out of the embedded asset
+ *
+ * Nothing is parsed or copied up front. The asset isn't guaranteed to be aligned, so points are
+ * copied out one at a time.
+ */
+class PathFile {
+    public:
+        /**
+         * @param data the file
+         * @param size bytes in the file
+         */
+        PathFile(const std::uint8_t* data, std::size_t size)
+            : data(data) {
+            if (data == nullptr || size < sizeof(PathFileHeader)) return;
+            std::memcpy(&header, data, sizeof(header));
+            ok = std::memcmp(header.magic, PathFileHeader().magic, 4) == 0 && header.version == 1 &&
+                 header.pointSize == sizeof(PathFilePoint) && header.count >= 2 && header.spacing > 0 &&
+                 size >= sizeof(PathFileHeader) + std::size_t(header.count) * sizeof(PathFilePoint);
+        }
+
+        /** whether the file is a compiled path this program can read */
+        bool valid() const { return ok; }
+        std::size_t size() const { return ok ? header.count : 0; }
+        float spacing() const { return header.spacing; }
+        float length() const { return header.length; }
+
+        PathFilePoint at(std::size_t index) const {
+            PathFilePoint point;
+            std::memcpy(&point, data + sizeof(PathFileHeader) + index * sizeof(PathFilePoint), sizeof(point));
+            return point;
+        }
+
+        /** index of the last point at or before a distance along the path, clamped to the path */
+        std::size_t indexAt(float distance) const {
+            if (distance <= 0) return 0;
+            const std::size_t index = std::size_t(distance / header.spacing);
+            return index < header.count ? index : header.count - 1;
+        }
+    private:
+        const std::uint8_t* data;
+        PathFileHeader header {};
+        bool ok = false;
+};
+
+} // namespace spf
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "pros/adi.hpp"
+
+namespace spf {
+
+/**
+ * A pneumatic solenoid on an ADI port that remembers what it was last set to
+ *
+ * pros::ADIDigitalOut can't be read back, and the telemetry log records the state of every
+ * piston.
+ */
+class Piston {
+    public:
+        /**
+         * @param port ADI port, 'A' to 'H'
+         * @param initial state at startup
+         */
+        explicit Piston(std::uint8_t port, bool initial = false)
+            : output(port, initial),
+              state(initial) {}
+
+        void set_value(bool value) {
+            output.set_value(value);
+            state.store(value, std::memory_order_relaxed);
+        }
+
+        bool get_value() const { return state.load(std::memory_order_relaxed); }
+    private:
+        pros::ADIDigitalOut output;
+        std::atomic<bool> state;
+};
+
+} // namespace spf
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+
+namespace spf {
+
+/**
+ * inches a drive wheel rolls per degree its motor turns, geared from the cartridge's output to the
+ * wheels. The drive encoders are read in motor degrees
+ */
+constexpr float inchesPerMotorDegree(float wheelDiameter, float wheelRpm, float cartridgeRpm) {
+    return wheelDiameter * float(M_PI) * wheelRpm / cartridgeRpm / 360;
+}
+
+/** feedforward gains of one side of the drive */
+struct Feedforward {
+        float kS; // mV
+        float kV; // mV per in/s
+        float kA; // mV per in/s^2
+
+        /** voltage that drives the side at a velocity and acceleration, in millivolts */
+        float voltage(float velocity, float acceleration) const;
+};
+
+/**
+ * Drivetrain limits and feedforward gains used to plan and track motion profiles
+ *
+ * Both sides start out with the same kS, kV and kA. A characterization of the robot fits them
+ * side by side, see spf/characterize.hpp.
+ */
+class DriveModel {
+    public:
+        /**
+         * @param trackWidth distance between the left and right wheels, in inches
+         * @param wheelDiameter drive wheel diameter, in inches
+         * @param rpm drive wheel rpm
+         * @param cartridgeRpm output rpm of the drive motors' cartridges, 100, 200 or 600
+         * @param speedHeadroom fraction of the free speed profiles may use, so there is voltage left to correct
+         * @param maxAcceleration maximum acceleration, in inches per second squared
+         * @param maxDeceleration maximum deceleration, in inches per second squared
+         * @param maxLateralAcceleration maximum acceleration towards the center of a curve, in inches per second
+         * squared. Keeps the omnis from sliding sideways in curves
+         * @param kS voltage to overcome static friction, in millivolts
+         * @param kV voltage per unit of wheel velocity, in millivolts per inch per second
+         * @param kA voltage per unit of wheel acceleration, in millivolts per inch per second squared
+         * @param kATurn voltage per unit of wheel acceleration when the sides accelerate against each other to
+         * turn, in millivolts per inch per second squared. Larger than kA because the robot's inertia is spread
+         * out from its center
+         */
+        DriveModel(float trackWidth, float wheelDiameter, float rpm, float cartridgeRpm, float speedHeadroom,
+                   float maxAcceleration, float maxDeceleration, float maxLateralAcceleration, float kS, float kV,
+                   float kA, float kATurn);
+
+        /** wheel speed at the drivetrain rpm, in inches per second */
+        float freeSpeed() const;
+        /** fastest a profile may drive the wheels, in inches per second */
+        float maxVelocity() const;
+        /** inches the wheels roll per degree of the drive motors, what the encoders are scaled by */
+        float inchesPerDegree() const;
+        /** use gains fitted for each side. kS, kV and kA become their averages */
+        void setSides(const Feedforward& left, const Feedforward& right);
+
+        float trackWidth;
+        float wheelDiameter;
+        float rpm;
+        float cartridgeRpm;
+        float speedHeadroom;
+        float maxAcceleration;
+        float maxDeceleration;
+        float maxLateralAcceleration;
+        float kS;
+        float kV;
+        float kA;
+        float kATurn;
+        Feedforward left;
+        Feedforward right;
+};
+
+/** a point on a planned path, spaced evenly by distance */
+struct PathPoint {
+        float x;
+        float y;
+        float heading; // direction of travel, compass radians
+        float curvature; // 1/in, positive when curving to the right
+        float speedLimit; // in/s, the maxSpeed the step was given
+};
+
+/** the reference state of a profile at one control period */
+struct ProfileSample {
+        float x;
+        float y;
+        float theta; // robot heading, compass degrees
+        float distance; // progress along the path, in inches (degrees for turns)
+        float velocity; // signed robot velocity, in/s
+        float acceleration; // signed robot acceleration, in/s^2
+        float angularVelocity; // deg/s, clockwise positive
+        float angularAcceleration; // deg/s^2, clockwise positive
+};
+
+/**
+ * Time-parametrized reference for one continuous motion, sampled every control period
+ *
+ * Profiles are computed once, ahead of the motion, so tracking them is a table lookup.
+ */
+class Profile {
+    public:
+        /** time between samples, in milliseconds */
+        static constexpr int period = 10;
+
+        /** the sample at a time since the start of the profile, clamped to the last sample */
+        const ProfileSample& at(int time) const;
+        /** time at which the profile first reaches a distance, in milliseconds */
+        int timeAt(float distance) const;
+        /** length of the profile, in milliseconds */
+        int duration() const;
+        bool empty() const { return samples.empty(); }
+
+        std::vector<ProfileSample> samples;
+        float length = 0; // total distance, in inches (degrees for turns)
+};
+
+/**
+ * Sample a cubic bezier from one pose to another, tangent to both headings
+ *
+ * @param x1 start x
+ * @param y1 start y
+ * @param theta1 start heading, compass degrees
+ * @param x2 end x
+ * @param y2 end y
+ * @param theta2 end heading, compass degrees
+ * @param forwards whether the robot drives forwards along the path
+ * @param speedLimit maximum speed along this piece, in in/s
+ * @param wall furthest the path goes from the middle of the field in x or y, in inches. The ends
+ * should be inside it
+ * @param spacing distance between points, in inches
+ */
+std::vector<PathPoint> bezierPath(float x1, float y1, float theta1, float x2, float y2, float theta2, bool forwards,
+                                  float speedLimit, float wall, float spacing = 0.5);
+
+/**
+ * Time-optimal profile along a path that starts and ends at rest
+ *
+ * The velocity at every point is limited by the wheel speed of the outer side, the lateral
+ * acceleration in curves and the speed limit of the point, then a forward pass applies the
+ * acceleration limit and a backward pass the deceleration limit. On a straight line this is a
+ * trapezoidal profile.
+ *
+ * @param path closely spaced points
+ * @param forwards whether the robot drives forwards along the path
+ * @param model drivetrain limits
+ */
+Profile timeOptimalProfile(const std::vector<PathPoint>& path, bool forwards, const DriveModel& model);
+
+/**
+ * Speed at each point of a path that starts and ends at rest, under the same limits as
+ * timeOptimalProfile. Indexed by point rather than time, for followers that look the speed up by
+ * where the robot is, in inches per second
+ *
+ * @param path closely spaced points
+ * @param model drivetrain limits
+ */
+std::vector<float> pathVelocities(const std::vector<PathPoint>& path, const DriveModel& model);
+
+/**
+ * Trapezoidal profile for turning in place
+ *
+ * @param x x position to turn at
+ * @param y y position to turn at
+ * @param from start heading, compass degrees
+ * @param to end heading, compass degrees. The robot turns through to - from, so pass an unwrapped heading
+ * @param speedLimit maximum wheel speed, in in/s
+ * @param model drivetrain limits
+ */
+Profile turnProfile(float x, float y, float from, float to, float speedLimit, const DriveModel& model);
+
+} // namespace spf
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+
+#include "pros/rtos.hpp"
+#include "spf/scheduler.hpp"
+
+namespace spf {
+
+/**
+ * A hot piece of code timed with ScopedTimer, e.g. the arcade mix in the drive loop
+ *
+ * Regions are declared once at namespace scope and add themselves to a list that dumpRegions()
+ * writes out. Timing one costs two pros::micros() calls and a histogram update.
+ */
+class ProfileRegion {
+    public:
+        /**
+         * @param name shown in the stats
+         * @param budget longest a run should take, in microseconds, longer runs count as misses. 0
+         * for no budget
+         */
+        ProfileRegion(const char* name, std::uint32_t budget = 0);
+
+        void add(std::uint32_t us);
+        /** write the stats, to a file and the telemetry sink */
+        void write(std::FILE* file) const;
+        void clear();
+
+        static ProfileRegion* first() { return head; }
+        ProfileRegion* following() const { return next; }
+
+        const char* name;
+        std::uint32_t budget;
+        TimingHistogram time;
+        std::uint32_t misses = 0;
+        std::uint64_t started = 0; // us, when the first run since the stats were cleared started
+    private:
+        // constant initialized, so regions in other files can add themselves before main
+        static inline ProfileRegion* head = nullptr;
+        ProfileRegion* next = nullptr;
+};
+
+/**
+ * Times the rest of the enclosing scope into a region
+ */
+class ScopedTimer {
+    public:
+        explicit ScopedTimer(ProfileRegion& region)
+            : region(region),
+              start(pros::micros()) {
+            if (region.started == 0) region.started = start;
+        }
+
+        ~ScopedTimer() { region.add(pros::micros() - start); }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+    private:
+        ProfileRegion& region;
+        std::uint64_t start;
+};
+
+/** write the stats of every region that has run, to a file and the telemetry sink */
+void dumpRegions(std::FILE* file = nullptr);
+/** reset the stats of every region, e.g. at the start of a match */
+void clearRegions();
+
+} // namespace spf
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+
+#include "pros/rtos.hpp"
+#include "spf/ringBuffer.hpp"
+
+namespace spf {
+
+/**
+ * Binary log of fixed size records on the SD card
+ *
+ * The control loop pushes records into a lock-free ring, which never blocks it. A low priority
+ * task drains the ring and writes it out in blocks of a few kilobytes, because the SD card is slow
+ * and every write costs about the same however small it is. If the writer falls far enough behind
+ * that the ring fills up, new records are dropped and counted.
+ *
+ * Header needs recordSize and startTime fields, the rest of it is written as constructed.
+ */
+template <typename Header, typename Record, std::size_t capacity> class RecordLog {
+    public:
+        /**
+         * Start a new log in the first free file named prefix_000.bin, prefix_001.bin, ...
+         *
+         * @param prefix path and start of the file name, e.g. "/usd/telemetry"
+         * @return false if the file couldn't be created, e.g. there is no SD card
+         */
+        bool open(const char* prefix) {
+            char path[64];
+            for (int i = 0; i < 1000; i++) {
+                std::snprintf(path, sizeof(path), "%s_%03d.bin", prefix, i);
+                // the file system can't list directories, so look for a name that doesn't open
+                std::FILE* existing = std::fopen(path, "rb");
+                if (existing != nullptr) {
+                    std::fclose(existing);
+                    continue;
+                }
+                file = std::fopen(path, "wb");
+                if (file == nullptr) return false;
+                Header header;
+                header.recordSize = sizeof(Record);
+                header.startTime = pros::millis();
+                std::fwrite(&header, sizeof(header), 1, file);
+                std::fflush(file);
+                lastWrite = header.startTime;
+                return true;
+            }
+            return false;
+        }
+
+        bool isOpen() const { return file != nullptr; }
+
+        /** queue a record, from the one task that logs. Never blocks */
+        void push(const Record& record) {
+            if (file == nullptr) return;
+            if (!ring.push(record)) droppedRecords.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /** write out queued records, from the flush task */
+        void flush() {
+            if (file == nullptr) return;
+            // full blocks as they fill up, and whatever is left once it has waited long enough, so a
+            // power cut loses at most that much
+            const bool all = pros::millis() - lastWrite >= maxWait;
+            bool wrote = false;
+            while (ring.size() >= block.size() || (all && ring.size() > 0)) {
+                const std::size_t count = ring.pop(block.data(), block.size());
+                writtenRecords += std::fwrite(block.data(), sizeof(Record), count, file);
+                wrote = true;
+            }
+            if (!wrote) return;
+            // the brain only commits data to the card on a flush or close
+            std::fflush(file);
+            lastWrite = pros::millis();
+        }
+
+        /** records lost because the ring was full */
+        std::uint32_t dropped() const { return droppedRecords.load(std::memory_order_relaxed); }
+        /** records written to the file */
+        std::uint32_t written() const { return writtenRecords; }
+    private:
+        static constexpr std::size_t blockRecords = 4096 / sizeof(Record); // 4 KB per write
+        static constexpr std::uint32_t maxWait = 1000; // longest a partial block waits, in milliseconds
+
+        RingBuffer<Record, capacity> ring;
+        std::array<Record, blockRecords> block {};
+        std::FILE* file = nullptr;
+        std::atomic<std::uint32_t> droppedRecords {0};
+        std::uint32_t writtenRecords = 0;
+        std::uint32_t lastWrite = 0;
+};
+
+} // namespace spf
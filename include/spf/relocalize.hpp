@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "lemlib/api.hpp"
+#include "pros/distance.hpp"
+#include "spf/odometry.hpp"
+
+namespace spf {
+
+/** where a wall was hit, see wallAlong */
+struct WallHit {
+        float distance = 0; // in along the ray
+        // the wall: the points (x, y) where nx x + ny y = c
+        float nx = 0;
+        float ny = 0;
+        float c = 0;
+        // false when the ray hits a goal, or so near the end of a wall that a little pose error
+        // could mean it misses
+        bool usable = false;
+};
+
+/**
+ * the nearest wall of the field along a ray from (x, y) on a compass heading, in inches and
+ * radians. The map is the perimeter and the long barrier down the middle, with the goals in
+ * front of the perimeter at either end. A distance of 0 means nothing was hit
+ */
+WallHit wallAlong(float x, float y, float heading);
+
+/** a distance sensor on the robot */
+struct RangeSensor {
+        pros::Distance* sensor;
+        float forward; // in, ahead of the tracking center
+        float right; // in, right of the tracking center
+        float angle; // deg, the way it faces, clockwise from straight ahead
+};
+
+/**
+ * Corrects the odometry against the field walls while the robot drives
+ *
+ * Every update, each distance sensor with a new, confident reading is matched against the wall
+ * the pose says it faces, and the distance goes to the odometry as a fix. Readings that can't be
+ * trusted are left out: too far, too glancing, off a goal, taken while the robot moved too fast
+ * for the sensor's latency, or so far from the expected wall that they must be off a robot or a
+ * triball in the way. The odometry gates them again against the pose's own uncertainty.
+ *
+ * The drive's current also gives the robot away when it pushes into a wall: the motors draw
+ * stall current while the tracking wheels say it isn't moving. Once per stall, if the pose puts a
+ * wall at the bumper ahead (or behind, when pushing backwards), the bumper is on it, which fixes
+ * the pose to within the wall's flex.
+ */
+class Relocalizer {
+    public:
+        /**
+         * @param odometry the pose to correct
+         * @param drivetrain the drive motors, for the current they draw, and the track width
+         * @param sensors the distance sensors
+         * @param bumper how far the bumpers are ahead and behind the tracking center, in inches
+         */
+        Relocalizer(Odometry& odometry, const lemlib::Drivetrain& drivetrain, std::vector<RangeSensor> sensors,
+                    float bumper);
+
+        /** every period milliseconds, from one task */
+        void update();
+
+        /** times pushing into a wall fixed the pose, since the program started */
+        std::uint32_t bumps() const { return bumpCount.load(std::memory_order_relaxed); }
+
+        static constexpr std::uint32_t period = 20; // ms
+    private:
+        float driveCurrent(pros::MotorGroup& motors) const;
+        float driveVoltage(pros::MotorGroup& motors) const;
+
+        Odometry& odometry;
+        pros::MotorGroup& leftDrive;
+        pros::MotorGroup& rightDrive;
+        const float trackWidth; // in
+        const std::vector<RangeSensor> sensors;
+        const float bumper;
+
+        std::vector<std::int32_t> last; // mm, the reading each sensor was last used at
+        std::uint32_t stalled = 0; // ms the drive has been pushing against something
+        bool bumped = false; // the stall has already fixed the pose
+        std::atomic<std::uint32_t> bumpCount {0};
+};
+
+} // namespace spf
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+namespace spf {
+
+/**
+ * Fixed size lock-free queue with one producer task and one consumer task
+ *
+ * Neither side ever waits for the other: push() fails when the queue is full and pop() returns
+ * whatever is there. The indices only ever count up and wrap with the capacity, which is a power
+ * of two so the wrap is a mask.
+ */
+template <typename T, std::size_t N> class RingBuffer {
+        static_assert(N > 0 && (N & (N - 1)) == 0, "the capacity must be a power of two");
+        static_assert(std::is_trivially_copyable_v<T>, "items are copied in and out");
+    public:
+        /** add an item, from the producer. Returns false and drops it if the queue is full */
+        bool push(const T& item) {
+            const std::size_t head = written.load(std::memory_order_relaxed);
+            if (head - read.load(std::memory_order_acquire) == N) return false;
+            items[head & (N - 1)] = item;
+            written.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        /** take up to count items, oldest first, from the consumer. Returns how many it took */
+        std::size_t pop(T* out, std::size_t count) {
+            const std::size_t tail = read.load(std::memory_order_relaxed);
+            const std::size_t available = written.load(std::memory_order_acquire) - tail;
+            count = std::min(count, available);
+            for (std::size_t i = 0; i < count; i++) out[i] = items[(tail + i) & (N - 1)];
+            read.store(tail + count, std::memory_order_release);
+            return count;
+        }
+
+        std::size_t size() const {
+            return written.load(std::memory_order_acquire) - read.load(std::memory_order_acquire);
+        }
+
+        static constexpr std::size_t capacity() { return N; }
+    private:
+        std::array<T, N> items {};
+        std::atomic<std::size_t> written {0};
+        std::atomic<std::size_t> read {0};
+};
+
+} // namespace spf
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+#include "lemlib/chassis/chassis.hpp"
+#include "pros/motors.hpp"
+#include "spf/profile.hpp"
+
+namespace spf {
+
+/** a drive curve like LemLib's ExpoDriveCurve, with a whole number deadband so it can be tabled */
+struct CurveConfig {
+        int deadband; // out of 127
+        int minOutput; // out of 127, the least the drivetrain is asked for once past the deadband
+        float gain; // expo curve gain
+};
+
+/** what the motion profiles are planned within, see DriveModel */
+struct DriveLimits {
+        float speedHeadroom; // share of the free speed the profiles use, the rest is for corrections
+        float maxAcceleration; // in/s^2
+        float maxDeceleration; // in/s^2
+        float maxLateralAcceleration; // in curves, in/s^2
+};
+
+/** a tracking wheel on a rotation sensor */
+struct TrackerConfig {
+        int port;
+        bool reversed; // negative ports don't work for rotation sensors, a PROS bug
+        float diameter; // in
+        float offset; // in, right of the tracking center is positive
+};
+
+/** a distance sensor ranging off the field walls, see Relocalizer */
+struct RangeConfig {
+        int port;
+        float forward; // in, ahead of the tracking center
+        float right; // in, right of the tracking center
+        float angle; // deg, the way it faces, clockwise from straight ahead
+};
+
+/**
+ * Everything about the robot that's fixed when it's built: its ports, its geometry and how the
+ * sticks drive it
+ *
+ * robot.hpp describes the robot with one constexpr RobotConfig, and main.cpp makes the devices,
+ * the drivetrain and the drive model from it. The checks below are static_asserted next to it, so
+ * a port used twice or a tracking wheel on the wrong side fails the build instead of the robot.
+ */
+struct RobotConfig {
+        std::array<int, 4> leftDrive; // smart ports, negative for reversed motors
+        std::array<int, 4> rightDrive;
+        int cartridgeRpm; // 100, 200 or 600
+        float wheelDiameter; // in
+        float wheelRpm;
+        float trackWidth; // in
+        float horizontalDrift;
+        float halfLength; // in, bumpers ahead and behind the tracking center, and the sides either side of it
+        std::array<TrackerConfig, 2> trackers; // vertical, either side of the tracking center
+        int imu;
+        RangeConfig frontRange;
+        RangeConfig leftRange;
+        // three-wire ports, 'A' to 'H'
+        char wings1;
+        char wings2;
+        char intake;
+        CurveConfig throttle;
+        CurveConfig steer;
+
+        constexpr pros::motor_gearset_e_t gearset() const {
+            return cartridgeRpm == 100 ? pros::E_MOTOR_GEARSET_36
+                 : cartridgeRpm == 600 ? pros::E_MOTOR_GEARSET_06
+                                       : pros::E_MOTOR_GEARSET_18;
+        }
+
+        /** drive wheel inches per degree of the drive motors, for the encoders */
+        constexpr float inchesPerDegree() const { return inchesPerMotorDegree(wheelDiameter, wheelRpm, cartridgeRpm); }
+
+        /** every smart port, reversed or not */
+        constexpr std::array<int, 13> smartPorts() const {
+            std::array<int, 13> ports {};
+            std::size_t i = 0;
+            for (int port : leftDrive) ports[i++] = port < 0 ? -port : port;
+            for (int port : rightDrive) ports[i++] = port < 0 ? -port : port;
+            for (const TrackerConfig& tracker : trackers) ports[i++] = tracker.port;
+            ports[i++] = imu;
+            ports[i++] = frontRange.port;
+            ports[i++] = leftRange.port;
+            return ports;
+        }
+};
+
+namespace config {
+
+template <typename T, std::size_t N> constexpr bool unique(const std::array<T, N>& values) {
+    for (std::size_t i = 0; i < N; i++) {
+        for (std::size_t j = i + 1; j < N; j++) {
+            if (values[i] == values[j]) return false;
+        }
+    }
+    return true;
+}
+
+constexpr bool inside(const RobotConfig& robot, const RangeConfig& range) {
+    return range.forward >= -robot.halfLength && range.forward <= robot.halfLength &&
+           range.right >= -robot.halfLength && range.right <= robot.halfLength;
+}
+
+constexpr bool curveValid(const CurveConfig& curve) {
+    return curve.deadband >= 0 && curve.deadband < 127 && curve.minOutput >= 0 && curve.minOutput < 127 &&
+           curve.gain > 0;
+}
+
+} // namespace config
+
+/** every smart port is 1 to 21 */
+constexpr bool smartPortsInRange(const RobotConfig& robot) {
+    const auto ports = robot.smartPorts();
+    return std::all_of(ports.begin(), ports.end(), [](int port) { return port >= 1 && port <= 21; });
+}
+
+/** no two devices share a smart port */
+constexpr bool smartPortsUnique(const RobotConfig& robot) { return config::unique(robot.smartPorts()); }
+
+/** the pistons are on three-wire ports 'A' to 'H', one each */
+constexpr bool adiPortsValid(const RobotConfig& robot) {
+    const std::array<char, 3> ports = {robot.wings1, robot.wings2, robot.intake};
+    return std::all_of(ports.begin(), ports.end(), [](char port) { return port >= 'A' && port <= 'H'; }) &&
+           config::unique(ports);
+}
+
+/** a cartridge the motors come with, and wheels that turn */
+constexpr bool drivetrainValid(const RobotConfig& robot) {
+    return (robot.cartridgeRpm == 100 || robot.cartridgeRpm == 200 || robot.cartridgeRpm == 600) &&
+           robot.wheelDiameter > 0 && robot.wheelRpm > 0 && robot.trackWidth > 0 &&
+           robot.trackWidth < 2 * robot.halfLength;
+}
+
+/**
+ * the tracking wheels turn and sit on opposite sides of the tracking center, which the odometry
+ * divides by the distance between, and the distance sensors are on the robot
+ */
+constexpr bool geometryValid(const RobotConfig& robot) {
+    const TrackerConfig& a = robot.trackers[0];
+    const TrackerConfig& b = robot.trackers[1];
+    return a.diameter > 0 && b.diameter > 0 && a.offset * b.offset < 0 && config::inside(robot, robot.frontRange) &&
+           config::inside(robot, robot.leftRange);
+}
+
+/** deadbands and minimum outputs within the stick's 127, and a gain that curves the right way */
+constexpr bool curvesValid(const RobotConfig& robot) {
+    return config::curveValid(robot.throttle) && config::curveValid(robot.steer);
+}
+
+/**
+ * LemLib's ExpoDriveCurve for the sticks, looked up instead of computed
+ *
+ * The controller's sticks only read whole numbers from -127 to 127, so the curve is worked out
+ * at each of them when the program is built and a stick position is a read from the table, not
+ * two pows. With a whole number deadband the curve's exponents are whole numbers too, so it's
+ * the same curve LemLib computes, to float rounding.
+ */
+class DriveCurveTable : public lemlib::DriveCurve {
+    public:
+        constexpr explicit DriveCurveTable(const CurveConfig& config) {
+            // out of 127, the same steps as ExpoDriveCurve::curve
+            const int g127 = 127 - config.deadband;
+            const double i127 = power(config.gain, g127 - 127) * g127;
+            for (int input = -127; input <= 127; input++) {
+                const int magnitude = input < 0 ? -input : input;
+                const int sign = input < 0 ? -1 : 1;
+                float& out = table[input + 127];
+                if (magnitude <= config.deadband) {
+                    out = 0;
+                    continue;
+                }
+                const int g = magnitude - config.deadband;
+                const double i = power(config.gain, g - 127) * g * sign;
+                out = float((127.0 - config.minOutput) / 127 * i * 127 / i127 + config.minOutput * sign);
+            }
+        }
+
+        float curve(float input) override {
+            const int index = int(std::clamp(input, -127.0f, 127.0f) + (input < 0 ? -0.5f : 0.5f));
+            return table[index + 127];
+        }
+
+        /** the curve at each stick position, -127 first */
+        const std::array<float, 255>& values() const { return table; }
+    private:
+        /** base to a whole power, negative or not */
+        static constexpr double power(double base, int exponent) {
+            double result = 1;
+            for (int i = 0; i < (exponent < 0 ? -exponent : exponent); i++) result *= base;
+            return exponent < 0 ? 1 / result : result;
+        }
+
+        std::array<float, 255> table {};
+};
+
+} // namespace spf
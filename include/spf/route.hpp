@@ -0,0 +1,239 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+#include "lemlib/api.hpp"
+#include "pros/motors.hpp"
+#include "pros/rtos.hpp"
+#include "spf/piston.hpp"
+#include "spf/profile.hpp"
+#include "spf/telemetryRecord.hpp"
+
+namespace spf {
+
+enum class StepType {
+    SetPose,
+    SetX,
+    Move,
+    Turn,
+    WaitUntil,
+    WaitFraction,
+    WaitUntilDone,
+    After,
+    WaitFor,
+    Delay,
+    Output,
+    Follow
+};
+
+/** options for moveTo and turnTo, like lemlib::MoveToPoseParams */
+struct MoveOptions {
+        bool forwards = true;
+        float maxSpeed = 127; // out of 127, scales the fastest the profile may drive
+        bool reactive = false; // run the LemLib motion instead of a profile, e.g. to push against something
+        int timeout = 2000; // timeout of reactive motions, in milliseconds
+        // hand off to the next motion this far before the target (degrees for turns), without stopping. A
+        // move followed by a turn and another move rounds the corner off; reactive motions pass it to LemLib
+        // as earlyExitRange
+        float exitRadius = 0;
+        float minSpeed = 0; // out of 127, reactive motions only
+};
+
+/**
+ * One entry of a route table
+ *
+ * Steps mirror the chassis calls routes used to be written with: motions are asynchronous, so
+ * an output right after a motion happens as the motion starts, after waitUntil(d) once the
+ * motion has gone d inches (or degrees), and after waitUntilDone() when it arrives and stops.
+ * after() holds outputs back further without holding up the motions after them: the outputs
+ * happen in the background while the robot carries on with the route. waitFor() stops the robot
+ * at the end of the motion, like waitUntilDone(), then holds the outputs after it back until its
+ * condition holds, again without holding up the motions after them.
+ */
+struct Step {
+        StepType type;
+        float x = 0;
+        float y = 0;
+        float theta = 0;
+        MoveOptions options {};
+        Piston* output = nullptr;
+        bool value = false;
+        int time = 0; // Delay and After length, Follow timeout, in milliseconds
+        const asset* path = nullptr;
+        float lookahead = 0;
+        std::function<void()> action {}; // Output steps that run code instead of setting a piston
+        std::function<bool()> condition {}; // WaitFor, and Output steps waiting on it
+};
+
+/** set the odometry pose, in inches and degrees */
+Step setPose(float x, float y, float theta);
+/** set the odometry x, e.g. after squaring up against the center barrier */
+Step setX(float x);
+/** move to a pose, turning in place when x and y are where the robot already is */
+Step moveTo(float x, float y, float theta, MoveOptions options = {});
+/** turn in place to a heading, in degrees */
+Step turnTo(float theta, MoveOptions options = {});
+/** hold the next outputs until the last motion has gone a distance, in inches (degrees for turns) */
+Step waitUntil(float distance);
+/** hold the next outputs until the last motion has gone a fraction of the way, 0 to 1 */
+Step waitUntilFraction(float fraction);
+/** stop at the end of the last motion, and hold the next outputs until the robot is there */
+Step waitUntilDone();
+/**
+ * hold the next outputs a while longer, in milliseconds, counted from where they would have
+ * happened. Unlike delay() the robot doesn't stop
+ */
+Step after(int time);
+/**
+ * stop at the end of the last motion, and hold the next outputs until a condition holds, e.g. a
+ * sensor reading. The motions after it don't wait for the condition
+ */
+Step waitFor(std::function<bool()> condition);
+/** stop and wait, in milliseconds */
+Step delay(int time);
+/** set a pneumatic output */
+Step set(Piston& output, bool value);
+/** run an action like an output, e.g. to start a subsystem. It must not block */
+Step call(std::function<void()> action);
+/**
+ * follow a compiled path, static/<name>.bin from tools/spf_pathc. A robot beside the path steers back
+ * as pure pursuit would for a point lookahead inches down it
+ */
+Step follow(const asset& path, float lookahead, int timeout, bool forwards = true);
+
+/** an output to set when a motion reaches a distance */
+struct Marker {
+        float distance;
+        Piston* output;
+        bool value;
+        std::function<void()> action; // run instead of setting output
+        int delay = 0; // milliseconds after the distance is reached
+        std::function<bool()> condition; // and not before this holds
+
+        void fire() const {
+            if (action) action();
+            else if (output != nullptr) output->set_value(value);
+        }
+};
+
+/** a corner a profile rounds off instead of stopping to turn in place */
+struct Transition {
+        int corner; // which chainable corner of the route this is, in order
+        float start; // where the profile leaves the incoming move, in inches
+        float end; // where it joins the outgoing move, in inches
+        int savedTime; // planned time saved over stopping at the corner, in milliseconds
+};
+
+/** one piece of a compiled route */
+struct Segment {
+        enum class Kind { Step, Profile, Turn };
+        Kind kind;
+        Step step {StepType::Delay}; // the step to run as is, for Kind::Step
+        Profile profile {};
+        std::vector<Marker> markers {}; // sorted by distance, for profiles, turns and followed paths
+        std::vector<Transition> transitions {}; // sorted by distance
+};
+
+/**
+ * A named route and its compiled form
+ *
+ * Compiling walks the steps from the route's start pose and merges consecutive moves in the
+ * same direction into one profile, so the robot only stops where the route needs it to: turns,
+ * delays, changes of direction and reactive motions. A turn between two moves is chained into an
+ * arc when the move before it has an exit radius. Outputs become markers on the profile, turn or
+ * followed path they happen during.
+ */
+class Route {
+    public:
+        /**
+         * @param id the number autonRoute selects the route with
+         * @param name shown on the brain screen
+         * @param steps the route
+         */
+        Route(int id, const char* name, std::vector<Step> steps);
+
+        /**
+         * compile the steps into profiles, ahead of autonomous
+         *
+         * @param halfLength bumpers ahead and behind the tracking center, in inches. Paths keep the
+         * robot that far off the field walls
+         * @param start where the route starts, in inches and degrees, unless it sets a pose. A route run
+         * after another starts where that one ends
+         */
+        void compile(const DriveModel& model, float halfLength, const lemlib::Pose& start = lemlib::Pose(0, 0, 0));
+        /** where the compiled route leaves the robot, in inches and degrees */
+        lemlib::Pose endPose() const { return end; }
+        bool isCompiled() const { return compiled; }
+        /** how long the profiled parts of the route take, in milliseconds */
+        int plannedTime() const;
+        /** planned time chaining saves over stopping at every corner, in milliseconds */
+        int savedTime() const;
+
+        int id;
+        const char* name;
+        std::vector<Step> steps;
+        std::vector<Segment> segments;
+    private:
+        bool compiled = false;
+        lemlib::Pose end {0, 0, 0};
+};
+
+/**
+ * Runs compiled routes, tracking profiles with feedforward and RAMSETE pose feedback
+ *
+ * Outputs held back by after() or waitFor() are handed to updateActions(), which is called from
+ * its own loop, so they happen on time whatever motion the route has moved on to.
+ */
+class RouteRunner {
+    public:
+        /**
+         * @param chassis the chassis whose odometry is tracked, and which runs reactive motions
+         * @param leftMotors left side of the drivetrain
+         * @param rightMotors right side of the drivetrain
+         * @param model drivetrain limits and feedforward gains, the same ones the routes are compiled with
+         */
+        RouteRunner(lemlib::Chassis& chassis, pros::MotorGroup& leftMotors, pros::MotorGroup& rightMotors,
+                    const DriveModel& model);
+
+        /**
+         * run a compiled route, blocking until it is done. One that isn't compiled yet is skipped:
+         * compiling here would race the startup task compiling it, and allocate in autonomous
+         */
+        void run(const Route& route);
+        /** Profile, Turn or Path while tracking one, otherwise None */
+        Motion activeMotion() const { return motion.load(std::memory_order_relaxed); }
+        /** take the held back outputs that are due, call every 10 ms */
+        void updateActions();
+        /** drop the held back outputs, e.g. when autonomous ends */
+        void cancelActions();
+    private:
+        /** an output waiting in the background, in the compiled route */
+        struct Pending {
+                const Marker* marker;
+                std::uint32_t due; // ms
+        };
+        // outputs that can wait at once. A fixed pool, so nothing allocates during a match
+        static constexpr std::size_t maxPending = 16;
+
+        void runStep(const Step& step);
+        void track(const Segment& segment);
+        void follow(const Segment& segment);
+        /** a motion has reached a marker: fire it, or hold it back until it is due */
+        void reach(const Marker& marker);
+        /** drive the sides at velocities, in in/s. Returns how far the wheels were off them, rms of the sides */
+        float drive(float leftVelocity, float rightVelocity, float acceleration, float turnAcceleration);
+
+        lemlib::Chassis& chassis;
+        pros::MotorGroup& leftMotors;
+        pros::MotorGroup& rightMotors;
+        const DriveModel& model;
+        std::atomic<Motion> motion {Motion::None};
+        std::array<Pending, maxPending> pending {};
+        std::size_t pendingCount = 0;
+        pros::Mutex pendingMutex;
+};
+
+} // namespace spf
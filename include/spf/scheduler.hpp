@@ -0,0 +1,128 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+
+#include "pros/apix.h"
+#include "pros/rtos.hpp"
+
+namespace spf {
+
+/**
+ * Counts of durations in fixed microsecond buckets, cheap enough to update every tick
+ */
+class TimingHistogram {
+    public:
+        /** upper edges of the buckets, in microseconds. Anything longer goes in the last bucket */
+        static constexpr std::array<std::uint32_t, 9> edges {50, 100, 250, 500, 1000, 2000, 5000, 10000, 20000};
+
+        void add(std::uint32_t us);
+        void write(std::FILE* file, const char* label) const;
+
+        std::array<std::uint32_t, edges.size() + 1> counts {};
+        std::uint32_t count = 0;
+        std::uint32_t max = 0;
+        std::uint64_t total = 0;
+};
+
+/** a periodic job and how well it has kept to its period */
+struct Job {
+        const char* name;
+        std::uint32_t period; // ms
+        std::uint32_t priority;
+        std::function<void()> function;
+        bool here = false; // run by runHere() rather than on a task of its own
+
+        TimingHistogram jitter {}; // how late each tick started
+        TimingHistogram runtime {}; // how long each tick ran
+        std::uint32_t overruns = 0; // ticks that ran longer than the period
+        std::uint32_t skipped = 0; // periods dropped to catch up after an overrun
+        std::uint64_t started = 0; // us, when the first tick since the stats were cleared started
+
+        const pros::c::task_stack_t* stack = nullptr; // the task's stack if the scheduler made it, else not measured
+        std::uint32_t stackSize = 0; // bytes in the task's stack, 0 when not measured
+        std::uint32_t stackUsed = 0; // most of it ever used, bytes
+
+        /**
+         * share of the time since the stats were cleared that its ticks took, 0 to 1
+         *
+         * A tick is timed from start to end, so time a higher priority task preempted it for counts
+         * towards this job as well as that task, and the shares of all the jobs can add up past 1.
+         */
+        float cpu() const;
+};
+
+/**
+ * Runs periodic jobs at fixed rates
+ *
+ * Each job wakes on a fixed grid of its period (delay-until), so the loop body and preemption
+ * don't stretch the period the way pros::delay does. Every tick records how late it started and
+ * how long it ran; dump() writes the histograms out, e.g. from disabled() after a match.
+ *
+ * A job from every() runs on a task whose stack the scheduler owns and fills with a pattern before
+ * the task starts, and about once a second the job counts how much of it, from the far end, still
+ * holds the pattern. runHere() runs on a task PROS made, whose stack isn't the scheduler's to
+ * read, so its stack isn't measured.
+ */
+class Scheduler {
+    public:
+        /**
+         * Run a job on its own task
+         *
+         * @param name shown in the stats
+         * @param period time between ticks, in milliseconds
+         * @param priority task priority, TASK_PRIORITY_MIN to TASK_PRIORITY_MAX
+         * @param function the tick
+         *
+         * A name already in use, or a job past maxJobs, is refused with a post to the text log and
+         * no task is started.
+         */
+        void every(const char* name, std::uint32_t period, std::uint32_t priority, std::function<void()> function);
+        /**
+         * Run a job on the calling task until the task is deleted, e.g. the drive loop in opcontrol,
+         * which the competition control ends by deleting the task. Running the same name again
+         * from runHere() keeps adding to its stats, so only one task may run a name at a time: the
+         * one before must have been deleted, as competition tasks are. A name every() uses, or a
+         * job past maxJobs, is refused with a post to the text log and returns straight away
+         */
+        void runHere(const char* name, std::uint32_t period, std::uint32_t priority, std::function<void()> function);
+
+        /** write the stats of every job that has run, to a file and the telemetry sink */
+        void dump(std::FILE* file = nullptr) const;
+        /**
+         * A short line per job for the brain screen, busiest first: CPU share, stack high water, or
+         * - when it's not measured, and overruns
+         *
+         * @param lines most jobs to list
+         */
+        void summary(char* text, std::size_t size, int lines) const;
+        /** reset the stats, e.g. at the start of a match */
+        void clearStats();
+
+        /** enough for every loop the robot runs */
+        static constexpr std::size_t maxJobs = 12;
+    private:
+        /** the job to run, or nullptr if it's refused */
+        Job* add(const char* name, std::uint32_t period, std::uint32_t priority, std::function<void()> function,
+                 bool here);
+        static void loop(Job& job);
+
+        /** a task every() starts, made in memory the scheduler owns */
+        struct TaskMemory {
+                std::array<pros::c::task_stack_t, TASK_STACK_DEPTH_DEFAULT> stack;
+                pros::c::static_task_s_t task;
+        };
+
+        // a fixed pool so jobs stay put while tasks hold references to them, and so running one
+        // again in driver control doesn't allocate
+        std::array<Job, maxJobs> jobs {};
+        std::size_t jobCount = 0;
+        // by job, so a job keeps its task's stack. Static storage, 32 KB a job
+        std::array<TaskMemory, maxJobs> tasks {};
+        // jobs can be added from more than one task while the screen and the log read them, see spf::Startup
+        mutable pros::Mutex mutex;
+};
+
+} // namespace spf
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "display/lvgl.h"
+
+namespace spf {
+
+/**
+ * A label showing one number, redrawn only when the number moves by more than a threshold
+ *
+ * Formatting and lv_label_set_text are the expensive part of a screen update, and most frames
+ * nothing on the screen has visibly changed.
+ */
+class LabelField {
+    public:
+        /**
+         * @param format printf format for the value, e.g. "X: %.2f"
+         * @param threshold smallest change worth redrawing for
+         */
+        LabelField(const char* format, float threshold);
+
+        /** the label to draw into, once it has been created */
+        void attach(lv_obj_t* label);
+        /** show a value, returns whether the label was redrawn */
+        bool update(float value);
+    private:
+        const char* format;
+        float threshold;
+        lv_obj_t* label = nullptr;
+        float shown = 0;
+        bool drawn = false;
+};
+
+} // namespace spf
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "spf/health.hpp"
+#include "spf/route.hpp"
+#include "spf/snapshot.hpp"
+
+namespace spf {
+
+/** one part of a skills cycle, e.g. loading or launching, run as a route */
+struct SkillsPhase {
+        const char* name;
+        Route route;
+};
+
+/** how one cycle went */
+struct CycleRecord {
+        static constexpr std::size_t maxPhases = 4;
+
+        std::uint32_t start = 0; // ms since skills started
+        std::uint32_t time = 0; // ms
+        std::array<std::uint32_t, maxPhases> phaseTime {}; // ms
+        float temperature = 0; // C, the hottest drive motor as it started, estimated
+        bool gentle = false; // run at the reduced acceleration
+};
+
+/** skills so far, safe to read from any task */
+struct SkillsStatus {
+        int cycles = 0;
+        int triballs = 0;
+        float elapsed = 0; // s since skills started
+        float rate = 0; // triballs per second, over the cycles
+        bool gentle = false; // cycling at the reduced acceleration to keep the drive out of throttling
+        bool finishing = false;
+};
+
+/**
+ * Skills autonomous: a setup, then the same launch-and-push cycle over and over, then a finish
+ *
+ * Before each cycle the runner predicts how long it takes from the cycles so far, and stops
+ * cycling when the next one wouldn't leave time for the finish. The drive heats up over a minute
+ * of cycles, so when the health monitor predicts the hottest motor reaches the firmware's
+ * throttling before the window ends, the cycles run at a reduced acceleration, which draws less
+ * current, until the prediction clears the end with room to spare. The gentle cycles are
+ * timed on their own, since they take longer.
+ *
+ * Every cycle and each phase of it is timed. A line per cycle goes to the text log as it
+ * finishes, and dump() writes all of them with the triballs per second after the run.
+ */
+class SkillsRunner {
+    public:
+        /**
+         * @param runner runs the routes
+         * @param health predicts when the drive throttles
+         * @param setup from the start pose to where the first cycle starts
+         * @param cycle the phases of one cycle, in order, up to CycleRecord::maxPhases. It ends where it started
+         * @param triballsPerCycle triballs one cycle scores
+         * @param finish from the end of a cycle, e.g. pushing the triballs in
+         * @param gentleAcceleration fraction of the acceleration gentle cycles use, 0 to 1
+         */
+        SkillsRunner(RouteRunner& runner, const HealthMonitor& health, Route setup, std::vector<SkillsPhase> cycle,
+                     int triballsPerCycle, Route finish, float gentleAcceleration);
+
+        /**
+         * compile every route, and the gentle cycle, ahead of autonomous
+         *
+         * @param halfLength bumpers ahead and behind the tracking center, in inches, see Route::compile
+         */
+        void compile(const DriveModel& model, float halfLength);
+        /** run skills, blocking until the finish is done. window is how long it has, in milliseconds */
+        void run(std::uint32_t window);
+
+        /** the routes of a run, in order: the setup, each phase of a cycle and the finish */
+        const Route& setupRoute() const { return setup; }
+        const std::vector<SkillsPhase>& cyclePhases() const { return cycle; }
+        const Route& finishRoute() const { return finish; }
+
+        SkillsStatus status() const { return published.read(); }
+        /** write the cycles of the last run, to a file and the telemetry sink. Formatting allocates */
+        void dump(std::FILE* file = nullptr) const;
+
+        static constexpr std::size_t maxCycles = 64;
+    private:
+        /** run one cycle, returning how long it took, in milliseconds */
+        std::uint32_t runCycle(bool gentle, CycleRecord& record);
+        void publish(std::uint32_t start, bool finishing);
+
+        RouteRunner& runner;
+        const HealthMonitor& health;
+        Route setup;
+        std::vector<SkillsPhase> cycle;
+        std::vector<SkillsPhase> gentleCycle; // the same phases, compiled at the reduced acceleration
+        const int triballsPerCycle;
+        Route finish;
+        const float gentleAcceleration;
+
+        std::array<CycleRecord, maxCycles> records {};
+        int cycles = 0;
+        std::array<float, 2> expected {}; // ms a cycle is predicted to take, normal and gentle
+        bool gentle = false;
+        std::uint32_t setupTime = 0; // ms
+        std::uint32_t finishTime = 0; // ms
+        std::uint32_t totalTime = 0; // ms
+        SeqLock<SkillsStatus> published;
+};
+
+} // namespace spf
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "pros/rtos.hpp"
+
+namespace spf {
+
+/** what the rest of the program needs to know about the robot, captured at one instant */
+struct RobotState {
+        std::uint32_t time = 0; // ms
+        float x = 0; // in
+        float y = 0; // in
+        float theta = 0; // deg
+        float maxMotorTemperature = 0; // hottest drive motor, C
+        float timeToThrottle = 0; // until the hottest drive motor throttles at the recent load, s
+};
+
+/**
+ * Sequence lock around a small value with one writer and any number of readers
+ *
+ * The writer never waits. A reader copies the value and retries if a write happened while it was
+ * copying, so it always gets a value that was published as a whole; it never sees x from one
+ * tick and theta from the next.
+ */
+template <typename T> class SeqLock {
+        static_assert(std::is_trivially_copyable_v<T>, "SeqLock values are copied word by word");
+    public:
+        /** publish a new value. Only one task may write */
+        void publish(const T& value) {
+            std::array<std::uint32_t, words> buffer {};
+            std::memcpy(buffer.data(), &value, sizeof(T));
+            const std::uint32_t next = sequence.load(std::memory_order_relaxed) + 1;
+            // odd while the value is being written
+            sequence.store(next, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            for (std::size_t i = 0; i < words; i++) data[i].store(buffer[i], std::memory_order_relaxed);
+            sequence.store(next + 1, std::memory_order_release);
+        }
+
+        /** the last published value */
+        T read() const {
+            std::array<std::uint32_t, words> buffer {};
+            while (true) {
+                const std::uint32_t before = sequence.load(std::memory_order_acquire);
+                if (before & 1) {
+                    // the writer was preempted mid-write, let it finish
+                    pros::delay(1);
+                    continue;
+                }
+                for (std::size_t i = 0; i < words; i++) buffer[i] = data[i].load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (sequence.load(std::memory_order_relaxed) == before) break;
+            }
+            // trivially copyable, see above, so the bytes are a value
+            T value;
+            std::memcpy(static_cast<void*>(&value), buffer.data(), sizeof(T));
+            return value;
+        }
+
+        /** changes every time a value is published, so readers can skip values they have seen */
+        std::uint32_t version() const { return sequence.load(std::memory_order_acquire) / 2; }
+    private:
+        static constexpr std::size_t words = (sizeof(T) + 3) / 4;
+
+        std::atomic<std::uint32_t> sequence {0};
+        std::array<std::atomic<std::uint32_t>, words> data {};
+};
+
+} // namespace spf
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+
+#include "pros/rtos.hpp"
+
+namespace spf {
+
+/** one piece of initialize() and how long it took */
+struct StartupPhase {
+        const char* name = nullptr;
+        std::uint32_t start = 0; // ms since the program started
+        std::uint32_t duration = 0; // ms
+        std::atomic<bool> done {false};
+};
+
+/**
+ * Runs the pieces of initialize() side by side, and holds autonomous back until they are done
+ *
+ * Every competition mode waits for initialize() to return, and calibrating the IMU takes 2 s on
+ * its own, which a brownout or a field reset costs again. The slow pieces each run on their own
+ * task with start(), while the screen is built on the calling task with runHere(), and
+ * initialize() returns without waiting for any of them. autonomous() calls waitFor() first, which
+ * blocks until the phases it needs are done, and waitReady() waits for all of them. Each phase
+ * posts its start and duration to the text log as it finishes, and the last one how long the robot
+ * took to be ready.
+ */
+class Startup {
+    public:
+        /** run a phase on its own task */
+        void start(const char* name, std::function<void()> work, std::uint32_t priority = TASK_PRIORITY_DEFAULT);
+        /** run a phase on the calling task, timed the same way */
+        void runHere(const char* name, const std::function<void()>& work);
+
+        /** whether every phase started so far is done */
+        bool isReady() const;
+        /** block until every phase is done, or timeout milliseconds. Returns whether they all are */
+        bool waitReady(std::uint32_t timeout = TIMEOUT_MAX) const;
+        /** whether the phase with this name has started and is done */
+        bool isDone(const char* name) const;
+        /** block until the phase with this name is done, or timeout milliseconds. Returns whether it is */
+        bool waitFor(const char* name, std::uint32_t timeout = TIMEOUT_MAX) const;
+        /** write every phase, to a file and the telemetry sink. Formatting allocates */
+        void dump(std::FILE* file = nullptr) const;
+
+        static constexpr std::size_t maxPhases = 8;
+    private:
+        StartupPhase& add(const char* name);
+        void finish(StartupPhase& phase);
+
+        std::array<StartupPhase, maxPhases> phases {};
+        std::atomic<std::size_t> count {0};
+};
+
+} // namespace spf
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "spf/recordLog.hpp"
+#include "spf/telemetryRecord.hpp"
+
+namespace spf {
+
+/**
+ * Binary telemetry log on the SD card, a TelemetryRecord every 10 ms
+ *
+ * The ring holds 5 s of records. tools/spf_decode turns a log back into CSV.
+ */
+using TelemetryLog = RecordLog<TelemetryHeader, TelemetryRecord, 512>;
+
+} // namespace spf
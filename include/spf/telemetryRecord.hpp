@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+
+// layout of the binary telemetry log. Shared by the robot and tools/spf_decode, so nothing here
+// depends on PROS. Both the V5 brain and the PCs the logs are read on are little endian
+
+namespace spf {
+
+/** what the drivetrain is doing when a record is taken */
+enum class Motion : std::uint8_t { None, Profile, Turn, Reactive, Driver, Path };
+
+constexpr const char* motionNames[] = {"none", "profile", "turn", "reactive", "driver", "path"};
+
+/** start of every log file */
+struct TelemetryHeader {
+        char magic[4] = {'S', 'P', 'F', 'T'};
+        std::uint16_t version = 1;
+        std::uint16_t recordSize = 0; // bytes per record
+        std::uint32_t startTime = 0; // ms since the program started
+};
+
+/** one 10 ms sample of the robot */
+struct TelemetryRecord {
+        std::uint32_t time; // ms since the program started
+        float x; // in
+        float y; // in
+        float theta; // deg
+        std::int16_t velocity[8]; // drive motors lF, lM, lR, lB, rF, rM, rR, rB, rpm
+        std::int16_t current[8]; // mA
+        std::int8_t temperature[8]; // C
+        std::int8_t axes[4]; // controller LX, LY, RX, RY
+        std::uint8_t outputs; // bit 0 wings1, bit 1 wings2, bit 2 intake, bit 3 drive wheels slipping,
+                              // bit 4 traction control holding a side back
+        Motion motion;
+        std::uint16_t battery; // mV
+};
+
+static_assert(sizeof(TelemetryHeader) == 12, "the header is read back byte for byte");
+static_assert(sizeof(TelemetryRecord) == 64, "the record is read back byte for byte");
+
+} // namespace spf
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "pros/rtos.hpp"
+
+namespace spf {
+
+/**
+ * Text messages from the control loops, formatted into fixed slots and handed to the telemetry
+ * sink later from a low priority task
+ *
+ * The sink formats each message into a std::string, which allocates, and then waits on the serial
+ * port. post() formats with snprintf into one of a fixed number of slots and never waits: when
+ * the slots are full the message is dropped and counted.
+ */
+class TextLog {
+    public:
+        static constexpr std::size_t slots = 16;
+        static constexpr std::size_t length = 96; // bytes per message, longer ones are cut short
+
+        /** printf style. Returns false if the message was dropped */
+        [[gnu::format(printf, 2, 3)]] bool post(const char* format, ...);
+        /** hand the waiting messages to the telemetry sink, from a low priority task */
+        void flush();
+
+        std::uint32_t dropped() const { return drops.load(std::memory_order_relaxed); }
+    private:
+        struct Line {
+                char text[length];
+        };
+
+        std::array<Line, slots> lines {};
+        std::size_t first = 0; // oldest waiting message
+        std::size_t count = 0;
+        std::atomic<std::uint32_t> drops {0}; // counted without the lock too, when it is busy
+        pros::Mutex mutex;
+};
+
+/** the robot's text log, flushed by the "text" loop */
+TextLog& textLog();
+
+} // namespace spf
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "pros/motors.hpp"
+#include "spf/odometry.hpp"
+#include "spf/profile.hpp"
+
+namespace spf {
+
+/**
+ * Arcade driving with traction control
+ *
+ * Mixes the sticks the way chassis.arcade does and then limits each side of the drive, every
+ * 10 ms, against the ground speed the odometry measures under it:
+ * - Pushing from rest or the way it already goes, a side gets at most the voltage that accelerates
+ *   it at its allowed acceleration from the ground speed, so a hard launch doesn't start by
+ *   spinning the wheels.
+ * - While a side's wheels turn faster than the ground, its allowed acceleration follows the slip
+ *   down towards the amount where the omnis grip best, and recovers to maxAcceleration as they grip.
+ * Braking against the way a side is going is never limited, so the driver can always stop. Without both
+ * tracking wheels there is no ground speed to compare against, and it drives unlimited.
+ */
+class TractionControl {
+    public:
+        /**
+         * @param leftMotors left side of the drive
+         * @param rightMotors right side of the drive
+         * @param odometry measures each side's ground speed and slip
+         * @param model the drive's feedforward gains, which turn speeds into voltages
+         * @param maxAcceleration fastest the sticks may accelerate the robot, in inches per second squared
+         */
+        TractionControl(pros::MotorGroup& leftMotors, pros::MotorGroup& rightMotors, const Odometry& odometry,
+                        const DriveModel& model, float maxAcceleration);
+
+        /**
+         * drive with throttle and turn, -127 to 127, every 10 ms. The sticks go in as they are, without LemLib's
+         * drive curves
+         *
+         * @param desaturateBias how much of the turn to keep over the throttle when both can't fit, 0 to 1
+         */
+        void arcade(int throttle, int turn, float desaturateBias = 0.5);
+
+        /** whether either side is held below maxAcceleration for slipping */
+        bool isLimiting() const { return limiting.load(std::memory_order_relaxed); }
+        /** times a side started slipping since the program started */
+        std::uint32_t slipEvents() const { return events.load(std::memory_order_relaxed); }
+    private:
+        pros::MotorGroup& leftMotors;
+        pros::MotorGroup& rightMotors;
+        const Odometry& odometry;
+        const DriveModel& model;
+        const float maxAcceleration;
+
+        std::array<bool, 2> slipping {}; // left and right
+        std::array<float, 2> acceleration; // in/s^2, what each side may accelerate at for now
+        std::atomic<bool> limiting {false};
+        std::atomic<std::uint32_t> events {0};
+};
+
+} // namespace spf
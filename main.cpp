@@ -1,54 +1,80 @@
 #include "main.h"
+#include "robot.hpp"
 #include "lemlib/api.hpp"
 #include "lemlib/chassis/chassis.hpp"
 #include "pros/misc.h"
+#include "spf/characterize.hpp"
+#include "spf/driverInput.hpp"
+#include "spf/fieldMap.hpp"
+#include "spf/health.hpp"
+#include "spf/heap.hpp"
+#include "spf/odometry.hpp"
+#include "spf/profiler.hpp"
+#include "spf/relocalize.hpp"
+#include "spf/route.hpp"
+#include "spf/scheduler.hpp"
+#include "spf/skills.hpp"
+#include "spf/screen.hpp"
+#include "spf/snapshot.hpp"
+#include "spf/startup.hpp"
+#include "spf/telemetry.hpp"
+#include "spf/textLog.hpp"
+#include "spf/traction.hpp"
 
 // controller
 pros::Controller controller(pros::E_CONTROLLER_MASTER);
 
 // Drive motors
-pros::Motor lF(8, pros::E_MOTOR_GEARSET_06);
-pros::Motor lM(-10, pros::E_MOTOR_GEARSET_06);
-pros::Motor lR(7, pros::E_MOTOR_GEARSET_06);
-pros::Motor lB(6, pros::E_MOTOR_GEARSET_06);
+pros::Motor lF(robot.leftDrive[0], robot.gearset());
+pros::Motor lM(robot.leftDrive[1], robot.gearset());
+pros::Motor lR(robot.leftDrive[2], robot.gearset());
+pros::Motor lB(robot.leftDrive[3], robot.gearset());
 
-pros::Motor rF(-18, pros::E_MOTOR_GEARSET_06);
-pros::Motor rM(20, pros::E_MOTOR_GEARSET_06);
-pros::Motor rR(-17, pros::E_MOTOR_GEARSET_06);
-pros::Motor rB(-16, pros::E_MOTOR_GEARSET_06);
+pros::Motor rF(robot.rightDrive[0], robot.gearset());
+pros::Motor rM(robot.rightDrive[1], robot.gearset());
+pros::Motor rR(robot.rightDrive[2], robot.gearset());
+pros::Motor rB(robot.rightDrive[3], robot.gearset());
 
 // Motor groups
 pros::MotorGroup leftMotors({lF, lM, lR, lB}); // left motor group
 pros::MotorGroup rightMotors({rF, rM, rR, rB}); // right motor group
 
+// every drive motor, in the order the telemetry log records them
+std::array<pros::Motor*, 8> driveMotors = {&lF, &lM, &lR, &lB, &rF, &rM, &rR, &rB};
+
+// drive motor temperatures, and derating before the firmware throttles them
+spf::HealthMonitor health(driveMotors, leftMotors, rightMotors);
+
 // Pneumatics
-pros::ADIDigitalOut wings1('C');
-pros::ADIDigitalOut wings2('A');
-pros::ADIDigitalOut intake('B');
+spf::Piston wings1(robot.wings1);
+spf::Piston wings2(robot.wings2);
+spf::Piston intake(robot.intake);
+
+// Inertial Sensor
+pros::Imu imu(robot.imu);
 
-// Inertial Sensor on port 2
-pros::Imu imu(1);
+// distance sensors, ranging off the field walls to correct the odometry
+pros::Distance frontDistance(robot.frontRange.port); // on the front bumper, looking forwards
+pros::Distance leftDistance(robot.leftRange.port); // on the left side, looking left
 
 // Auton Route
 int autonRoute = 2;
 
 // tracking wheels
-// horizontal tracking wheel encoder. Rotation sensor, port 20, not reversed
-pros::Rotation verticalEnc(9, false);
-// vertical tracking wheel encoder. Rotation sensor, port 11, reversed (negative signs don't work due to a pros bug)
-pros::Rotation verticalEnc2(19, true);
-// horizontal tracking wheel. 2.75" diameter, 5.75" offset, back of the robot (negative)
-lemlib::TrackingWheel vertical1(&verticalEnc, lemlib::Omniwheel::NEW_325, 5.5);
-// vertical tracking wheel. 2.75" diameter, 2.5" offset, left of the robot (negative)
-lemlib::TrackingWheel vertical2(&verticalEnc2, lemlib::Omniwheel::NEW_325, -5.5);
+// vertical tracking wheel encoders. Rotation sensors
+pros::Rotation verticalEnc(robot.trackers[0].port, robot.trackers[0].reversed);
+pros::Rotation verticalEnc2(robot.trackers[1].port, robot.trackers[1].reversed);
+// vertical tracking wheels, right of the tracking center (positive) and left of it (negative)
+lemlib::TrackingWheel vertical1(&verticalEnc, robot.trackers[0].diameter, robot.trackers[0].offset);
+lemlib::TrackingWheel vertical2(&verticalEnc2, robot.trackers[1].diameter, robot.trackers[1].offset);
 
 // drivetrain settings
 lemlib::Drivetrain drivetrain(&leftMotors, // left motor group
                               &rightMotors, // right motor group
-                              11, // 10 inch track width
-                              lemlib::Omniwheel::NEW_325, // using new 3.25" omnis
-                              600, // drivetrain rpm is 343
-                              2 // horizontal drift is 2. If we had traction wheels, it would have been 8
+                              robot.trackWidth, // track width
+                              robot.wheelDiameter, // wheel diameter
+                              robot.wheelRpm, // drivetrain rpm
+                              robot.horizontalDrift // horizontal drift
 );
 
 // lateral motion controller
@@ -76,32 +102,249 @@ lemlib::ControllerSettings angularController(2, // proportional gain (kP)
 );
 
 // sensors for odometry
-// note that in this example we use internal motor encoders (IMEs), so we don't pass vertical tracking wheels
-lemlib::OdomSensors sensors(nullptr, // vertical tracking wheel 1, set to null
-                            nullptr, // vertical tracking wheel 2, set to nullptr as we are using IMEs
+// LemLib's own odometry isn't started, see odometry below
+lemlib::OdomSensors sensors(&vertical1, // vertical tracking wheel 1
+                            &vertical2, // vertical tracking wheel 2
                             nullptr, // horizontal tracking wheel 1
                             nullptr, // horizontal tracking wheel 2, set to nullptr as we don't have a second one
                             &imu // inertial sensor
 );
 
-// input curve for throttle input during driver control
-lemlib::ExpoDriveCurve throttleCurve(3, // joystick deadband out of 127
-                                     10, // minimum output where drivetrain will move out of 127
-                                     1.019 // expo curve gain
+// input curves for throttle and steer during driver control, tabled when the program is built
+constinit spf::DriveCurveTable throttleCurve(robot.throttle);
+constinit spf::DriveCurveTable steerCurve(robot.steer);
+
+// create the chassis
+lemlib::Chassis chassis(drivetrain, linearController, angularController, sensors, &throttleCurve, &steerCurve);
+
+// odometry from both tracking wheels, the imu and the drive encoders, every 5 ms. It keeps the
+// chassis pose, so LemLib motions use it too
+spf::Odometry odometry(chassis, // the chassis whose pose it keeps
+                       drivetrain, // drive motors, for slip detection
+                       robot.inchesPerDegree(), // drive encoder scale
+                       vertical1, // vertical tracking wheel 1
+                       vertical2, // vertical tracking wheel 2
+                       imu, // inertial sensor
+                       0.11, // sideways slide in turns, in seconds of centripetal acceleration
+                       robot.halfLength // keeps the pose on the field
 );
 
-// input curve for steer input during driver control
-lemlib::ExpoDriveCurve steerCurve(3, // joystick deadband out of 127
-                                  10, // minimum output where drivetrain will move out of 127
-                                  1.019 // expo curve gain
+// keeps the odometry on the field walls while the robot drives, see spf::Relocalizer
+spf::Relocalizer relocalizer(odometry, // the pose it corrects
+                             drivetrain, // drive motors, whose current shows the robot pushing a wall
+                             {
+                                 {&frontDistance, robot.frontRange.forward, robot.frontRange.right,
+                                  robot.frontRange.angle},
+                                 {&leftDistance, robot.leftRange.forward, robot.leftRange.right, robot.leftRange.angle},
+                             },
+                             robot.halfLength // bumpers ahead and behind the tracking center
 );
 
-// create the chassis
-lemlib::Chassis chassis(drivetrain, linearController, angularController, sensors, &throttleCurve, &steerCurve);
+// motion profile limits and feedforward for the autonomous routes
+spf::DriveModel driveModel(robot.trackWidth, // track width
+                           robot.wheelDiameter, // wheel diameter
+                           robot.wheelRpm, // drivetrain rpm
+                           robot.cartridgeRpm, // drive motor cartridges
+                           driveLimits.speedHeadroom, // see robot.hpp, shared with tools/spf_pathc
+                           driveLimits.maxAcceleration,
+                           driveLimits.maxDeceleration,
+                           driveLimits.maxLateralAcceleration,
+                           300, // kS, static friction, in millivolts
+                           117, // kV, 12 V at the free speed, in millivolts per inch per second
+                           35, // kA, in millivolts per inch per second squared
+                           60 // kA for turning, in millivolts per inch per second squared
+);
+
+// driver control arcade, held back when a side's wheels spin faster than the ground under them
+spf::TractionControl traction(leftMotors, // left motor group
+                              rightMotors, // right motor group
+                              odometry, // ground speed and slip of each side
+                              driveModel, // feedforward gains
+                              300 // fastest launch, in inches per second squared. About what the tiles grip
+);
+
+// autonRoute 9, selected by holding Auton 1 on the screen, drives the robot through spf::characterize
+// instead of a route, and saves the fitted feedforward here. initialize() loads it into driveModel
+const int characterizeRoute = 9;
+const char* characterizationFile = "/usd/drive_model.txt";
+
+// tracks the compiled routes
+spf::RouteRunner routeRunner(chassis, leftMotors, rightMotors, driveModel);
+
+// fixed rate loops for driver control and the screen
+spf::Scheduler scheduler;
+
+// the pieces of initialize() that run on their own tasks, autonomous waits for them
+spf::Startup startup;
+
+// the robot state, published once per tick for the screen and logging
+spf::SeqLock<spf::RobotState> robotState;
+
+// 100 Hz binary log on the SD card, see tools/spf_decode
+spf::TelemetryLog telemetryLog;
+
+// the controller as the drive loop sees it, recorded to the SD card. Off the field, a recording
+// at replayFile drives the robot in driver control instead of the controller
+spf::DriverInput input(controller, robotState);
+const char* replayFile = "/usd/replay.bin";
+
+// set while opcontrol is driving, for the log
+std::atomic<bool> driving = false;
+
+// hot regions of the loops, timed against a budget in microseconds. Written out with the loop stats
+spf::ProfileRegion arcadeTime("arcade", 1000);
+spf::ProfileRegion poseTime("pose", 1000);
+spf::ProfileRegion screenTime("lvgl", 5000);
+spf::ProfileRegion telemetryTime("telemetry", 1000);
+
+// get a path used for pure pursuit, compiled from static/example.txt by tools/spf_pathc
+// this needs to be put outside a function
+ASSET(example_bin); // '.' replaced with "_" to make c++ happy
+
+// Auton routes, selected by autonRoute
+// motions don't block, like the chassis calls: an output right after a motion happens as it starts
+std::vector<spf::Route> routes = {
+    // Launching (Near side)
+    spf::Route(1, "Launching", {
+        spf::setPose(-44.5, -59.13, 135),
+        spf::moveTo(-56.64, -46.93, 135, {.forwards = false}),
+        spf::waitUntilDone(),
+        spf::set(wings1, true),
+        spf::delay(800),
+        spf::moveTo(-44.5, -59.13, 135),
+        spf::waitUntilDone(),
+        spf::after(200),
+        spf::set(wings1, false),
+        spf::moveTo(-9, -59.55, 90),
+        spf::set(intake, true),
+        spf::moveTo(-15, -59.55, 90, {.forwards = false}),
+        spf::set(intake, false),
+        spf::moveTo(-9, -59.55, 90),
+        spf::set(wings1, true),
+        spf::moveTo(-9, -59.55, 110),
+    }),
+
+    // Offense (Far side)
+    spf::Route(2, "Offense", {
+        spf::setPose(35.5, -61.63, 0),
+
+        spf::moveTo(35.5, -9.63, 0, {.exitRadius = 6}),
+
+        spf::moveTo(35.5, -9.63, 90),
+        spf::waitUntilDone(),
+        spf::set(intake, true),
+
+        spf::moveTo(50.5, -7.63, 90),
+        spf::moveTo(35.5, -7.63, 90, {.forwards = false}),
+
+        // Next triball
+        spf::moveTo(35.5, -7.63, 270),
+        spf::moveTo(9.5, -23.39, 270),
+        spf::waitUntilDone(),
+        spf::set(intake, false),
+
+        spf::moveTo(15.5, -23.39, 270, {.forwards = false}),
+        spf::moveTo(15.5, -23.39, 355),
+
+        // Final push
+        spf::moveTo(7.0, -8.2, 355, {.exitRadius = 6}),
+        spf::moveTo(7.0, -8.2, 80, {.maxSpeed = 20}),
+        spf::waitUntil(5),
+        spf::set(wings1, true),
+        spf::set(intake, true),
+
+        spf::moveTo(42.45, -4.85, 84),
+
+        spf::moveTo(32.25, -4.85, 84, {.forwards = false}),
+        spf::waitUntilDone(),
+        spf::set(wings1, false),
+        spf::set(intake, false),
+    }),
+
+    spf::Route(4, "Forward", {
+        spf::moveTo(0, 15, 0),
+    }),
+
+    spf::Route(5, "Corner", {
+        spf::setPose(46.92, -59.02, 45),
+        spf::moveTo(59.5, -47.1, 45),
+    }),
+
+    // Testing
+    spf::Route(6, "Square", {
+        spf::moveTo(0, 25, 0),
+        spf::moveTo(25, 25, 90),
+        spf::moveTo(25, 0, 180),
+        spf::moveTo(0, 0, 270),
+        spf::turnTo(360),
+    }),
+
+    spf::Route(7, "Pure pursuit", {
+        spf::setPose(39.37, -61.02, 0),
+        spf::follow(example_bin, 10, 30000),
+    }),
+};
+
+// Skills, autonRoute 3: from the match load zone, sweep a match load out with the wing every
+// cycle for as long as the minute allows, then push them all through the alley into the goal
+const int skillsRoute = 3;
+const std::uint32_t skillsLength = 60000; // ms
+spf::SkillsRunner skills(routeRunner, // runs the routes
+                         health, // when the drive would throttle
+                         spf::Route(skillsRoute, "Skills setup", {
+                             spf::setPose(-44.5, -59.13, 135),
+                         }),
+                         {
+                             {"load", spf::Route(skillsRoute, "Skills load", {
+                                 spf::moveTo(-56.64, -46.93, 135, {.forwards = false}),
+                                 spf::waitUntilDone(),
+                                 spf::set(wings1, true),
+                                 spf::delay(300),
+                             })},
+                             {"launch", spf::Route(skillsRoute, "Skills launch", {
+                                 spf::moveTo(-44.5, -59.13, 135),
+                                 spf::waitUntilDone(),
+                                 spf::set(wings1, false),
+                             })},
+                         },
+                         1, // triballs per cycle
+                         spf::Route(skillsRoute, "Skills finish", {
+                             spf::moveTo(-9, -59.55, 90),
+                             spf::moveTo(35.5, -59.55, 90),
+                             spf::moveTo(35.5, -9.63, 0, {.exitRadius = 6}),
+                             spf::moveTo(35.5, -9.63, 90),
+                             spf::waitUntilDone(),
+                             spf::set(wings1, true),
+                             spf::set(wings2, true),
+                             spf::moveTo(50.5, -7.63, 90),
+                             spf::moveTo(35.5, -7.63, 90, {.forwards = false}),
+                             spf::waitUntilDone(),
+                             spf::set(wings1, false),
+                             spf::set(wings2, false),
+                         }),
+                         0.6 // gentle cycles accelerate at 60%, when the drive would throttle before the minute is up
+);
 
 // LVGL Variables
 lv_obj_t * myLabel;
 lv_obj_t * txtInfo;
+lv_obj_t * txtX;
+lv_obj_t * txtY;
+lv_obj_t * txtTheta;
+lv_obj_t * txtTemp;
+lv_obj_t * txtThrottle;
+lv_obj_t * txtLoops;
+
+// info page values, redrawn only when they change by more than what's shown
+spf::LabelField xField("X: %.2f", 0.05);
+spf::LabelField yField("Y: %.2f", 0.05);
+spf::LabelField thetaField("Theta: %.2f", 0.1);
+spf::LabelField tempField("Temperature: %.1f°F", 1);
+spf::LabelField throttleField("Throttles in: %.0f s", 1);
+
+// the third page: the field, the selected route and where the robot has been
+spf::FieldMap fieldMap(robot.halfLength);
+spf::ProfileRegion mapTime("map", 2000);
  
 lv_style_t labelStyle;
  
@@ -140,6 +383,7 @@ LV_IMG_DECLARE(spflogo);
 LV_IMG_DECLARE(spflogoBW);
  
 bool showInfo = false;
+bool showMap = false;
  
 char buffer[100];
  
@@ -166,33 +410,56 @@ static lv_res_t btn_click_action(lv_obj_t * btn)
 		lv_label_set_text(myLabel, buffer);
     }
     else if (id == 3) {
-        showInfo = !showInfo;
+        // the logo, the info page and the map in turn
+        if (showInfo) {
+            showInfo = false;
+            showMap = true;
+        } else {
+            showInfo = !showMap;
+            showMap = false;
+        }
+        fieldMap.setHidden(!showMap);
         if (showInfo) {
             lv_obj_set_hidden(imgLogo, true);
             lv_obj_set_hidden(imgLogo2, false);
             lv_obj_set_hidden(myLabel, false);
             lv_obj_set_hidden(txtInfo, false);
+            lv_obj_set_hidden(txtX, false);
+            lv_obj_set_hidden(txtY, false);
+            lv_obj_set_hidden(txtTheta, false);
+            lv_obj_set_hidden(txtTemp, false);
+            lv_obj_set_hidden(txtThrottle, false);
+            lv_obj_set_hidden(txtLoops, false);
         } else {
-            lv_obj_set_hidden(imgLogo, false);
+            lv_obj_set_hidden(imgLogo, showMap);
             lv_obj_set_hidden(imgLogo2, true);
             lv_obj_set_hidden(myLabel, true);
             lv_obj_set_hidden(txtInfo, true);
+            lv_obj_set_hidden(txtX, true);
+            lv_obj_set_hidden(txtY, true);
+            lv_obj_set_hidden(txtTheta, true);
+            lv_obj_set_hidden(txtTemp, true);
+            lv_obj_set_hidden(txtThrottle, true);
+            lv_obj_set_hidden(txtLoops, true);
         }
     }
  
     return LV_RES_OK;
 }
 
-/**
- * Runs initialization code. This occurs as soon as the program is started.
- *
- * All other competition modes are blocked by initialize; it is recommended
- * to keep execution time for this mode under a few seconds.
- */
-void initialize() {
-    chassis.calibrate(); // calibrate sensors
+// holding Auton 1 down selects the characterization instead, so a tap in the pits can't pick it
+static lv_res_t btn_long_press_action(lv_obj_t *)
+{
+    sprintf(buffer, "Auton Route [%d] Selected (Characterize)", characterizeRoute);
+    autonRoute = characterizeRoute;
+    labelStyle.text.color = LV_COLOR_LIME;
+    lv_label_set_text(myLabel, buffer);
 
-    
+    return LV_RES_OK;
+}
+
+/** the selector buttons, the logos and the info page */
+void createScreen() {
     // Images
     imgLogo = lv_img_create(lv_scr_act(), NULL);
     lv_img_set_src(imgLogo, &spflogo);
@@ -221,6 +488,7 @@ void initialize() {
     button1 = lv_btn_create(lv_scr_act(), NULL); //create button, lv_scr_act() is deafult screen object
     lv_obj_set_free_num(button1, 0); //set button is to 0
     lv_btn_set_action(button1, LV_BTN_ACTION_CLICK, btn_click_action); //set function to be called on button click
+    lv_btn_set_action(button1, LV_BTN_ACTION_LONG_PR, btn_long_press_action); //and on holding it, see characterizeRoute
     lv_btn_set_style(button1, LV_BTN_STYLE_REL, &button1StyleREL); //set the relesed style
     lv_btn_set_style(button1, LV_BTN_STYLE_PR, &button1StylePR); //set the pressed style
     lv_obj_set_size(button1, 150, 50); //set the button size
@@ -315,42 +583,194 @@ void initialize() {
     lv_obj_align(myLabel, NULL, LV_ALIGN_IN_TOP_LEFT, 10, 10); //set the position to center
  
  
-    txtInfo = lv_label_create(lv_scr_act(), NULL); //create label and puts it on the screen
-    lv_label_set_text(txtInfo, "null"); //sets label text
-    lv_obj_align(txtInfo, NULL, LV_ALIGN_IN_TOP_LEFT, 10, 35); //set the position to center
+    // one label per value so only the ones that change get redrawn
+    txtX = lv_label_create(lv_scr_act(), NULL);
+    lv_obj_align(txtX, NULL, LV_ALIGN_IN_TOP_LEFT, 10, 35);
+    xField.attach(txtX);
  
-    lv_obj_set_hidden(myLabel, true);
-    lv_obj_set_hidden(txtInfo, true);
-
-    // thread to for brain screen and position logging
-    pros::Task screenTask([&]() {
-        lemlib::Pose pose(0, 0, 0);
+    txtY = lv_label_create(lv_scr_act(), NULL);
+    lv_obj_align(txtY, NULL, LV_ALIGN_IN_TOP_LEFT, 10, 55);
+    yField.attach(txtY);
  
-        while (true) {
+    txtTheta = lv_label_create(lv_scr_act(), NULL);
+    lv_obj_align(txtTheta, NULL, LV_ALIGN_IN_TOP_LEFT, 10, 75);
+    thetaField.attach(txtTheta);
  
-            // Temperature (130, 140, 150, 160 °F)
-            int motorTemps[6];
-            motorTemps[0] = lF.get_temperature();
-            motorTemps[1] = lM.get_temperature();
-            motorTemps[2] = lB.get_temperature();
-            motorTemps[3] = rF.get_temperature();
-            motorTemps[4] = rM.get_temperature();
-            motorTemps[5] = rB.get_temperature();
+    txtTemp = lv_label_create(lv_scr_act(), NULL);
+    lv_obj_align(txtTemp, NULL, LV_ALIGN_IN_TOP_LEFT, 10, 95);
+    tempField.attach(txtTemp);
  
-            int *maxElement = std::max_element(std::begin(motorTemps), std::end(motorTemps));
+    txtThrottle = lv_label_create(lv_scr_act(), NULL);
+    lv_obj_align(txtThrottle, NULL, LV_ALIGN_IN_TOP_LEFT, 10, 115);
+    throttleField.attach(txtThrottle);
  
-            // print info
-            char txtBuffer[200];
-            sprintf(txtBuffer, "X: %.2f \nY: %.2f \nTheta: %.2f \nTemperature: %.1f°F \
-                    \n\n\nSingle Point Failure \nCatholic High School For Boys \n72116A "SYMBOL_HOME,
-                    chassis.getPose().x, chassis.getPose().y, chassis.getPose().theta, static_cast<double>(*maxElement)*9/5+32);
+    // the busiest loops: CPU share, stack high water and overruns
+    txtLoops = lv_label_create(lv_scr_act(), NULL);
+    lv_obj_align(txtLoops, NULL, LV_ALIGN_IN_TOP_LEFT, 150, 35);
  
-		    lv_label_set_text(txtInfo, txtBuffer);
+    // left of the buttons, where the logo is
+    fieldMap.attach(lv_scr_act(), 10, 12);
+ 
+    txtInfo = lv_label_create(lv_scr_act(), NULL); //create label and puts it on the screen
+    lv_label_set_text(txtInfo, "Single Point Failure \nCatholic High School For Boys \n72116A " SYMBOL_HOME); //sets label text
+    lv_obj_align(txtInfo, NULL, LV_ALIGN_IN_TOP_LEFT, 10, 175); //set the position to center
  
-            // log position telemetry
-            lemlib::telemetrySink()->info("Chassis pose: {}", chassis.getPose());
-            // delay to save resources
-            pros::delay(50);
+    lv_obj_set_hidden(myLabel, true);
+    lv_obj_set_hidden(txtInfo, true);
+    lv_obj_set_hidden(txtX, true);
+    lv_obj_set_hidden(txtY, true);
+    lv_obj_set_hidden(txtTheta, true);
+    lv_obj_set_hidden(txtTemp, true);
+    lv_obj_set_hidden(txtThrottle, true);
+    lv_obj_set_hidden(txtLoops, true);
+}
+
+/**
+ * Runs initialization code. This occurs as soon as the program is started.
+ *
+ * All other competition modes are blocked by initialize, so only the screen is built here.
+ * Calibration, the routes and the telemetry log start up on their own tasks and autonomous waits
+ * for them, see spf::Startup.
+ */
+void initialize() {
+    // messages from the loops go out through the telemetry sink from here, where it can allocate
+    // and wait on the serial port
+    scheduler.every("text", 100, TASK_PRIORITY_MIN + 1, []() { spf::textLog().flush(); });
+
+    // calibrate sensors in the background, autonomous waits for it. Not chassis.calibrate(), which
+    // would start LemLib's odometry as well
+    startup.start("calibrate", []() {
+        verticalEnc.set_data_rate(spf::Odometry::period);
+        verticalEnc2.set_data_rate(spf::Odometry::period);
+        odometry.calibrate();
+        // above everything that moves the robot, so they all see a pose from the same instant
+        scheduler.every("odom", spf::Odometry::period, TASK_PRIORITY_DEFAULT + 3, []() {
+            spf::ScopedTimer timer(poseTime);
+            odometry.update();
+        });
+        // below the odometry, which fuses what it finds at its next update
+        scheduler.every("reloc", spf::Relocalizer::period, TASK_PRIORITY_DEFAULT + 2,
+                        []() { relocalizer.update(); });
+    });
+
+    // compile the routes into motion profiles meanwhile, so autonomous doesn't have to
+    startup.start("routes", []() {
+        // feedforward fitted to this robot by the last characterization, instead of the constants above
+        if (pros::usd::is_installed() && spf::loadCharacterization(characterizationFile, driveModel)) {
+            spf::textLog().post("Feedforward: left kS %.0f kV %.1f kA %.1f, right kS %.0f kV %.1f kA %.1f",
+                                driveModel.left.kS, driveModel.left.kV, driveModel.left.kA, driveModel.right.kS,
+                                driveModel.right.kV, driveModel.right.kA);
+        }
+        for (spf::Route& route : routes) route.compile(driveModel, robot.halfLength);
+        skills.compile(driveModel, robot.halfLength);
+        // outputs the routes hold back with after() and waitFor(), while the robot carries on
+        scheduler.every("actions", 10, TASK_PRIORITY_DEFAULT + 1, []() { routeRunner.updateActions(); });
+    });
+
+    // and the log on the SD card, the driver's input and the robot state
+    startup.start("telemetry", []() {
+        // start a new log file for this run. Without an SD card nothing is logged
+        if (pros::usd::is_installed() && telemetryLog.open("/usd/telemetry")) {
+            input.record("/usd/input");
+            // the SD card is slow, so it gets written from its own task at the lowest priority
+            scheduler.every("log", 100, TASK_PRIORITY_MIN + 1, []() {
+                telemetryLog.flush();
+                input.flush();
+            });
+        }
+        if (!pros::competition::is_connected() && input.replay(replayFile)) {
+            // autonomous plays back by running the same route
+            if (input.replayRoute() > 0) autonRoute = input.replayRoute();
+            lemlib::telemetrySink()->info("Replaying {} in driver control", replayFile);
+        }
+        // sampled ahead of the drive loop, so it always reads this tick's sample
+        scheduler.every("input", 10, TASK_PRIORITY_DEFAULT + 3, []() { input.update(); });
+
+        // publish the robot state and log it every 10 ms, every other odometry update
+        scheduler.every("state", 10, TASK_PRIORITY_DEFAULT + 1, []() {
+            const spf::HealthStatus motors = health.status();
+            const lemlib::Pose pose = chassis.getPose();
+            spf::RobotState state;
+            state.time = pros::millis();
+            state.x = pose.x;
+            state.y = pose.y;
+            state.theta = pose.theta;
+            state.maxMotorTemperature = motors.maxTemperature;
+            state.timeToThrottle = motors.timeToThrottle;
+            robotState.publish(state);
+
+            if (!telemetryLog.isOpen()) return;
+            spf::ScopedTimer timer(telemetryTime);
+            spf::TelemetryRecord record;
+            record.time = state.time;
+            record.x = pose.x;
+            record.y = pose.y;
+            record.theta = pose.theta;
+            for (int i = 0; i < 8; i++) {
+                record.velocity[i] = driveMotors[i]->get_actual_velocity();
+                record.current[i] = driveMotors[i]->get_current_draw();
+                record.temperature[i] = motors.motors[i].reported;
+            }
+            record.axes[0] = input.analog(pros::E_CONTROLLER_ANALOG_LEFT_X);
+            record.axes[1] = input.analog(pros::E_CONTROLLER_ANALOG_LEFT_Y);
+            record.axes[2] = input.analog(pros::E_CONTROLLER_ANALOG_RIGHT_X);
+            record.axes[3] = input.analog(pros::E_CONTROLLER_ANALOG_RIGHT_Y);
+            record.outputs = wings1.get_value() | wings2.get_value() << 1 | intake.get_value() << 2 |
+                             odometry.status().slipping << 3 | traction.isLimiting() << 4;
+            record.motion = routeRunner.activeMotion();
+            if (record.motion == spf::Motion::None && chassis.isInMotion()) record.motion = spf::Motion::Reactive;
+            if (record.motion == spf::Motion::None && driving) record.motion = spf::Motion::Driver;
+            record.battery = pros::battery::get_voltage();
+            telemetryLog.push(record);
+        });
+    });
+
+    // drive motor health, a few times a second is plenty for temperatures
+    scheduler.every("health", spf::HealthMonitor::period, TASK_PRIORITY_DEFAULT, []() { health.update(); });
+
+    // the screen on this task while the rest starts up, and then its loop
+    startup.runHere("screen", createScreen);
+
+    // brain screen, below the drive loop. Positions go to the telemetry log, not the text sink
+    scheduler.every("screen", 50, TASK_PRIORITY_DEFAULT - 2, []() {
+        const spf::RobotState state = robotState.read();
+
+        // the selected route, once startup has compiled it
+        static int planned = -1;
+        if (planned != autonRoute && startup.isReady()) {
+            planned = autonRoute;
+            fieldMap.clearPlan();
+            if (autonRoute == skillsRoute) {
+                fieldMap.plan(skills.setupRoute());
+                for (const spf::SkillsPhase& phase : skills.cyclePhases()) fieldMap.plan(phase.route);
+                fieldMap.plan(skills.finishRoute());
+            }
+            for (const spf::Route& route : routes) {
+                if (route.id == autonRoute) fieldMap.plan(route);
+            }
+        }
+        // the trail is kept while the map is hidden, so it shows the whole run when it's opened
+        {
+            spf::ScopedTimer timer(mapTime);
+            fieldMap.update(state.x, state.y, state.theta);
+        }
+
+        // nothing to draw while the info page is hidden
+        if (!showInfo) return;
+        spf::ScopedTimer timer(screenTime);
+        xField.update(state.x);
+        yField.update(state.y);
+        thetaField.update(state.theta);
+        // Temperature (130, 140, 150, 160 °F)
+        tempField.update(state.maxMotorTemperature * 9 / 5 + 32);
+        // how long the hottest motor has at the recent load before the firmware throttles it
+        throttleField.update(std::min(state.timeToThrottle, 999.0f));
+        // once a second, the numbers change slowly and the text is long
+        static int ticks = 0;
+        if (ticks++ % 20 == 0) {
+            char text[128];
+            scheduler.summary(text, sizeof(text), 4);
+            lv_label_set_text(txtLoops, text);
         }
     });
 }
@@ -358,152 +778,72 @@ void initialize() {
 /**
  * Runs while the robot is disabled
  */
-void disabled() {}
+void disabled() {
+    driving = false;
+    input.setMode(spf::InputMode::Disabled);
+    routeRunner.cancelActions();
+    health.endRun();
+    spf::textLog().flush();
+    // loop timing and heap use from the match that just ended. The heap first, writing the rest
+    // allocates
+    if (pros::usd::is_installed()) {
+        FILE* file = fopen("/usd/loop_stats.txt", "a");
+        spf::dumpHeap(file);
+        scheduler.dump(file);
+        startup.dump(file);
+        spf::dumpRegions(file);
+        if (file != nullptr) fclose(file);
+        // the cycles of a skills run, if there was one
+        if (skills.status().finishing) {
+            file = fopen("/usd/skills.txt", "a");
+            skills.dump(file);
+            if (file != nullptr) fclose(file);
+        }
+    } else {
+        spf::dumpHeap();
+        scheduler.dump();
+        startup.dump();
+        spf::dumpRegions();
+        skills.dump();
+    }
+}
 
 /**
  * runs after initialize if the robot is connected to field control
  */
 void competition_initialize() {}
 
-// get a path used for pure pursuit
-// this needs to be put outside a function
-ASSET(example_txt); // '.' replaced with "_" to make c++ happy
-
 /**
  * Runs during auto
  *
  * This is an example autonomous routine which demonstrates a lot of the features LemLib has to offer
  */
 void autonomous() {
+    // calibration and the routes, if the match starts right after the program does. The routes
+    // track the odometry and are compiled on their own task, so the route starts late rather than
+    // not at all, the same as when initialize() did both before returning
+    startup.waitFor("calibrate");
+    startup.waitFor("routes");
+    // everything is allocated by now, the route compiler included, see spf::armHeapGuard
+    spf::armHeapGuard();
+    driving = false;
+    input.setMode(spf::InputMode::Autonomous, autonRoute);
+    fieldMap.clearTrail();
+    // skills autonomous runs for a minute
+    health.startRun(autonRoute == skillsRoute ? skillsLength : 15000);
     //chassis.moveToPose(0, 20, 0, 5000);
     //chassis.turnToHeading(90, 1000, {.minSpeed = 100});
-    int def = 2000;
- 
-    switch (autonRoute) {
-        // Launching (Near side)
-        case 1:
-            chassis.setPose(-44.5, -59.13, 135);
-            chassis.moveToPose(-56.64, -46.93, 135, def, {.forwards = false});
-            chassis.waitUntilDone();
-            wings1.set_value(true);
-            pros::delay(800);
-            chassis.moveToPose(-44.5, -59.13, 135, def);
-            chassis.waitUntilDone();
-            pros::delay(200);
-            wings1.set_value(false);
-            chassis.moveToPose(-9, -59.55, 90, def);
-            intake.set_value(true);
-            chassis.moveToPose(-15, -59.55, 90, def, {.forwards = false});
-            intake.set_value(false);
-            chassis.moveToPose(-9, -59.55, 90, def);
-            wings1.set_value(true);
-            chassis.moveToPose(-9, -59.55, 110, def);
-            break;
-
-        // Offense (Far side)
-        case 2:
-            chassis.setPose(35.5, -61.63, 0);
-
-            chassis.moveToPose(35.5, -9.63, 0, def);
-
-            chassis.moveToPose(35.5, -9.63, 90, def);
-            chassis.waitUntilDone();
-            intake.set_value(true);
-
-            chassis.moveToPose(50.5, -7.63, 90, def, {.minSpeed = 100});
-            chassis.moveToPose(35.5, -7.63, 90, def, {.forwards = false});
-
-            // Next triball
-            chassis.moveToPose(35.5, -7.63, 270, def);
-            chassis.moveToPose(9.5, -23.39, 270, def);
-            chassis.waitUntilDone();
-            intake.set_value(false);
-
-            //from old
-            chassis.setPose(9.7, chassis.getPose().y, chassis.getPose().theta);
-            chassis.moveToPose(15.5, -23.39, 270, def, {.forwards = false});
-            chassis.moveToPose(15.5, -23.39, 355, def);
-            
-            // Final push
-            chassis.moveToPose(7.0, -8.2, 355, def);
-            chassis.moveToPose(7.0, -8.2, 80, def, {.maxSpeed = 20});
-            chassis.waitUntil(5);
-            wings1.set_value(true);
-            intake.set_value(true);
-
-            
-            chassis.moveToPose(42.45, -4.85, 84, 3000);
-
-            chassis.moveToPose(32.25, -4.85, 84, def, {.forwards = false});
-            chassis.waitUntilDone();
-            wings1.set_value(false);
-            intake.set_value(false);
-
-
-            /*chassis.moveToPose(35.5, -55.63, 0, def);
-            chassis.moveToPose(31.32, -12.47, 0, def);
-            chassis.waitUntilDone();
-            intake.set_value(true);
-            pros::delay(500);
-            chassis.moveToPose(31.32, -21.47, 0, def, {.forwards = false});
-
-            chassis.moveToPose(31.32, -21.47, 270, def, {.maxSpeed = 60});
-            chassis.moveToPose(9.5, -23.39, 270, def);
-            chassis.waitUntilDone();
-            intake.set_value(false);
-            chassis.setPose(9.7, chassis.getPose().y, chassis.getPose().theta);
-            chassis.moveToPose(15.5, -23.39, 270, def, {.forwards = false});
-            
-            // Final push
-            chassis.moveToPose(10.0, -8.2, 0, def);
-            chassis.moveToPose(10.0, -8.2, 90, def);
-            chassis.waitUntil(1);
-            wings1.set_value(true);
-            intake.set_value(true);
-
-            chassis.setPose(chassis.getPose().x, chassis.getPose().y, 0);
-            chassis.moveToPose(42.45, -4.85, 90, 3000);
-
-            chassis.moveToPose(32.25, -4.85, 90, def, {.forwards = false});
-            chassis.waitUntilDone();
-            wings1.set_value(false);
-            intake.set_value(false);*/
-
-            break;
-
-        case 4:
-            chassis.moveToPose(0, 15, 0, def);
-            //chassis.turnToHeading(90, def);
-            //chassis.turnToPoint(0, 0, 2000);
-            //chassis.moveToPose(0, 0, 180, 2000);
-            //chassis.turnToHeading(0, def);
-            //chassis.setPose(39.96, -61.222, 0);
-            //chassis.follow(example1_txt, 10, 30000);
-            break;
-        case 5:
-            chassis.setPose(46.92, -59.02, 45);
-            //wings.set_value(true);
-            chassis.moveToPose(59.5, -47.1, 45, def);
-            //wings.set_value(false);
-            break;
- 
-        // Testing
-        case 6:
-            chassis.moveToPose(0, 25, 0, def);
- 
-            chassis.moveToPose(25, 25, 90, def);
- 
-            chassis.moveToPose(25, 0, 180, def);
- 
-            chassis.moveToPose(0, 0, 270, def);
- 
-            chassis.turnToHeading(360, def);
-            break;
- 
-        case 7:
-            chassis.setPose(39.37, -61.02, 0);
-            chassis.follow(example_txt, 10, 30000);
-            break;
+    if (autonRoute == characterizeRoute) {
+        const spf::Characterization fit = spf::characterize(leftMotors, rightMotors, driveModel);
+        if (pros::usd::is_installed()) spf::saveCharacterization(characterizationFile, fit);
+        return;
+    }
+    if (autonRoute == skillsRoute) {
+        skills.run(skillsLength);
+        return;
+    }
+    for (spf::Route& route : routes) {
+        if (route.id == autonRoute) routeRunner.run(route);
     }
 
     /*// Move to x: 20 and y: 15, and face heading 90. Timeout set to 4000 ms
@@ -543,35 +883,43 @@ bool toggle2 = false;
 bool toggle3 = true;
  
 void opcontrol() {
+    spf::armHeapGuard();
+    driving = true;
+    input.setMode(spf::InputMode::Driver);
+    // anything autonomous left held back would fight the driver
+    routeRunner.cancelActions();
+    health.startRun(105000);
     // set up
     wings1.set_value(false);
     wings2.set_value(false);
     intake.set_value(false);
  
-    while (true) {
+    // drive at a fixed 10 ms, above the screen and logging
+    scheduler.runHere("drive", 10, TASK_PRIORITY_DEFAULT + 2, []() {
         // get joystick positions
-        int leftY = controller.get_analog(pros::E_CONTROLLER_ANALOG_LEFT_Y);
-        int rightX = controller.get_analog(pros::E_CONTROLLER_ANALOG_RIGHT_X);
+        int leftY = input.analog(pros::E_CONTROLLER_ANALOG_LEFT_Y);
+        int rightX = input.analog(pros::E_CONTROLLER_ANALOG_RIGHT_X);
  
         // chassis.curvature(leftY, rightX);
-        chassis.arcade(leftY, rightX, 2.7);
+        {
+            spf::ScopedTimer timer(arcadeTime);
+            traction.arcade(leftY, rightX);
+        }
  
         // Pneumatics
-        if (controller.get_digital_new_press(DIGITAL_B)) {
+        if (input.newPress(DIGITAL_B)) {
             wings1.set_value(!toggle);    // When false go to true and in reverse
             toggle = !toggle;    // Flip the toggle to match piston state
         }
  
-        if (controller.get_digital_new_press(DIGITAL_RIGHT)) {
+        if (input.newPress(DIGITAL_RIGHT)) {
             wings2.set_value(!toggle2);    // When false go to true and in reverse
             toggle2 = !toggle2;    // Flip the toggle to match piston state
         }
  
-        if (controller.get_digital_new_press(DIGITAL_Y)) {
+        if (input.newPress(DIGITAL_Y)) {
             intake.set_value(!toggle3);    // When false go to true and in reverse
             toggle3 = !toggle3;    // Flip the toggle to match piston state
         }
- 
-        pros::delay(10);
-    }
+    });
 }
\ No newline at end of file
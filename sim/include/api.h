@@ -0,0 +1,12 @@
+#pragma once
+
+// host stand-in for the PROS api.h umbrella header
+
+#include "display/lvgl.h"
+#include "pros/adi.hpp"
+#include "pros/distance.hpp"
+#include "pros/imu.hpp"
+#include "pros/misc.hpp"
+#include "pros/motors.hpp"
+#include "pros/rotation.hpp"
+#include "pros/rtos.hpp"
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// host stand-in for the LVGL 5.3 subset this project uses. Objects keep their text and
+// visibility so the simulator can report what the brain screen would show.
+
+typedef std::uint8_t lv_res_t;
+#define LV_RES_INV 0
+#define LV_RES_OK 1
+
+struct lv_color_t {
+        std::uint8_t red, green, blue;
+};
+
+#define LV_COLOR_MAKE(r, g, b) (lv_color_t {(std::uint8_t)(r), (std::uint8_t)(g), (std::uint8_t)(b)})
+#define LV_COLOR_WHITE LV_COLOR_MAKE(0xFF, 0xFF, 0xFF)
+#define LV_COLOR_BLACK LV_COLOR_MAKE(0x00, 0x00, 0x00)
+#define LV_COLOR_RED LV_COLOR_MAKE(0xFF, 0x00, 0x00)
+#define LV_COLOR_LIME LV_COLOR_MAKE(0x00, 0xFF, 0x00)
+#define LV_COLOR_GREEN LV_COLOR_MAKE(0x00, 0x80, 0x00)
+#define LV_COLOR_BLUE LV_COLOR_MAKE(0x00, 0x00, 0xFF)
+#define LV_COLOR_YELLOW LV_COLOR_MAKE(0xFF, 0xFF, 0x00)
+#define LV_COLOR_GRAY LV_COLOR_MAKE(0x80, 0x80, 0x80)
+
+typedef std::int16_t lv_coord_t;
+
+struct lv_area_t {
+        lv_coord_t x1, y1, x2, y2; // inclusive, in screen pixels
+};
+
+struct lv_font_t;
+
+struct lv_style_t {
+        struct {
+                lv_color_t main_color, grad_color;
+                lv_coord_t radius;
+                std::uint8_t opa;
+                struct {
+                        lv_color_t color;
+                        lv_coord_t width;
+                } border, shadow;
+        } body;
+
+        struct {
+                lv_color_t color;
+                const lv_font_t* font;
+        } text;
+
+        struct {
+                lv_color_t color;
+                lv_coord_t width;
+        } line;
+};
+
+extern lv_style_t lv_style_plain;
+extern lv_style_t lv_style_plain_color;
+extern lv_style_t lv_style_pretty;
+
+struct lv_obj_t;
+typedef lv_res_t (*lv_action_t)(lv_obj_t* obj);
+
+struct lv_img_dsc_t {
+        std::uint32_t header;
+        std::uint32_t data_size;
+        const std::uint8_t* data;
+};
+
+#define LV_IMG_DECLARE(var_name) extern const lv_img_dsc_t var_name;
+
+enum {
+    LV_ALIGN_CENTER = 0,
+    LV_ALIGN_IN_TOP_LEFT,
+    LV_ALIGN_IN_TOP_MID,
+    LV_ALIGN_IN_TOP_RIGHT,
+    LV_ALIGN_IN_BOTTOM_LEFT,
+    LV_ALIGN_IN_BOTTOM_MID,
+    LV_ALIGN_IN_BOTTOM_RIGHT,
+    LV_ALIGN_IN_LEFT_MID,
+    LV_ALIGN_IN_RIGHT_MID,
+};
+typedef std::uint8_t lv_align_t;
+
+enum { LV_BTN_ACTION_CLICK = 0, LV_BTN_ACTION_PR, LV_BTN_ACTION_LONG_PR, LV_BTN_ACTION_LONG_PR_REPEAT };
+typedef std::uint8_t lv_btn_action_t;
+
+enum { LV_BTN_STYLE_REL = 0, LV_BTN_STYLE_PR, LV_BTN_STYLE_TGL_REL, LV_BTN_STYLE_TGL_PR, LV_BTN_STYLE_INA };
+typedef std::uint8_t lv_btn_style_t;
+
+enum { LV_IMG_CF_TRUE_COLOR = 4 };
+typedef std::uint8_t lv_img_cf_t;
+
+#define SYMBOL_HOME "\xEF\xA0\x80"
+#define SYMBOL_SETTINGS "\xEF\xA0\x88"
+
+/** what the simulator records for every object; real LVGL keeps this private */
+struct lv_obj_t {
+        lv_obj_t* parent = nullptr;
+        std::string text;
+        bool hidden = false;
+        std::uint32_t freeNum = 0;
+        lv_action_t action = nullptr;
+        lv_coord_t width = 0, height = 0;
+        const lv_color_t* buffer = nullptr; // canvases
+};
+
+lv_obj_t* lv_scr_act();
+lv_obj_t* lv_obj_create(lv_obj_t* parent, const lv_obj_t* copy);
+void lv_obj_align(lv_obj_t* obj, const lv_obj_t* base, lv_align_t align, lv_coord_t x_mod, lv_coord_t y_mod);
+void lv_obj_set_hidden(lv_obj_t* obj, bool en);
+void lv_obj_set_size(lv_obj_t* obj, lv_coord_t w, lv_coord_t h);
+void lv_obj_set_pos(lv_obj_t* obj, lv_coord_t x, lv_coord_t y);
+void lv_obj_set_free_num(lv_obj_t* obj, std::uint32_t free_num);
+std::uint32_t lv_obj_get_free_num(const lv_obj_t* obj);
+void lv_obj_set_style(lv_obj_t* obj, lv_style_t* style);
+void lv_obj_invalidate(const lv_obj_t* obj);
+
+void lv_style_copy(lv_style_t* dest, const lv_style_t* src);
+
+lv_obj_t* lv_img_create(lv_obj_t* par, const lv_obj_t* copy);
+void lv_img_set_src(lv_obj_t* img, const void* src_img);
+
+lv_obj_t* lv_btn_create(lv_obj_t* par, const lv_obj_t* copy);
+void lv_btn_set_action(lv_obj_t* btn, lv_btn_action_t type, lv_action_t action);
+void lv_btn_set_style(lv_obj_t* btn, lv_btn_style_t type, lv_style_t* style);
+
+lv_obj_t* lv_label_create(lv_obj_t* par, const lv_obj_t* copy);
+void lv_label_set_text(lv_obj_t* label, const char* text);
+const char* lv_label_get_text(const lv_obj_t* label);
+void lv_label_set_style(lv_obj_t* label, lv_style_t* style);
+
+lv_obj_t* lv_canvas_create(lv_obj_t* par, const lv_obj_t* copy);
+void lv_canvas_set_buffer(lv_obj_t* canvas, void* buf, lv_coord_t w, lv_coord_t h, lv_img_cf_t cf);
+
+/** mark part of the screen to be redrawn on the next refresh */
+void lv_inv_area(const lv_area_t* area_p);
+
+namespace sim {
+/** number of LVGL calls that would have touched the display, for measuring UI load */
+std::uint64_t lvglCalls();
+/** pixels invalidated so far, which LVGL would have had to redraw */
+std::uint64_t lvglPixels();
+/** write what a canvas shows to a PPM image. Returns false if it can't be written */
+bool writeCanvas(const lv_obj_t* canvas, const char* name);
+} // namespace sim
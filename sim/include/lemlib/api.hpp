@@ -0,0 +1,13 @@
+#pragma once
+
+// host stand-in for the LemLib 0.5 umbrella header
+
+#include "lemlib/asset.hpp"
+#include "lemlib/chassis/chassis.hpp"
+#include "lemlib/chassis/trackingWheel.hpp"
+#include "lemlib/exitcondition.hpp"
+#include "lemlib/logger/logger.hpp"
+#include "lemlib/pid.hpp"
+#include "lemlib/pose.hpp"
+#include "lemlib/timer.hpp"
+#include "lemlib/util.hpp"
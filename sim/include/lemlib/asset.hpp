@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// host stand-in for lemlib/asset.hpp. On the robot ASSET() points at a file from static/ that the
+// linker embeds; on the host the same file is read from SPF_STATIC_DIR at startup.
+
+struct asset {
+        std::uint8_t* buf;
+        std::size_t size;
+};
+
+namespace lemlib {
+/** load static/<name> with the last '_' turned back into '.', as the PROS linker names them */
+asset loadStaticAsset(const char* name);
+} // namespace lemlib
+
+#define ASSET(x) static asset x = lemlib::loadStaticAsset(#x);
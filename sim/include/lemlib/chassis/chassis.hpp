@@ -0,0 +1,184 @@
+#pragma once
+
+#include <cstdint>
+
+#include "lemlib/asset.hpp"
+#include "lemlib/chassis/trackingWheel.hpp"
+#include "lemlib/exitcondition.hpp"
+#include "lemlib/pid.hpp"
+#include "lemlib/pose.hpp"
+#include "lemlib/util.hpp"
+#include "pros/imu.hpp"
+#include "pros/motors.hpp"
+#include "pros/rtos.hpp"
+
+/**
+ * Host stand-in for lemlib/chassis/chassis.hpp
+ *
+ * Mirrors the LemLib 0.5 interface used by this project: odometry, the boomerang moveToPose,
+ * moveToPoint, turns, pure pursuit and the driver control helpers, with the same motion queueing
+ * and motion chaining (minSpeed/earlyExitRange) semantics.
+ */
+
+namespace lemlib {
+
+struct OdomSensors {
+        OdomSensors(TrackingWheel* vertical1, TrackingWheel* vertical2, TrackingWheel* horizontal1,
+                    TrackingWheel* horizontal2, pros::Imu* imu);
+        TrackingWheel* vertical1;
+        TrackingWheel* vertical2;
+        TrackingWheel* horizontal1;
+        TrackingWheel* horizontal2;
+        pros::Imu* imu;
+};
+
+struct ControllerSettings {
+        ControllerSettings(float kP, float kI, float kD, float windupRange, float smallError, float smallErrorTimeout,
+                           float largeError, float largeErrorTimeout, float slew)
+            : kP(kP),
+              kI(kI),
+              kD(kD),
+              windupRange(windupRange),
+              smallError(smallError),
+              smallErrorTimeout(smallErrorTimeout),
+              largeError(largeError),
+              largeErrorTimeout(largeErrorTimeout),
+              slew(slew) {}
+
+        float kP;
+        float kI;
+        float kD;
+        float windupRange;
+        float smallError;
+        float smallErrorTimeout;
+        float largeError;
+        float largeErrorTimeout;
+        float slew;
+};
+
+struct Drivetrain {
+        Drivetrain(pros::MotorGroup* leftMotors, pros::MotorGroup* rightMotors, float trackWidth, float wheelDiameter,
+                   float rpm, float horizontalDrift);
+        pros::MotorGroup* leftMotors;
+        pros::MotorGroup* rightMotors;
+        float trackWidth;
+        float wheelDiameter;
+        float rpm;
+        float horizontalDrift;
+};
+
+class DriveCurve {
+    public:
+        virtual float curve(float input) = 0;
+        virtual ~DriveCurve() = default;
+};
+
+class ExpoDriveCurve : public DriveCurve {
+    public:
+        ExpoDriveCurve(float deadband, float minOutput, float curve);
+        float curve(float input) override;
+    private:
+        const float deadband = 0;
+        const float minOutput = 0;
+        const float curveGain = 1;
+};
+
+extern ExpoDriveCurve defaultDriveCurve;
+
+struct TurnToPointParams {
+        bool forwards = true;
+        AngularDirection direction = AngularDirection::AUTO;
+        int maxSpeed = 127;
+        int minSpeed = 0;
+        float earlyExitRange = 0;
+};
+
+struct TurnToHeadingParams {
+        AngularDirection direction = AngularDirection::AUTO;
+        int maxSpeed = 127;
+        int minSpeed = 0;
+        float earlyExitRange = 0;
+};
+
+struct MoveToPoseParams {
+        bool forwards = true;
+        float horizontalDrift = 0;
+        float lead = 0.6;
+        float maxSpeed = 127;
+        float minSpeed = 0;
+        float earlyExitRange = 0;
+};
+
+struct MoveToPointParams {
+        bool forwards = true;
+        float maxSpeed = 127;
+        float minSpeed = 0;
+        float earlyExitRange = 0;
+};
+
+class Chassis {
+    public:
+        Chassis(Drivetrain drivetrain, ControllerSettings linearSettings, ControllerSettings angularSettings,
+                OdomSensors sensors, DriveCurve* throttleCurve = &defaultDriveCurve,
+                DriveCurve* steerCurve = &defaultDriveCurve);
+
+        void calibrate(bool calibrateIMU = true);
+        void setPose(float x, float y, float theta, bool radians = false);
+        void setPose(Pose pose, bool radians = false);
+        Pose getPose(bool radians = false, bool standardPos = false);
+        void waitUntil(float dist);
+        void waitUntilDone();
+        void cancelMotion();
+        void cancelAllMotions();
+        bool isInMotion() const;
+        void setBrakeMode(pros::motor_brake_mode_e_t mode);
+
+        void turnToPoint(float x, float y, int timeout, TurnToPointParams params = {}, bool async = true);
+        void turnToHeading(float theta, int timeout, TurnToHeadingParams params = {}, bool async = true);
+        void moveToPose(float x, float y, float theta, int timeout, MoveToPoseParams params = {},
+                        bool async = true);
+        void moveToPoint(float x, float y, int timeout, MoveToPointParams params = {}, bool async = true);
+        void follow(const asset& path, float lookahead, int timeout, bool forwards = true, bool async = true);
+
+        void tank(int left, int right, bool disableDriveCurve = false);
+        void arcade(int throttle, int turn, bool disableDriveCurve = false, float desaturateBias = 0.5);
+        void curvature(int throttle, int turn, bool disableDriveCurve = false);
+
+        /** host only: retune the motion controllers between simulated runs */
+        void setControllerSettings(ControllerSettings linear, ControllerSettings angular);
+        const ControllerSettings& getLateralSettings() const { return lateralSettings; }
+        const ControllerSettings& getAngularSettings() const { return angularSettings; }
+    protected:
+        void requestMotionStart();
+        void endMotion();
+        void updateOdom();
+
+        bool motionRunning = false;
+        bool motionQueued = false;
+
+        float distTraveled = 0;
+
+        ControllerSettings lateralSettings;
+        ControllerSettings angularSettings;
+        Drivetrain drivetrain;
+        OdomSensors sensors;
+        DriveCurve* throttleCurve;
+        DriveCurve* steerCurve;
+
+        PID lateralPID;
+        PID angularPID;
+        ExitCondition lateralLargeExit;
+        ExitCondition lateralSmallExit;
+        ExitCondition angularLargeExit;
+        ExitCondition angularSmallExit;
+    private:
+        pros::Mutex mutex;
+        Pose odomPose = Pose(0, 0, 0); // compass heading, radians
+        float prevVertical = 0;
+        float prevHorizontal = 0;
+        float prevImu = 0;
+        bool odomStarted = false;
+        TrackingWheel* odomVertical = nullptr;
+        TrackingWheel* odomHorizontal = nullptr;
+};
+} // namespace lemlib
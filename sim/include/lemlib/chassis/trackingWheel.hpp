@@ -0,0 +1,44 @@
+#pragma once
+
+#include "pros/motors.hpp"
+#include "pros/rotation.hpp"
+
+// host stand-in for lemlib/chassis/trackingWheel.hpp (LemLib 0.5 interface)
+
+namespace lemlib {
+namespace Omniwheel {
+constexpr float NEW_2 = 2.125;
+constexpr float NEW_275 = 2.75;
+constexpr float OLD_275 = 2.75;
+constexpr float NEW_275_HALF = 2.744;
+constexpr float OLD_275_HALF = 2.74;
+constexpr float NEW_325 = 3.25;
+constexpr float OLD_325 = 3.25;
+constexpr float NEW_325_HALF = 3.246;
+constexpr float OLD_325_HALF = 3.246;
+constexpr float NEW_4 = 4;
+constexpr float OLD_4 = 4.18;
+constexpr float NEW_4_HALF = 3.995;
+constexpr float OLD_4_HALF = 4.175;
+} // namespace Omniwheel
+
+class TrackingWheel {
+    public:
+        TrackingWheel(pros::Rotation* encoder, float wheelDiameter, float distance, float gearRatio = 1);
+        TrackingWheel(pros::MotorGroup* motors, float wheelDiameter, float distance, float rpm);
+
+        void reset();
+        /** distance rolled in inches */
+        float getDistanceTraveled();
+        /** offset from the tracking center in inches, left is negative */
+        float getOffset();
+        int getType();
+    private:
+        float diameter;
+        float distance;
+        float rpm;
+        pros::Rotation* rotation = nullptr;
+        pros::MotorGroup* motors = nullptr;
+        const float gearRatio = 1;
+};
+} // namespace lemlib
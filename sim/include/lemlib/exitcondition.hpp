@@ -0,0 +1,20 @@
+#pragma once
+
+// host stand-in for lemlib/exitcondition.hpp (LemLib 0.5 interface)
+
+namespace lemlib {
+class ExitCondition {
+    public:
+        ExitCondition(const float range, const int time);
+
+        bool getExit();
+        /** true once the error has stayed within range for the configured time */
+        bool update(const float input);
+        void reset();
+    protected:
+        float range;
+        int time;
+        int startTime = -1;
+        bool done = false;
+};
+} // namespace lemlib
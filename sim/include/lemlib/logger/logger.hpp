@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+// host stand-in for the LemLib telemetry sink; "{}" placeholders are filled from operator<<
+
+namespace lemlib {
+
+class TelemetrySink {
+    public:
+        template <typename... Args> void info(std::string_view format, const Args&... args) {
+            if (!enabled) return;
+            std::ostringstream out;
+            formatTo(out, format, args...);
+            write(out.str());
+        }
+
+        template <typename... Args> void debug(std::string_view format, const Args&... args) {
+            info(format, args...);
+        }
+
+        template <typename... Args> void warn(std::string_view format, const Args&... args) {
+            info(format, args...);
+        }
+
+        template <typename... Args> void error(std::string_view format, const Args&... args) {
+            info(format, args...);
+        }
+
+        /** the host run decides whether telemetry is printed; it is dropped by default */
+        bool enabled = false;
+        std::uint64_t messages = 0;
+    private:
+        void write(const std::string& message);
+
+        static void formatTo(std::ostringstream& out, std::string_view format) { out << format; }
+
+        template <typename T, typename... Rest>
+        static void formatTo(std::ostringstream& out, std::string_view format, const T& first, const Rest&... rest) {
+            const std::size_t slot = format.find("{}");
+            if (slot == std::string_view::npos) {
+                out << format;
+                return;
+            }
+            out << format.substr(0, slot) << first;
+            formatTo(out, format.substr(slot + 2), rest...);
+        }
+};
+
+std::shared_ptr<TelemetrySink> telemetrySink();
+std::shared_ptr<TelemetrySink> infoSink();
+} // namespace lemlib
@@ -0,0 +1,23 @@
+#pragma once
+
+// host stand-in for lemlib/pid.hpp (LemLib 0.5 interface)
+
+namespace lemlib {
+class PID {
+    public:
+        PID(float kP, float kI, float kD, float windupRange = 0, bool signFlipReset = false);
+
+        float update(float error);
+        void reset();
+        void setGains(float kP, float kI, float kD);
+    protected:
+        float kP;
+        float kI;
+        float kD;
+        float windupRange;
+        bool signFlipReset;
+
+        float integral = 0;
+        float prevError = 0;
+};
+} // namespace lemlib
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <ostream>
+
+// host stand-in for lemlib/pose.hpp (LemLib 0.5 interface)
+
+namespace lemlib {
+class Pose {
+    public:
+        float x;
+        float y;
+        float theta;
+
+        Pose(float x, float y, float theta = 0);
+        Pose operator+(const Pose& other) const;
+        Pose operator-(const Pose& other) const;
+        float operator*(const Pose& other) const;
+        Pose operator*(const float& other) const;
+        Pose operator/(const float& other) const;
+        Pose lerp(Pose other, float t) const;
+        float distance(Pose other) const;
+        /** standard position angle of the vector from this pose to other, in radians */
+        float angle(Pose other) const;
+        Pose rotate(float angle) const;
+};
+
+std::ostream& operator<<(std::ostream& os, const Pose& pose);
+} // namespace lemlib
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+
+// host stand-in for lemlib/timer.hpp (LemLib 0.5 interface)
+
+namespace lemlib {
+class Timer {
+    public:
+        explicit Timer(std::uint32_t time);
+
+        std::uint32_t getTimeLeft();
+        std::uint32_t getTimePassed();
+        bool isDone();
+        void reset();
+    private:
+        std::uint32_t period;
+        std::uint32_t start;
+};
+} // namespace lemlib
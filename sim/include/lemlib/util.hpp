@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cmath>
+
+#include "lemlib/pose.hpp"
+
+// host stand-in for lemlib/util.hpp (LemLib 0.5 interface)
+
+namespace lemlib {
+
+enum class AngularDirection { CW_CLOCKWISE, CCW_COUNTERCLOCKWISE, AUTO };
+
+float slew(float target, float current, float maxChange);
+float radToDeg(float rad);
+float degToRad(float deg);
+float sanitizeAngle(float angle, bool radians = true);
+/** angle1 - angle2 wrapped to the shortest turn, or forced in a direction */
+float angleError(float angle1, float angle2, bool radians = true,
+                 AngularDirection direction = AngularDirection::AUTO);
+
+template <typename T> constexpr T sgn(T value) { return value < 0 ? -1 : 1; }
+
+float ema(float current, float previous, float smooth);
+/** signed curvature of the arc from pose (standard position, radians) through other */
+float getCurvature(Pose pose, Pose other);
+} // namespace lemlib
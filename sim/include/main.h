@@ -0,0 +1,33 @@
+#pragma once
+
+/**
+ * Host build of the PROS main.h
+ *
+ * The robot program includes "main.h" for the PROS API. In the host build this directory is first
+ * on the include path, so the same main.cpp compiles against the simulated devices in sim/src.
+ */
+
+#define PROS_USE_SIMPLE_NAMES
+#define PROS_USE_LITERALS
+
+#include "api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+void autonomous(void);
+void initialize(void);
+void disabled(void);
+void competition_initialize(void);
+void opcontrol(void);
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef __cplusplus
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <iterator>
+#endif
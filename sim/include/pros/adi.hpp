@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+
+// host stand-in for pros/adi.hpp; digital outputs drive the simulated pneumatics
+
+namespace pros {
+
+class ADIDigitalOut {
+    public:
+        explicit ADIDigitalOut(std::uint8_t adi_port, bool init_state = false);
+
+        std::int32_t set_value(std::int32_t value);
+    private:
+        char port;
+        bool initial;
+};
+
+namespace adi {
+using DigitalOut = ADIDigitalOut;
+} // namespace adi
+
+} // namespace pros
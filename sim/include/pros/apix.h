@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "pros/rtos.hpp"
+
+// host stand-in for the static task creation in pros/apix.h, backed by sim::Runtime
+
+namespace pros {
+namespace c {
+
+typedef sim::TaskId task_t;
+typedef void (*task_fn_t)(void*);
+typedef std::uint32_t task_stack_t;
+
+/** the kernel's task control block, which the host keeps for itself */
+typedef struct static_task_s {
+} static_task_s_t;
+
+/** runs the task on a host thread whose stack is stack_buffer, as the brain's would be */
+inline task_t task_create_static(task_fn_t task_code, void* const param, std::uint32_t prio,
+                                 const std::size_t stack_depth, const char* const name,
+                                 task_stack_t* const stack_buffer, static_task_s_t* const) {
+    return sim::Runtime::get().spawn([task_code, param]() { task_code(param); }, prio, name, stack_buffer,
+                                     stack_depth * sizeof(task_stack_t));
+}
+
+} // namespace c
+} // namespace pros
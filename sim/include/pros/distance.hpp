@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+// host stand-in for pros/distance.hpp, ranging off the simulated field walls from sim::World
+
+namespace pros {
+
+class Distance {
+    public:
+        explicit Distance(std::uint8_t port);
+
+        std::int32_t get(); // mm, 9999 with nothing in range
+        std::int32_t get_confidence(); // 0 - 63, 63 when the reading is sure
+        std::int32_t get_object_size(); // 0 - 400
+        double get_object_velocity(); // m/s
+        std::uint8_t get_port() const { return port; }
+    private:
+        std::uint8_t port;
+};
+
+} // namespace pros
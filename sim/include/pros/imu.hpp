@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+// host stand-in for pros/imu.hpp, reading the simulated heading from sim::World
+
+namespace pros {
+
+enum class ImuStatus { ready = 0, calibrating = 19, error = 0xFF };
+
+class Imu {
+    public:
+        explicit Imu(std::uint8_t port);
+
+        std::int32_t reset(bool blocking = false);
+        bool is_calibrating() const;
+        ImuStatus get_status() const;
+        double get_heading() const;
+        double get_rotation() const;
+        double get_yaw() const;
+        std::int32_t tare();
+        std::int32_t tare_heading();
+        std::int32_t tare_rotation();
+        std::int32_t set_heading(double target);
+        std::int32_t set_rotation(double target);
+        std::int32_t set_data_rate(std::uint32_t rate);
+        std::uint8_t get_port() const { return port; }
+    private:
+        std::uint8_t port;
+};
+
+} // namespace pros
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "pros/misc.h"
+
+// host stand-in for pros/misc.hpp; controller input comes from sim::World::controller()
+
+namespace pros {
+
+class Controller {
+    public:
+        explicit Controller(controller_id_e_t id);
+
+        std::int32_t get_analog(controller_analog_e_t channel);
+        std::int32_t get_digital(controller_digital_e_t button);
+        /** true once per press, like the firmware's rising edge latch */
+        std::int32_t get_digital_new_press(controller_digital_e_t button);
+        std::int32_t is_connected() { return 1; }
+    private:
+        controller_id_e_t id;
+        std::array<bool, 12> latched {};
+};
+
+namespace competition {
+/** whether a field or competition switch is plugged in, never in the simulator */
+std::uint8_t is_connected();
+} // namespace competition
+
+namespace battery {
+double get_voltage();
+} // namespace battery
+
+namespace usd {
+std::int32_t is_installed();
+} // namespace usd
+
+} // namespace pros
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+// host stand-in for pros/motors.hpp, backed by the simulated smart motors in sim::World
+
+namespace pros {
+
+enum motor_gearset_e_t { E_MOTOR_GEARSET_36 = 0, E_MOTOR_GEARSET_18, E_MOTOR_GEARSET_06, E_MOTOR_GEARSET_INVALID };
+enum motor_brake_mode_e_t { E_MOTOR_BRAKE_COAST = 0, E_MOTOR_BRAKE_BRAKE, E_MOTOR_BRAKE_HOLD, E_MOTOR_BRAKE_INVALID };
+enum motor_encoder_units_e_t { E_MOTOR_ENCODER_DEGREES = 0, E_MOTOR_ENCODER_ROTATIONS, E_MOTOR_ENCODER_COUNTS,
+                               E_MOTOR_ENCODER_INVALID };
+
+class Motor {
+    public:
+        Motor(std::int8_t port, motor_gearset_e_t gearset, bool reverse = false,
+              motor_encoder_units_e_t encoder_units = E_MOTOR_ENCODER_DEGREES);
+        Motor(std::int8_t port, bool reverse = false);
+
+        std::int32_t move(std::int32_t voltage);
+        std::int32_t move_voltage(std::int32_t voltage);
+        std::int32_t move_velocity(std::int32_t velocity);
+        std::int32_t brake();
+
+        double get_actual_velocity() const;
+        double get_position() const;
+        std::int32_t tare_position() const;
+        std::int32_t set_zero_position(double position) const;
+        double get_temperature() const;
+        std::int32_t get_current_draw() const;
+        double get_power() const;
+        double get_efficiency() const;
+        double get_torque() const;
+        std::int32_t get_voltage() const;
+        std::int32_t is_over_temp() const;
+        std::int32_t is_over_current() const;
+
+        std::int32_t set_brake_mode(motor_brake_mode_e_t mode) const;
+        std::int32_t set_current_limit(std::int32_t limit) const;
+        std::int32_t get_current_limit() const;
+        std::int32_t set_voltage_limit(std::int32_t limit) const;
+        std::int32_t get_voltage_limit() const;
+        std::int32_t set_gearing(motor_gearset_e_t gearset);
+        motor_gearset_e_t get_gearing() const { return gearset; }
+        std::int32_t set_reversed(bool reverse);
+        std::int32_t is_reversed() const { return reversed; }
+        std::int32_t set_encoder_units(motor_encoder_units_e_t units);
+        std::uint8_t get_port() const { return port; }
+    private:
+        double sign() const { return reversed ? -1 : 1; }
+
+        std::uint8_t port;
+        motor_gearset_e_t gearset = E_MOTOR_GEARSET_18;
+        motor_encoder_units_e_t units = E_MOTOR_ENCODER_DEGREES;
+        bool reversed = false;
+};
+
+class MotorGroup {
+    public:
+        MotorGroup(std::initializer_list<Motor> motors);
+        MotorGroup(const std::vector<Motor>& motors);
+
+        std::int32_t move(std::int32_t voltage);
+        std::int32_t move_voltage(std::int32_t voltage);
+        std::int32_t move_velocity(std::int32_t velocity);
+        std::int32_t brake();
+
+        std::vector<double> get_actual_velocities();
+        std::vector<double> get_positions();
+        std::int32_t tare_position();
+        std::vector<double> get_temperatures();
+        std::vector<std::int32_t> get_current_draws();
+        std::vector<double> get_powers();
+        std::vector<double> get_efficiencies();
+        std::vector<std::int32_t> get_voltages();
+
+        std::int32_t set_brake_modes(motor_brake_mode_e_t mode);
+        std::int32_t set_current_limit(std::int32_t limit);
+        std::int32_t set_voltage_limit(std::int32_t limit);
+        std::vector<std::int32_t> get_voltage_limits();
+        std::vector<motor_gearset_e_t> get_gearing();
+
+        int size() const { return static_cast<int>(motors.size()); }
+        Motor& operator[](int i) { return motors[i]; }
+    private:
+        std::vector<Motor> motors;
+};
+
+} // namespace pros
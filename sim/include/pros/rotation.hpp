@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+// host stand-in for pros/rotation.hpp, reading the simulated tracking wheels from sim::World
+
+namespace pros {
+
+class Rotation {
+    public:
+        Rotation(std::uint8_t port, bool reverse_flag = false);
+
+        std::int32_t reset_position();
+        std::int32_t set_position(std::uint32_t position);
+        std::int32_t get_position() const; // centidegrees
+        std::int32_t get_angle() const; // centidegrees, 0 - 36000
+        std::int32_t get_velocity() const; // centidegrees per second
+        std::int32_t set_data_rate(std::uint32_t rate);
+        std::int32_t set_reversed(bool value);
+        std::int32_t get_reversed() const { return reversed; }
+        std::uint8_t get_port() const { return port; }
+    private:
+        double sign() const { return reversed ? -1 : 1; }
+
+        std::uint8_t port;
+        bool reversed;
+};
+
+} // namespace pros
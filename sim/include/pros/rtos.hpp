@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+
+#include "sim/runtime.hpp"
+
+// host stand-in for the subset of pros/rtos.hpp this project uses, backed by sim::Runtime
+
+#define TASK_PRIORITY_MAX 16
+#define TASK_PRIORITY_DEFAULT 8
+#define TASK_PRIORITY_MIN 1
+#define TASK_STACK_DEPTH_DEFAULT 0x2000
+#define TASK_STACK_DEPTH_MIN 0x200
+#define TIMEOUT_MAX ((std::uint32_t)0xffffffffUL)
+
+namespace pros {
+
+enum task_state_e_t { E_TASK_STATE_RUNNING = 0, E_TASK_STATE_READY, E_TASK_STATE_BLOCKED, E_TASK_STATE_SUSPENDED,
+                      E_TASK_STATE_DELETED, E_TASK_STATE_INVALID };
+
+inline std::uint32_t millis() { return static_cast<std::uint32_t>(sim::Runtime::get().nowUs() / 1000); }
+
+inline std::uint64_t micros() { return sim::Runtime::get().nowUs(); }
+
+inline void delay(std::uint32_t milliseconds) { sim::Runtime::get().sleepFor(std::uint64_t(milliseconds) * 1000); }
+
+class Task {
+    public:
+        template <class F, class = std::enable_if_t<std::is_invocable_v<F>>>
+        Task(F&& function, std::uint32_t prio = TASK_PRIORITY_DEFAULT,
+             std::uint16_t = TASK_STACK_DEPTH_DEFAULT, const char* name = "")
+            : id(sim::Runtime::get().spawn(std::function<void()>(std::forward<F>(function)), prio, name)) {}
+
+        template <class F, class = std::enable_if_t<std::is_invocable_v<F>>>
+        Task(F&& function, const char* name)
+            : Task(std::forward<F>(function), TASK_PRIORITY_DEFAULT, TASK_STACK_DEPTH_DEFAULT, name) {}
+
+        static Task current() { return Task(sim::Runtime::get().current()); }
+
+        void remove() { sim::Runtime::get().remove(id); }
+
+        std::uint32_t get_priority() { return sim::Runtime::get().priority(id); }
+
+        void set_priority(std::uint32_t prio) { sim::Runtime::get().setPriority(id, prio); }
+
+        const char* get_name() { return sim::Runtime::get().name(id); }
+
+        std::uint32_t get_state() {
+            return sim::Runtime::get().isDone(id) ? E_TASK_STATE_DELETED : E_TASK_STATE_READY;
+        }
+
+        static void delay(std::uint32_t milliseconds) { pros::delay(milliseconds); }
+
+        /** sleep until prev_time + delta and advance prev_time, like vTaskDelayUntil */
+        static void delay_until(std::uint32_t* const prev_time, std::uint32_t delta) {
+            *prev_time += delta;
+            sim::Runtime::get().sleepUntil(std::uint64_t(*prev_time) * 1000);
+        }
+
+        sim::TaskId handle() const { return id; }
+    private:
+        explicit Task(sim::TaskId id)
+            : id(id) {}
+
+        sim::TaskId id;
+};
+
+/**
+ * Only one simulated task runs at a time, so a mutex only has to make other tasks wait while a
+ * holder is asleep.
+ */
+class Mutex {
+    public:
+        bool take(std::uint32_t timeout = TIMEOUT_MAX) {
+            const std::uint32_t start = millis();
+            while (locked) {
+                if (timeout != TIMEOUT_MAX && millis() - start >= timeout) return false;
+                pros::delay(1);
+            }
+            locked = true;
+            return true;
+        }
+
+        bool give() {
+            locked = false;
+            return true;
+        }
+
+        void lock() { take(); }
+
+        void unlock() { give(); }
+    private:
+        bool locked = false;
+};
+
+namespace c {
+inline std::uint32_t millis() { return pros::millis(); }
+
+inline std::uint64_t micros() { return pros::micros(); }
+
+inline void delay(std::uint32_t milliseconds) { pros::delay(milliseconds); }
+
+inline void task_delay_until(std::uint32_t* const prev_time, std::uint32_t delta) {
+    Task::delay_until(prev_time, delta);
+}
+} // namespace c
+
+} // namespace pros
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <functional>
+#include <optional>
+#include <sys/wait.h>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+
+namespace sim {
+
+/** host cores, the number of runs to keep going at once by default */
+inline int hostCores() { return int(std::max(1L, sysconf(_SC_NPROCESSORS_ONLN))); }
+
+/**
+ * Runs count simulations, each in its own child process, up to jobs of them at a time
+ *
+ * The robot program's globals only run once per process, so every simulated run needs a fresh
+ * one. run(i) is called in the child and its result comes back through a pipe; a run whose child
+ * failed comes back empty. Results are in order of i.
+ */
+template <typename Result>
+std::vector<std::optional<Result>> runParallel(std::size_t count, int jobs,
+                                               const std::function<Result(std::size_t)>& run) {
+    static_assert(std::is_trivially_copyable_v<Result>, "results are copied back through a pipe");
+    // the child writes its result and exits before the parent reads it
+    static_assert(sizeof(Result) <= PIPE_BUF, "a result must fit in the pipe");
+    struct Child {
+            pid_t pid;
+            int fd;
+            std::size_t index;
+    };
+    std::vector<std::optional<Result>> results(count);
+    std::vector<Child> children;
+
+    const auto reap = [&] {
+        int status = 0;
+        const pid_t pid = waitpid(-1, &status, 0);
+        const auto child =
+            std::find_if(children.begin(), children.end(), [&](const Child& c) { return c.pid == pid; });
+        if (child == children.end()) return;
+        Result result;
+        if (read(child->fd, &result, sizeof(result)) == sizeof(result) && WIFEXITED(status) &&
+            WEXITSTATUS(status) == 0) {
+            results[child->index] = result;
+        }
+        close(child->fd);
+        children.erase(child);
+    };
+
+    for (std::size_t i = 0; i < count; i++) {
+        while (int(children.size()) >= std::max(jobs, 1)) reap();
+        int fds[2];
+        if (pipe(fds) != 0) continue;
+        // or the child flushes the parent's buffered output a second time
+        std::fflush(stdout);
+        const pid_t pid = fork();
+        if (pid == 0) {
+            close(fds[0]);
+            const Result result = run(i);
+            const bool ok = write(fds[1], &result, sizeof(result)) == sizeof(result);
+            _exit(ok ? 0 : 1);
+        }
+        close(fds[1]);
+        if (pid < 0) {
+            close(fds[0]);
+            continue;
+        }
+        children.push_back({pid, fds[0], i});
+    }
+    while (!children.empty()) reap();
+    return results;
+}
+
+} // namespace sim
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace sim {
+
+using TaskId = std::uint32_t;
+
+/**
+ * Thrown inside a task to unwind it when the task is removed or the run ends.
+ * Robot code never catches it.
+ */
+struct Halt {};
+
+/**
+ * Virtual clock and lockstep task scheduler
+ *
+ * Every pros::Task is backed by a host thread, but only one of them runs at a time. A task keeps
+ * the CPU until it sleeps. The scheduler then advances the virtual clock to the earliest wake
+ * time, calling the tick hook once per simulated millisecond on the way, and hands control to that
+ * task. Nothing depends on wall time, so a run is deterministic and goes as fast as the host can
+ * compute it.
+ */
+class Runtime {
+    public:
+        using TickHook = std::function<void(std::uint64_t nowUs)>;
+
+        static Runtime& get();
+
+        /**
+         * Run entry as task 0 on the calling thread
+         *
+         * When entry returns every remaining task is unwound and joined, so the call only returns
+         * once the simulated program is gone.
+         */
+        void run(const std::function<void()>& entry, TickHook hook);
+
+        /**
+         * @param stack memory for the host thread's stack, as task_create_static is given on the
+         * brain, or nullptr for the thread's own
+         */
+        TaskId spawn(std::function<void()> fn, std::uint32_t priority, const char* name, void* stack = nullptr,
+                     std::size_t stackSize = 0);
+        void remove(TaskId id);
+        bool isDone(TaskId id);
+
+        /** put the running task to sleep until the given virtual time */
+        void sleepUntil(std::uint64_t wakeUs);
+        void sleepFor(std::uint64_t us) { sleepUntil(nowUs() + us); }
+
+        std::uint64_t nowUs() const { return now; }
+        TaskId current() const { return running; }
+        std::uint32_t priority(TaskId id);
+        void setPriority(TaskId id, std::uint32_t priority);
+        const char* name(TaskId id);
+    private:
+        Runtime() = default;
+        struct Impl;
+        Impl* impl = nullptr;
+        std::uint64_t now = 0;
+        TaskId running = 0;
+};
+
+} // namespace sim
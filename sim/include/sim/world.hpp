@@ -0,0 +1,215 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace sim {
+
+/** field pose in inches and compass degrees (0 = +y, clockwise positive), same as lemlib */
+struct FieldPose {
+        double x = 0;
+        double y = 0;
+        double theta = 0;
+};
+
+struct DriveMotorSpec {
+        int port;
+        int mount; // +1 if positive raw voltage drives its side forwards
+};
+
+struct TrackerSpec {
+        int port;
+        int mount; // +1 if the raw angle increases when the wheel rolls forwards
+        double diameter; // in
+        double offset; // in, right of the tracking center is positive
+};
+
+struct RangeSensorSpec {
+        int port;
+        double forward; // in, ahead of the tracking center
+        double right; // in, right of the tracking center
+        double angle; // deg it faces, clockwise from straight ahead
+};
+
+/**
+ * Physical description of the simulated robot. The defaults are this robot: 8 blue-cartridge
+ * motors direct to 3.25" omnis, 11" track, two vertical rotation-sensor tracking wheels and an IMU.
+ */
+struct WorldConfig {
+        std::vector<DriveMotorSpec> leftDrive {{8, 1}, {10, -1}, {7, 1}, {6, 1}};
+        std::vector<DriveMotorSpec> rightDrive {{18, -1}, {20, 1}, {17, -1}, {16, -1}};
+        std::vector<TrackerSpec> trackers {{9, 1, 3.25, 5.5}, {19, -1, 3.25, -5.5}};
+        int imuPort = 1;
+        // one ranging forwards off the front bumper, one to the left off the side
+        std::vector<RangeSensorSpec> distanceSensors {{11, 7, 0, 0}, {12, 0, -6, 270}};
+
+        double trackWidth = 11; // in
+        double wheelDiameter = 3.25; // in
+        double massKg = 6.8;
+        double inertiaKgM2 = 0.23;
+        double traction = 0.9; // drive wheel friction coefficient on the foam tiles
+        double lateralTraction = 0.25; // sideways friction through the omni rollers
+        double trackerScrub = 0.03; // tracking wheels roll this much short of the turning part of their motion
+        double robotHalfSize = 9; // in, used for wall contact
+        double robotHalfWidth = 6; // in, the sides from the center, for contact with the barrier
+
+        double batteryVolts = 12.8; // open circuit
+        double batteryResistance = 0.015; // ohm
+        double ambientC = 25;
+        double startTempC = 30;
+
+        double imuDriftDegPerMin = 0.0;
+        double imuNoiseDeg = 0.02;
+        double imuCalibrationMs = 2000;
+
+        std::string sdCard; // host directory standing in for the SD card, empty for no card
+
+        FieldPose start; // where the robot sits before the program sets a pose
+        FieldPose placementError; // added to the first pose the program sets, see World::placed
+        std::uint32_t seed = 1;
+};
+
+/** per-port state of a smart motor, in raw (unreversed) shaft units */
+struct MotorState {
+        enum class Mode { Voltage, Velocity, Brake };
+        Mode mode = Mode::Voltage;
+        double command = 0; // mV in voltage mode, rpm in velocity mode
+        int brakeMode = 0; // pros::motor_brake_mode_e_t
+        double holdPosition = 0;
+        double voltageLimit = 12000; // mV, 0 means none
+        double currentLimit = 2500; // mA
+
+        double angle = 0; // shaft rad
+        double velocity = 0; // shaft rad/s
+        double filteredRpm = 0; // what the motor reports
+        double volts = 0;
+        double amps = 0;
+        double torque = 0; // Nm
+        double temperature = 30; // C
+        double zero = 0; // tare offset, rad
+        bool connected = false;
+};
+
+struct RotationState {
+        double angle = 0; // raw rad
+        double velocity = 0; // raw rad/s
+        double zero = 0;
+        bool connected = false;
+};
+
+struct ImuState {
+        double heading = 0; // deg, unwrapped, including drift and noise
+        double offset = 0;
+        std::uint64_t calibratedAtUs = 0;
+        bool calibrating = false;
+        bool connected = false;
+};
+
+struct DistanceState {
+        int mm = 9999; // what the sensor reports, 9999 with nothing in range
+        int confidence = 0; // 0 - 63
+        bool connected = false;
+};
+
+struct ControllerState {
+        std::array<int, 4> analog {}; // LX, LY, RX, RY
+        std::array<bool, 12> digital {}; // L1 L2 R1 R2 UP DOWN LEFT RIGHT X B Y A
+};
+
+/** one pneumatic output change, for reports and visualisation */
+struct AdiEvent {
+        std::uint64_t timeUs;
+        char port;
+        bool value;
+};
+
+/**
+ * Deterministic differential-drive world
+ *
+ * Each side is modelled as one rolling mass driven by its motors through a traction limited
+ * contact that grips less once it slides, so hard launches spin the wheels the way the real omnis
+ * do. The body carries forward, sideways and yaw velocity; sideways motion is only lightly damped
+ * by the omni rollers, which is where the horizontal drift comes from. Motor current, torque, heating and firmware thermal
+ * throttling follow the V5 smart motor.
+ *
+ * Once the program's first setPose puts the robot down on the field, the long barrier down the
+ * middle of it is there too, for the robot to bump into and the distance sensors to range off
+ * along with the perimeter. Routes that never set a pose drive on an open floor. The goals aren't
+ * modelled: sensors range through them to the perimeter behind.
+ */
+class World {
+    public:
+        explicit World(WorldConfig config = {});
+
+        /** advance one millisecond */
+        void step(std::uint64_t nowUs);
+
+        const WorldConfig& config() const { return cfg; }
+        FieldPose truePose() const;
+        void place(const FieldPose& pose);
+        /** true velocity: forward in/s, sideways in/s, yaw deg/s */
+        std::array<double, 3> trueVelocity() const;
+        double batteryVolts() const { return battery; }
+
+        MotorState& motor(int port);
+        RotationState& rotation(int port);
+        ImuState& imu(int port);
+        DistanceState& distance(int port);
+        ControllerState& controller() { return pad; }
+        bool adi(char port) const;
+        void setAdi(char port, bool value);
+        const std::vector<AdiEvent>& adiEvents() const { return events; }
+
+        std::uint64_t nowUs() const { return now; }
+        std::mt19937& rng() { return random; }
+
+        /** called every 10 ms before the controller is sampled, e.g. to play a driver script */
+        std::function<void(std::uint64_t nowUs, ControllerState&)> driver;
+        /** called once per millisecond after the physics step */
+        std::vector<std::function<void(World&)>> observers;
+
+        /** placement requested by the robot's first setPose, see lemlib::Chassis::setPose */
+        bool placeOnFirstSetPose = true;
+        bool placed = false;
+        /** set by the same setPose, from then on the barrier is on the field */
+        bool onField = false;
+    private:
+        void stepDrive(double dt);
+        double sideForce(const std::vector<DriveMotorSpec>& motors, double wheelSpeed, double dt);
+        void stepThermal(double dt);
+        void stepRanging();
+        /**
+         * inches along a ray from (x, y) in inches on a compass heading in degrees to the nearest wall,
+         * and the cosine of the angle it hits at
+         */
+        double castRay(double x, double y, double heading, double& incidence) const;
+
+        WorldConfig cfg;
+        std::mt19937 random;
+        std::uint64_t now = 0;
+        std::array<MotorState, 22> motors {};
+        std::array<RotationState, 22> rotations {};
+        std::array<ImuState, 22> imus {};
+        std::array<DistanceState, 22> distances {};
+        ControllerState pad;
+        std::array<bool, 8> adiOut {};
+        std::vector<AdiEvent> events;
+
+        // body state, SI units, field frame
+        double x = 0, y = 0, heading = 0; // m, m, rad (compass)
+        double vx = 0, vy = 0, yawRate = 0; // m/s, rad/s (clockwise positive)
+        double leftWheel = 0, rightWheel = 0; // surface speed of each side, m/s
+        double battery = 12.8;
+        double totalAmps = 0;
+        double imuDrift = 0;
+};
+
+/** the world the PROS/LemLib stand-ins talk to; set by the host program before running */
+World& world();
+void setWorld(World* world);
+
+} // namespace sim
@@ -0,0 +1,294 @@
+#include <cmath>
+
+#include "lemlib/api.hpp"
+#include "pros/rtos.hpp"
+#include "sim/world.hpp"
+
+// chassis construction, odometry, motion queueing and driver control
+
+namespace lemlib {
+
+OdomSensors::OdomSensors(TrackingWheel* vertical1, TrackingWheel* vertical2, TrackingWheel* horizontal1,
+                         TrackingWheel* horizontal2, pros::Imu* imu)
+    : vertical1(vertical1),
+      vertical2(vertical2),
+      horizontal1(horizontal1),
+      horizontal2(horizontal2),
+      imu(imu) {}
+
+Drivetrain::Drivetrain(pros::MotorGroup* leftMotors, pros::MotorGroup* rightMotors, float trackWidth,
+                       float wheelDiameter, float rpm, float horizontalDrift)
+    : leftMotors(leftMotors),
+      rightMotors(rightMotors),
+      trackWidth(trackWidth),
+      wheelDiameter(wheelDiameter),
+      rpm(rpm),
+      horizontalDrift(horizontalDrift) {}
+
+// tracking wheels
+
+TrackingWheel::TrackingWheel(pros::Rotation* encoder, float wheelDiameter, float distance, float gearRatio)
+    : diameter(wheelDiameter),
+      distance(distance),
+      rpm(0),
+      rotation(encoder),
+      gearRatio(gearRatio) {}
+
+TrackingWheel::TrackingWheel(pros::MotorGroup* motors, float wheelDiameter, float distance, float rpm)
+    : diameter(wheelDiameter),
+      distance(distance),
+      rpm(rpm),
+      motors(motors) {}
+
+void TrackingWheel::reset() {
+    if (rotation != nullptr) rotation->reset_position();
+    if (motors != nullptr) motors->tare_position();
+}
+
+float TrackingWheel::getDistanceTraveled() {
+    if (rotation != nullptr) return float(rotation->get_position()) * diameter * M_PI / 36000 / gearRatio;
+    // average the motors, scaled from the cartridge speed to the wheel speed
+    const std::vector<double> positions = motors->get_positions();
+    const std::vector<pros::motor_gearset_e_t> gearsets = motors->get_gearing();
+    float total = 0;
+    for (std::size_t i = 0; i < positions.size(); i++) {
+        const float cartridge = gearsets[i] == pros::E_MOTOR_GEARSET_36   ? 100
+                                : gearsets[i] == pros::E_MOTOR_GEARSET_06 ? 600
+                                                                           : 200;
+        total += positions[i] * (diameter * M_PI) * (rpm / cartridge) / 360;
+    }
+    return positions.empty() ? 0 : total / positions.size();
+}
+
+float TrackingWheel::getOffset() { return distance; }
+
+int TrackingWheel::getType() { return motors != nullptr ? 1 : 0; }
+
+// chassis
+
+Chassis::Chassis(Drivetrain drivetrain, ControllerSettings linearSettings, ControllerSettings angularSettings,
+                 OdomSensors sensors, DriveCurve* throttleCurve, DriveCurve* steerCurve)
+    : lateralSettings(linearSettings),
+      angularSettings(angularSettings),
+      drivetrain(drivetrain),
+      sensors(sensors),
+      throttleCurve(throttleCurve),
+      steerCurve(steerCurve),
+      lateralPID(linearSettings.kP, linearSettings.kI, linearSettings.kD, linearSettings.windupRange, true),
+      angularPID(angularSettings.kP, angularSettings.kI, angularSettings.kD, angularSettings.windupRange, true),
+      lateralLargeExit(lateralSettings.largeError, lateralSettings.largeErrorTimeout),
+      lateralSmallExit(lateralSettings.smallError, lateralSettings.smallErrorTimeout),
+      angularLargeExit(angularSettings.largeError, angularSettings.largeErrorTimeout),
+      angularSmallExit(angularSettings.smallError, angularSettings.smallErrorTimeout) {}
+
+void Chassis::setControllerSettings(ControllerSettings linear, ControllerSettings angular) {
+    lateralSettings = linear;
+    angularSettings = angular;
+    lateralPID = PID(linear.kP, linear.kI, linear.kD, linear.windupRange, true);
+    angularPID = PID(angular.kP, angular.kI, angular.kD, angular.windupRange, true);
+    lateralLargeExit = ExitCondition(linear.largeError, linear.largeErrorTimeout);
+    lateralSmallExit = ExitCondition(linear.smallError, linear.smallErrorTimeout);
+    angularLargeExit = ExitCondition(angular.largeError, angular.largeErrorTimeout);
+    angularSmallExit = ExitCondition(angular.smallError, angular.smallErrorTimeout);
+}
+
+void Chassis::calibrate(bool calibrateIMU) {
+    if (calibrateIMU && sensors.imu != nullptr) {
+        // calibrate the imu, retrying like LemLib does if it never finishes
+        for (int attempt = 0; attempt < 5; attempt++) {
+            sensors.imu->reset();
+            while (sensors.imu->is_calibrating()) pros::delay(10);
+            if (!sensors.imu->is_calibrating()) break;
+        }
+    }
+    // without tracking wheels the drive motors are used, offset by half the track
+    if (sensors.vertical1 == nullptr) {
+        sensors.vertical1 = new TrackingWheel(drivetrain.leftMotors, drivetrain.wheelDiameter,
+                                              -(drivetrain.trackWidth / 2), drivetrain.rpm);
+    }
+    if (sensors.vertical2 == nullptr) {
+        sensors.vertical2 = new TrackingWheel(drivetrain.rightMotors, drivetrain.wheelDiameter,
+                                              drivetrain.trackWidth / 2, drivetrain.rpm);
+    }
+    sensors.vertical1->reset();
+    sensors.vertical2->reset();
+    if (sensors.horizontal1 != nullptr) sensors.horizontal1->reset();
+    if (sensors.horizontal2 != nullptr) sensors.horizontal2->reset();
+    odomVertical = sensors.vertical1;
+    odomHorizontal = sensors.horizontal1;
+    prevVertical = odomVertical->getDistanceTraveled();
+    prevHorizontal = odomHorizontal != nullptr ? odomHorizontal->getDistanceTraveled() : 0;
+    prevImu = sensors.imu != nullptr ? degToRad(sensors.imu->get_rotation()) : 0;
+
+    if (!odomStarted) {
+        odomStarted = true;
+        pros::Task odomTask([this]() {
+            while (true) {
+                updateOdom();
+                pros::delay(10);
+            }
+        });
+    }
+}
+
+void Chassis::updateOdom() {
+    const float vertical = odomVertical->getDistanceTraveled();
+    const float horizontal = odomHorizontal != nullptr ? odomHorizontal->getDistanceTraveled() : 0;
+    float heading;
+    if (sensors.imu != nullptr) {
+        heading = degToRad(sensors.imu->get_rotation());
+    } else {
+        // heading from the two vertical wheels
+        const float left = sensors.vertical1->getDistanceTraveled();
+        const float right = sensors.vertical2->getDistanceTraveled();
+        heading = (left - right) / (sensors.vertical2->getOffset() - sensors.vertical1->getOffset());
+    }
+
+    const float deltaVertical = vertical - prevVertical;
+    const float deltaHorizontal = horizontal - prevHorizontal;
+    const float deltaHeading = heading - prevImu;
+    prevVertical = vertical;
+    prevHorizontal = horizontal;
+    prevImu = heading;
+
+    const float avgHeading = odomPose.theta + deltaHeading / 2;
+    const float verticalOffset = odomVertical->getOffset();
+    const float horizontalOffset = odomHorizontal != nullptr ? odomHorizontal->getOffset() : 0;
+
+    // local displacement along the arc the robot travelled
+    float localX = deltaHorizontal;
+    float localY = deltaVertical;
+    if (deltaHeading != 0) {
+        localX = 2 * std::sin(deltaHeading / 2) * (deltaHorizontal / deltaHeading + horizontalOffset);
+        localY = 2 * std::sin(deltaHeading / 2) * (deltaVertical / deltaHeading + verticalOffset);
+    }
+
+    odomPose.x += localY * std::sin(avgHeading) + localX * std::cos(avgHeading);
+    odomPose.y += localY * std::cos(avgHeading) - localX * std::sin(avgHeading);
+    odomPose.theta += deltaHeading;
+}
+
+void Chassis::setPose(float x, float y, float theta, bool radians) {
+    const Pose before = odomPose;
+    odomPose = Pose(x, y, radians ? theta : degToRad(theta));
+    // the first pose a program sets is where the simulated robot was put down. Small changes are
+    // odometry keeping the pose up to date, not the program saying where the robot is
+    sim::World& world = sim::world();
+    const bool moved = std::hypot(odomPose.x - before.x, odomPose.y - before.y) > 0.5 ||
+                       std::fabs(angleError(odomPose.theta, before.theta)) > degToRad(1);
+    if (world.placeOnFirstSetPose && !world.placed && moved) {
+        world.placed = true;
+        world.onField = true;
+        const sim::FieldPose error = world.config().placementError;
+        world.place({x + error.x, y + error.y, (radians ? radToDeg(theta) : theta) + error.theta});
+    }
+}
+
+void Chassis::setPose(Pose pose, bool radians) { setPose(pose.x, pose.y, pose.theta, radians); }
+
+Pose Chassis::getPose(bool radians, bool standardPos) {
+    Pose pose = odomPose;
+    if (standardPos) pose.theta = M_PI_2 - pose.theta;
+    if (!radians) pose.theta = radToDeg(pose.theta);
+    return pose;
+}
+
+void Chassis::setBrakeMode(pros::motor_brake_mode_e_t mode) {
+    drivetrain.leftMotors->set_brake_modes(mode);
+    drivetrain.rightMotors->set_brake_modes(mode);
+}
+
+// motion queue
+
+void Chassis::requestMotionStart() {
+    sim::world().placed = true;
+    if (isInMotion()) motionQueued = true; // indicate a motion is queued
+    else motionRunning = true; // indicate a motion is running
+    // wait until this motion is at the front of the queue
+    mutex.take();
+}
+
+void Chassis::endMotion() {
+    // move the queue forward by one and let the next motion run
+    motionRunning = motionQueued;
+    motionQueued = false;
+    mutex.give();
+}
+
+bool Chassis::isInMotion() const { return motionRunning; }
+
+void Chassis::waitUntil(float dist) {
+    // give the motion a chance to start
+    do pros::delay(10);
+    while (distTraveled <= dist && distTraveled != -1);
+}
+
+void Chassis::waitUntilDone() {
+    do pros::delay(10);
+    while (distTraveled != -1);
+}
+
+void Chassis::cancelMotion() {
+    motionRunning = false;
+    pros::delay(10);
+}
+
+void Chassis::cancelAllMotions() {
+    motionRunning = false;
+    motionQueued = false;
+    pros::delay(10);
+}
+
+// driver control
+
+void Chassis::tank(int left, int right, bool disableDriveCurve) {
+    sim::world().placed = true;
+    if (!disableDriveCurve) {
+        left = throttleCurve->curve(left);
+        right = throttleCurve->curve(right);
+    }
+    drivetrain.leftMotors->move(left);
+    drivetrain.rightMotors->move(right);
+}
+
+void Chassis::arcade(int throttle, int turn, bool disableDriveCurve, float desaturateBias) {
+    sim::world().placed = true;
+    if (!disableDriveCurve) {
+        throttle = throttleCurve->curve(throttle);
+        turn = steerCurve->curve(turn);
+    }
+    // desaturate motors based on the bias between throttle and turn
+    if (std::abs(throttle) + std::abs(turn) > 127) {
+        const int oldThrottle = throttle;
+        const int oldTurn = turn;
+        throttle *= (1 - desaturateBias * std::abs(oldTurn / 127.0));
+        turn *= (1 - (1 - desaturateBias) * std::abs(oldThrottle / 127.0));
+    }
+    drivetrain.leftMotors->move(throttle + turn);
+    drivetrain.rightMotors->move(throttle - turn);
+}
+
+void Chassis::curvature(int throttle, int turn, bool disableDriveCurve) {
+    sim::world().placed = true;
+    if (!disableDriveCurve) {
+        throttle = throttleCurve->curve(throttle);
+        turn = steerCurve->curve(turn);
+    }
+    // turn in place when there is no throttle
+    if (throttle == 0) {
+        drivetrain.leftMotors->move(turn);
+        drivetrain.rightMotors->move(-turn);
+        return;
+    }
+    float leftPower = throttle + (std::abs(throttle) * turn) / 127.0;
+    float rightPower = throttle - (std::abs(throttle) * turn) / 127.0;
+    const float ratio = std::max(std::fabs(leftPower), std::fabs(rightPower)) / 127;
+    if (ratio > 1) {
+        leftPower /= ratio;
+        rightPower /= ratio;
+    }
+    drivetrain.leftMotors->move(leftPower);
+    drivetrain.rightMotors->move(rightPower);
+}
+
+} // namespace lemlib
@@ -0,0 +1,466 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "lemlib/api.hpp"
+#include "pros/rtos.hpp"
+
+// the LemLib 0.5 motion algorithms, run every 10 ms against the simulated drivetrain
+
+namespace lemlib {
+
+void Chassis::turnToHeading(float theta, int timeout, TurnToHeadingParams params, bool async) {
+    requestMotionStart();
+    // were all motions cancelled?
+    if (!motionRunning) return;
+    // if the function is async, run it in a new task
+    if (async) {
+        pros::Task task([=, this]() { turnToHeading(theta, timeout, params, false); });
+        endMotion();
+        pros::delay(10);
+        return;
+    }
+    float prevMotorPower = 0;
+    const float startTheta = getPose().theta;
+    bool settling = false;
+    std::optional<float> prevRawDeltaTheta;
+    std::optional<float> prevDeltaTheta;
+    angularLargeExit.reset();
+    angularSmallExit.reset();
+    angularPID.reset();
+    distTraveled = 0;
+    Timer timer(timeout);
+
+    while (!timer.isDone() && !angularLargeExit.getExit() && !angularSmallExit.getExit() && motionRunning) {
+        const Pose pose = getPose();
+        distTraveled = std::fabs(angleError(pose.theta, startTheta, false));
+
+        // once the robot crosses the target it settles the short way, whatever the direction asked for
+        const float rawDeltaTheta = angleError(theta, pose.theta, false);
+        if (!prevRawDeltaTheta) prevRawDeltaTheta = rawDeltaTheta;
+        if (sgn(rawDeltaTheta) != sgn(*prevRawDeltaTheta)) settling = true;
+        prevRawDeltaTheta = rawDeltaTheta;
+        const float deltaTheta = settling ? rawDeltaTheta : angleError(theta, pose.theta, false, params.direction);
+        if (!prevDeltaTheta) prevDeltaTheta = deltaTheta;
+
+        // motion chaining
+        if (params.minSpeed != 0 && std::fabs(deltaTheta) < params.earlyExitRange) break;
+        if (params.minSpeed != 0 && sgn(deltaTheta) != sgn(*prevDeltaTheta)) break;
+        prevDeltaTheta = deltaTheta;
+
+        float motorPower = angularPID.update(deltaTheta);
+        angularLargeExit.update(deltaTheta);
+        angularSmallExit.update(deltaTheta);
+
+        motorPower = std::clamp(motorPower, float(-params.maxSpeed), float(params.maxSpeed));
+        motorPower = slew(motorPower, prevMotorPower, angularSettings.slew);
+        if (motorPower < 0 && motorPower > -params.minSpeed) motorPower = -params.minSpeed;
+        else if (motorPower > 0 && motorPower < params.minSpeed) motorPower = params.minSpeed;
+        prevMotorPower = motorPower;
+
+        drivetrain.leftMotors->move(motorPower);
+        drivetrain.rightMotors->move(-motorPower);
+        pros::delay(10);
+    }
+
+    drivetrain.leftMotors->move(0);
+    drivetrain.rightMotors->move(0);
+    distTraveled = -1;
+    endMotion();
+}
+
+void Chassis::turnToPoint(float x, float y, int timeout, TurnToPointParams params, bool async) {
+    requestMotionStart();
+    if (!motionRunning) return;
+    if (async) {
+        pros::Task task([=, this]() { turnToPoint(x, y, timeout, params, false); });
+        endMotion();
+        pros::delay(10);
+        return;
+    }
+    float prevMotorPower = 0;
+    const float startTheta = getPose().theta;
+    bool settling = false;
+    std::optional<float> prevRawDeltaTheta;
+    std::optional<float> prevDeltaTheta;
+    angularLargeExit.reset();
+    angularSmallExit.reset();
+    angularPID.reset();
+    distTraveled = 0;
+    Timer timer(timeout);
+
+    while (!timer.isDone() && !angularLargeExit.getExit() && !angularSmallExit.getExit() && motionRunning) {
+        const Pose pose = getPose();
+        distTraveled = std::fabs(angleError(pose.theta, startTheta, false));
+
+        // compass heading that points at the target
+        float targetTheta = radToDeg(std::atan2(x - pose.x, y - pose.y));
+        if (!params.forwards) targetTheta += 180;
+
+        const float rawDeltaTheta = angleError(targetTheta, pose.theta, false);
+        if (!prevRawDeltaTheta) prevRawDeltaTheta = rawDeltaTheta;
+        if (sgn(rawDeltaTheta) != sgn(*prevRawDeltaTheta)) settling = true;
+        prevRawDeltaTheta = rawDeltaTheta;
+        const float deltaTheta =
+            settling ? rawDeltaTheta : angleError(targetTheta, pose.theta, false, params.direction);
+        if (!prevDeltaTheta) prevDeltaTheta = deltaTheta;
+
+        if (params.minSpeed != 0 && std::fabs(deltaTheta) < params.earlyExitRange) break;
+        if (params.minSpeed != 0 && sgn(deltaTheta) != sgn(*prevDeltaTheta)) break;
+        prevDeltaTheta = deltaTheta;
+
+        float motorPower = angularPID.update(deltaTheta);
+        angularLargeExit.update(deltaTheta);
+        angularSmallExit.update(deltaTheta);
+
+        motorPower = std::clamp(motorPower, float(-params.maxSpeed), float(params.maxSpeed));
+        motorPower = slew(motorPower, prevMotorPower, angularSettings.slew);
+        if (motorPower < 0 && motorPower > -params.minSpeed) motorPower = -params.minSpeed;
+        else if (motorPower > 0 && motorPower < params.minSpeed) motorPower = params.minSpeed;
+        prevMotorPower = motorPower;
+
+        drivetrain.leftMotors->move(motorPower);
+        drivetrain.rightMotors->move(-motorPower);
+        pros::delay(10);
+    }
+
+    drivetrain.leftMotors->move(0);
+    drivetrain.rightMotors->move(0);
+    distTraveled = -1;
+    endMotion();
+}
+
+void Chassis::moveToPose(float x, float y, float theta, int timeout, MoveToPoseParams params, bool async) {
+    requestMotionStart();
+    if (!motionRunning) return;
+    if (async) {
+        pros::Task task([=, this]() { moveToPose(x, y, theta, timeout, params, false); });
+        endMotion();
+        pros::delay(10);
+        return;
+    }
+
+    lateralPID.reset();
+    lateralLargeExit.reset();
+    lateralSmallExit.reset();
+    angularPID.reset();
+    angularLargeExit.reset();
+    angularSmallExit.reset();
+
+    // target pose in standard form
+    Pose target(x, y, M_PI_2 - degToRad(theta));
+    if (!params.forwards) target.theta = std::fmod(target.theta + M_PI, 2 * M_PI);
+    if (params.horizontalDrift == 0) params.horizontalDrift = drivetrain.horizontalDrift;
+
+    bool close = false;
+    bool lateralSettled = false;
+    bool prevSameSide = false;
+    float prevLateralOut = 0;
+    Pose lastPose = getPose();
+    distTraveled = 0;
+    Timer timer(timeout);
+
+    while (!timer.isDone() &&
+           ((!lateralSettled || (!angularLargeExit.getExit() && !angularSmallExit.getExit())) || !close) &&
+           motionRunning) {
+        const Pose pose = getPose(true, true);
+        distTraveled += pose.distance(lastPose);
+        lastPose = pose;
+
+        // within 7.5 inches the robot stops chasing the carrot and settles on the target
+        if (pose.distance(target) < 7.5 && !close) {
+            close = true;
+            params.maxSpeed = std::fmax(std::fabs(prevLateralOut), 60);
+        }
+        if (lateralLargeExit.getExit() || lateralSmallExit.getExit()) lateralSettled = true;
+
+        // boomerang carrot point
+        Pose carrot = target - Pose(std::cos(target.theta), std::sin(target.theta)) * params.lead * pose.distance(target);
+        if (close) carrot = target;
+
+        // motion chaining: exit once the robot crosses the line through the target
+        const bool robotSide = (pose.y - target.y) * -std::sin(target.theta) <=
+                               (pose.x - target.x) * std::cos(target.theta) + params.earlyExitRange;
+        const bool carrotSide = (carrot.y - target.y) * -std::sin(target.theta) <=
+                                (carrot.x - target.x) * std::cos(target.theta) + params.earlyExitRange;
+        const bool sameSide = robotSide == carrotSide;
+        if (!sameSide && prevSameSide && close && params.minSpeed != 0) break;
+        prevSameSide = sameSide;
+
+        const float adjustedRobotTheta = params.forwards ? pose.theta : pose.theta + M_PI;
+        const float angularError =
+            close ? angleError(adjustedRobotTheta, target.theta) : angleError(adjustedRobotTheta, pose.angle(carrot));
+        float lateralError = pose.distance(carrot);
+        if (close) lateralError *= std::cos(angleError(pose.theta, pose.angle(carrot)));
+        else lateralError *= sgn(std::cos(angleError(pose.theta, pose.angle(carrot))));
+
+        lateralSmallExit.update(lateralError);
+        lateralLargeExit.update(lateralError);
+        angularSmallExit.update(radToDeg(angularError));
+        angularLargeExit.update(radToDeg(angularError));
+
+        float lateralOut = lateralPID.update(lateralError);
+        float angularOut = angularPID.update(radToDeg(angularError));
+        lateralOut = std::clamp(lateralOut, -params.maxSpeed, params.maxSpeed);
+        angularOut = std::clamp(angularOut, -params.maxSpeed, params.maxSpeed);
+        if (!close) lateralOut = slew(lateralOut, prevLateralOut, lateralSettings.slew);
+
+        // limit speed around the curve so the robot does not slide
+        const float radius = 1 / std::fabs(getCurvature(pose, carrot));
+        const float maxSlipSpeed = std::sqrt(params.horizontalDrift * radius * 9.8);
+        lateralOut = std::clamp(lateralOut, -maxSlipSpeed, maxSlipSpeed);
+        // prioritize angular movement over lateral movement
+        const float overturn = std::fabs(angularOut) + std::fabs(lateralOut) - params.maxSpeed;
+        if (overturn > 0) lateralOut -= lateralOut > 0 ? overturn : -overturn;
+
+        // prevent moving in the wrong direction
+        if (params.forwards && !close) lateralOut = std::fmax(lateralOut, 0);
+        else if (!params.forwards && !close) lateralOut = std::fmin(lateralOut, 0);
+
+        // constrain lateral output by the minimum speed
+        if (params.forwards && lateralOut < std::fabs(params.minSpeed) && lateralOut > 0)
+            lateralOut = std::fabs(params.minSpeed);
+        if (!params.forwards && -lateralOut < std::fabs(params.minSpeed) && lateralOut < 0)
+            lateralOut = -std::fabs(params.minSpeed);
+
+        prevLateralOut = lateralOut;
+
+        float leftPower = lateralOut + angularOut;
+        float rightPower = lateralOut - angularOut;
+        const float ratio = std::max(std::fabs(leftPower), std::fabs(rightPower)) / params.maxSpeed;
+        if (ratio > 1) {
+            leftPower /= ratio;
+            rightPower /= ratio;
+        }
+        drivetrain.leftMotors->move(leftPower);
+        drivetrain.rightMotors->move(rightPower);
+        pros::delay(10);
+    }
+
+    drivetrain.leftMotors->move(0);
+    drivetrain.rightMotors->move(0);
+    distTraveled = -1;
+    endMotion();
+}
+
+void Chassis::moveToPoint(float x, float y, int timeout, MoveToPointParams params, bool async) {
+    requestMotionStart();
+    if (!motionRunning) return;
+    if (async) {
+        pros::Task task([=, this]() { moveToPoint(x, y, timeout, params, false); });
+        endMotion();
+        pros::delay(10);
+        return;
+    }
+
+    lateralPID.reset();
+    lateralLargeExit.reset();
+    lateralSmallExit.reset();
+    angularPID.reset();
+
+    bool close = false;
+    float prevLateralOut = 0;
+    std::optional<bool> prevSide;
+    Pose lastPose = getPose();
+    distTraveled = 0;
+    Pose target(x, y);
+    target.theta = getPose(true, true).angle(target);
+    Timer timer(timeout);
+
+    while (!timer.isDone() && ((!lateralSmallExit.getExit() && !lateralLargeExit.getExit()) || !close) &&
+           motionRunning) {
+        const Pose pose = getPose(true, true);
+        distTraveled += pose.distance(lastPose);
+        lastPose = pose;
+
+        if (pose.distance(target) < 7.5 && !close) {
+            close = true;
+            params.maxSpeed = std::fmax(std::fabs(prevLateralOut), 60);
+        }
+
+        // motion chaining
+        const bool side = (pose.y - target.y) * -std::sin(target.theta) <=
+                          (pose.x - target.x) * std::cos(target.theta) + params.earlyExitRange;
+        if (!prevSide) prevSide = side;
+        if (side != *prevSide && params.minSpeed != 0) break;
+        prevSide = side;
+
+        const float adjustedRobotTheta = params.forwards ? pose.theta : pose.theta + M_PI;
+        const float angularError = angleError(adjustedRobotTheta, pose.angle(target));
+        const float lateralError = pose.distance(target) * std::cos(angleError(pose.theta, pose.angle(target)));
+
+        lateralSmallExit.update(lateralError);
+        lateralLargeExit.update(lateralError);
+
+        float lateralOut = lateralPID.update(lateralError);
+        float angularOut = close ? 0 : angularPID.update(radToDeg(angularError));
+        lateralOut = std::clamp(lateralOut, -params.maxSpeed, params.maxSpeed);
+        angularOut = std::clamp(angularOut, -params.maxSpeed, params.maxSpeed);
+        if (!close) lateralOut = slew(lateralOut, prevLateralOut, lateralSettings.slew);
+
+        if (params.forwards && !close) lateralOut = std::fmax(lateralOut, 0);
+        else if (!params.forwards && !close) lateralOut = std::fmin(lateralOut, 0);
+        if (params.forwards && lateralOut < std::fabs(params.minSpeed) && lateralOut > 0)
+            lateralOut = std::fabs(params.minSpeed);
+        if (!params.forwards && -lateralOut < std::fabs(params.minSpeed) && lateralOut < 0)
+            lateralOut = -std::fabs(params.minSpeed);
+
+        const float overturn = std::fabs(angularOut) + std::fabs(lateralOut) - params.maxSpeed;
+        if (overturn > 0) lateralOut -= lateralOut > 0 ? overturn : -overturn;
+        prevLateralOut = lateralOut;
+
+        float leftPower = lateralOut + angularOut;
+        float rightPower = lateralOut - angularOut;
+        const float ratio = std::max(std::fabs(leftPower), std::fabs(rightPower)) / params.maxSpeed;
+        if (ratio > 1) {
+            leftPower /= ratio;
+            rightPower /= ratio;
+        }
+        drivetrain.leftMotors->move(leftPower);
+        drivetrain.rightMotors->move(rightPower);
+        pros::delay(10);
+    }
+
+    drivetrain.leftMotors->move(0);
+    drivetrain.rightMotors->move(0);
+    distTraveled = -1;
+    endMotion();
+}
+
+namespace {
+
+/** parse a path.jerryio text asset: "x, y, speed" lines up to "endData" */
+std::vector<Pose> getData(const asset& path) {
+    std::vector<Pose> points;
+    std::istringstream in(std::string(reinterpret_cast<const char*>(path.buf), path.size));
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.rfind("endData", 0) == 0) break;
+        float x, y, speed;
+        if (std::sscanf(line.c_str(), "%f, %f, %f", &x, &y, &speed) == 3) points.emplace_back(x, y, speed);
+    }
+    return points;
+}
+
+int findClosest(Pose pose, const std::vector<Pose>& path) {
+    int closest = 0;
+    float closestDist = std::numeric_limits<float>::infinity();
+    for (int i = 0; i < int(path.size()); i++) {
+        const float dist = pose.distance(path[i]);
+        if (dist < closestDist) {
+            closestDist = dist;
+            closest = i;
+        }
+    }
+    return closest;
+}
+
+/** intersection parameter of the lookahead circle with segment p1-p2, or -1 */
+float circleIntersect(Pose p1, Pose p2, Pose pose, float lookaheadDist) {
+    const Pose d = p2 - p1;
+    const Pose f = p1 - pose;
+    const float a = d * d;
+    const float b = 2 * (f * d);
+    const float c = (f * f) - lookaheadDist * lookaheadDist;
+    float discriminant = b * b - 4 * a * c;
+    if (discriminant < 0 || a == 0) return -1;
+    discriminant = std::sqrt(discriminant);
+    const float t1 = (-b - discriminant) / (2 * a);
+    const float t2 = (-b + discriminant) / (2 * a);
+    if (t2 >= 0 && t2 <= 1) return t2;
+    if (t1 >= 0 && t1 <= 1) return t1;
+    return -1;
+}
+
+/** lookahead point, searched forwards from the closest point; theta carries the path index */
+Pose lookaheadPoint(Pose lastLookahead, Pose pose, const std::vector<Pose>& path, int closest, float lookaheadDist) {
+    const int start = std::max(closest, int(lastLookahead.theta));
+    for (int i = start; i < int(path.size()) - 1; i++) {
+        const float t = circleIntersect(path[i], path[i + 1], pose, lookaheadDist);
+        if (t != -1) {
+            Pose lookahead = path[i].lerp(path[i + 1], t);
+            lookahead.theta = i;
+            return lookahead;
+        }
+    }
+    return lastLookahead;
+}
+
+/** signed curvature to the lookahead point, positive when it is to the right (compass heading) */
+float lookaheadCurvature(Pose pose, Pose lookahead) {
+    const float dx = lookahead.x - pose.x;
+    const float dy = lookahead.y - pose.y;
+    const float right = dx * std::cos(pose.theta) - dy * std::sin(pose.theta);
+    const float dist2 = dx * dx + dy * dy;
+    return dist2 == 0 ? 0 : 2 * right / dist2;
+}
+
+} // namespace
+
+void Chassis::follow(const asset& path, float lookahead, int timeout, bool forwards, bool async) {
+    requestMotionStart();
+    if (!motionRunning) return;
+    if (async) {
+        pros::Task task([=, this]() { follow(path, lookahead, timeout, forwards, false); });
+        endMotion();
+        pros::delay(10);
+        return;
+    }
+
+    const std::vector<Pose> pathPoints = getData(path);
+    if (pathPoints.empty()) {
+        distTraveled = -1;
+        endMotion();
+        return;
+    }
+    Pose lastPose = getPose();
+    Pose lastLookahead = pathPoints.at(0);
+    lastLookahead.theta = 0;
+    distTraveled = 0;
+    Timer timer(timeout);
+
+    while (!timer.isDone() && motionRunning) {
+        Pose pose = getPose(true);
+        if (!forwards) pose.theta += M_PI;
+        distTraveled += pose.distance(lastPose);
+        lastPose = pose;
+
+        const int closest = findClosest(pose, pathPoints);
+        // the last point of a path has a speed of 0
+        if (pathPoints.at(closest).theta == 0) break;
+
+        const Pose lookaheadPose = lookaheadPoint(lastLookahead, pose, pathPoints, closest, lookahead);
+        lastLookahead = lookaheadPose;
+        const float curvature = lookaheadCurvature(pose, lookaheadPose);
+
+        const float targetVel = pathPoints.at(closest).theta;
+        float targetLeftVel = targetVel * (2 + curvature * drivetrain.trackWidth) / 2;
+        float targetRightVel = targetVel * (2 - curvature * drivetrain.trackWidth) / 2;
+        const float ratio = std::max(std::fabs(targetLeftVel), std::fabs(targetRightVel)) / 127;
+        if (ratio > 1) {
+            targetLeftVel /= ratio;
+            targetRightVel /= ratio;
+        }
+
+        if (forwards) {
+            drivetrain.leftMotors->move(targetLeftVel);
+            drivetrain.rightMotors->move(targetRightVel);
+        } else {
+            drivetrain.leftMotors->move(-targetRightVel);
+            drivetrain.rightMotors->move(-targetLeftVel);
+        }
+        pros::delay(10);
+    }
+
+    drivetrain.leftMotors->move(0);
+    drivetrain.rightMotors->move(0);
+    distTraveled = -1;
+    endMotion();
+}
+
+} // namespace lemlib
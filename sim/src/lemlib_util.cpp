@@ -0,0 +1,212 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "lemlib/api.hpp"
+
+// the small LemLib building blocks: pose math, PID, exit conditions, timers, drive curves,
+// the telemetry sink and static assets
+
+namespace lemlib {
+
+// pose
+
+Pose::Pose(float x, float y, float theta)
+    : x(x),
+      y(y),
+      theta(theta) {}
+
+Pose Pose::operator+(const Pose& other) const { return Pose(x + other.x, y + other.y, theta); }
+
+Pose Pose::operator-(const Pose& other) const { return Pose(x - other.x, y - other.y, theta); }
+
+float Pose::operator*(const Pose& other) const { return x * other.x + y * other.y; }
+
+Pose Pose::operator*(const float& other) const { return Pose(x * other, y * other, theta); }
+
+Pose Pose::operator/(const float& other) const { return Pose(x / other, y / other, theta); }
+
+Pose Pose::lerp(Pose other, float t) const { return Pose(x + (other.x - x) * t, y + (other.y - y) * t, theta); }
+
+float Pose::distance(Pose other) const { return std::hypot(x - other.x, y - other.y); }
+
+float Pose::angle(Pose other) const { return std::atan2(other.y - y, other.x - x); }
+
+Pose Pose::rotate(float angle) const {
+    return Pose(x * std::cos(angle) - y * std::sin(angle), x * std::sin(angle) + y * std::cos(angle), theta);
+}
+
+std::ostream& operator<<(std::ostream& os, const Pose& pose) {
+    char buffer[96];
+    std::snprintf(buffer, sizeof(buffer), "lemlib::Pose { x: %f, y: %f, theta: %f }", pose.x, pose.y, pose.theta);
+    return os << buffer;
+}
+
+// util
+
+float slew(float target, float current, float maxChange) {
+    const float change = target - current;
+    if (maxChange == 0) return target;
+    if (change > maxChange) return current + maxChange;
+    if (change < -maxChange) return current - maxChange;
+    return target;
+}
+
+float radToDeg(float rad) { return rad * 180 / M_PI; }
+
+float degToRad(float deg) { return deg * M_PI / 180; }
+
+float sanitizeAngle(float angle, bool radians) {
+    const float full = radians ? 2 * M_PI : 360;
+    return std::fmod(std::fmod(angle, full) + full, full);
+}
+
+float angleError(float angle1, float angle2, bool radians, AngularDirection direction) {
+    const float full = radians ? 2 * M_PI : 360;
+    const float error = sanitizeAngle(angle1, radians) - sanitizeAngle(angle2, radians);
+    switch (direction) {
+        case AngularDirection::CW_CLOCKWISE: return error < 0 ? error + full : error;
+        case AngularDirection::CCW_COUNTERCLOCKWISE: return error > 0 ? error - full : error;
+        default: return std::remainder(error, full);
+    }
+}
+
+float ema(float current, float previous, float smooth) { return current * smooth + previous * (1 - smooth); }
+
+float getCurvature(Pose pose, Pose other) {
+    // which side of the robot the point is on
+    const float side = sgn(std::sin(pose.theta) * (other.x - pose.x) - std::cos(pose.theta) * (other.y - pose.y));
+    const float a = -std::tan(pose.theta);
+    const float c = std::tan(pose.theta) * pose.x - pose.y;
+    const float x = std::fabs(a * other.x + other.y + c) / std::sqrt((a * a) + 1);
+    const float d = std::hypot(other.x - pose.x, other.y - pose.y);
+    return side * ((2 * x) / (d * d));
+}
+
+// pid
+
+PID::PID(float kP, float kI, float kD, float windupRange, bool signFlipReset)
+    : kP(kP),
+      kI(kI),
+      kD(kD),
+      windupRange(windupRange),
+      signFlipReset(signFlipReset) {}
+
+float PID::update(const float error) {
+    integral += error;
+    if (sgn(error) != sgn(prevError) && signFlipReset) integral = 0;
+    if (std::fabs(error) > windupRange && windupRange != 0) integral = 0;
+    const float derivative = error - prevError;
+    prevError = error;
+    return error * kP + integral * kI + derivative * kD;
+}
+
+void PID::reset() {
+    integral = 0;
+    prevError = 0;
+}
+
+void PID::setGains(float kP, float kI, float kD) {
+    this->kP = kP;
+    this->kI = kI;
+    this->kD = kD;
+}
+
+// exit conditions
+
+ExitCondition::ExitCondition(const float range, const int time)
+    : range(range),
+      time(time) {}
+
+bool ExitCondition::getExit() { return done; }
+
+bool ExitCondition::update(const float input) {
+    const int now = pros::millis();
+    if (std::fabs(input) > range) startTime = -1;
+    else if (startTime == -1) startTime = now;
+    else if (now >= startTime + time) done = true;
+    return done;
+}
+
+void ExitCondition::reset() {
+    startTime = -1;
+    done = false;
+}
+
+// timer
+
+Timer::Timer(std::uint32_t time)
+    : period(time),
+      start(pros::millis()) {}
+
+std::uint32_t Timer::getTimeLeft() {
+    const std::uint32_t passed = getTimePassed();
+    return passed >= period ? 0 : period - passed;
+}
+
+std::uint32_t Timer::getTimePassed() { return pros::millis() - start; }
+
+bool Timer::isDone() { return getTimePassed() >= period; }
+
+void Timer::reset() { start = pros::millis(); }
+
+// drive curves
+
+ExpoDriveCurve::ExpoDriveCurve(float deadband, float minOutput, float curve)
+    : deadband(deadband),
+      minOutput(minOutput),
+      curveGain(curve) {}
+
+float ExpoDriveCurve::curve(float input) {
+    // return 0 if input is within deadzone
+    if (std::fabs(input) <= deadband) return 0;
+    // g is the output of g(x) as defined in the Desmos graph
+    const float g = std::fabs(input) - deadband;
+    // g127 is the output of g(127) as defined in the Desmos graph
+    const float g127 = 127 - deadband;
+    // i is the output of i(x) as defined in the Desmos graph
+    const float i = std::pow(curveGain, g - 127) * g * sgn(input);
+    // i127 is the output of i(127) as defined in the Desmos graph
+    const float i127 = std::pow(curveGain, g127 - 127) * g127;
+    return (127.0 - minOutput) / (127) * i * 127 / i127 + minOutput * sgn(input);
+}
+
+ExpoDriveCurve defaultDriveCurve(0, 0, 1);
+
+// telemetry
+
+void TelemetrySink::write(const std::string& message) {
+    messages++;
+    std::cout << message << '\n';
+}
+
+std::shared_ptr<TelemetrySink> telemetrySink() {
+    static auto sink = std::make_shared<TelemetrySink>();
+    return sink;
+}
+
+std::shared_ptr<TelemetrySink> infoSink() { return telemetrySink(); }
+
+// assets
+
+asset loadStaticAsset(const char* name) {
+    std::string file = name;
+    const std::size_t dot = file.rfind('_');
+    if (dot != std::string::npos) file[dot] = '.';
+    const char* dir = std::getenv("SPF_STATIC_DIR");
+    const std::string path = std::string(dir != nullptr ? dir : SPF_STATIC_DIR) + "/" + file;
+
+    // assets live for the whole program, like the linker-embedded originals
+    auto* bytes = new std::vector<std::uint8_t>();
+    std::ifstream in(path, std::ios::binary);
+    if (in) bytes->assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    bytes->push_back(0); // keep text assets terminated without counting it in the size
+    return {bytes->data(), bytes->size() - 1};
+}
+
+} // namespace lemlib
@@ -0,0 +1,111 @@
+#include "display/lvgl.h"
+
+#include <cstdio>
+#include <deque>
+
+// LVGL stand-in: objects are kept in a deque so pointers stay valid for the whole run
+
+namespace {
+std::deque<lv_obj_t> objects;
+lv_obj_t screen;
+std::uint64_t calls = 0;
+std::uint64_t pixels = 0;
+
+lv_obj_t* create(lv_obj_t* parent) {
+    calls++;
+    objects.emplace_back();
+    objects.back().parent = parent;
+    return &objects.back();
+}
+} // namespace
+
+lv_style_t lv_style_plain {};
+lv_style_t lv_style_plain_color {};
+lv_style_t lv_style_pretty {};
+
+// the logo images are built from PNGs in the robot project; the host only needs the symbols
+extern const lv_img_dsc_t spflogo {};
+extern const lv_img_dsc_t spflogoBW {};
+
+lv_obj_t* lv_scr_act() { return &screen; }
+
+lv_obj_t* lv_obj_create(lv_obj_t* parent, const lv_obj_t*) { return create(parent); }
+
+void lv_obj_align(lv_obj_t*, const lv_obj_t*, lv_align_t, lv_coord_t, lv_coord_t) { calls++; }
+
+void lv_obj_set_hidden(lv_obj_t* obj, bool en) {
+    calls++;
+    obj->hidden = en;
+}
+
+void lv_obj_set_size(lv_obj_t* obj, lv_coord_t w, lv_coord_t h) {
+    calls++;
+    obj->width = w;
+    obj->height = h;
+}
+
+void lv_obj_set_pos(lv_obj_t*, lv_coord_t, lv_coord_t) { calls++; }
+
+void lv_obj_set_free_num(lv_obj_t* obj, std::uint32_t free_num) { obj->freeNum = free_num; }
+
+std::uint32_t lv_obj_get_free_num(const lv_obj_t* obj) { return obj->freeNum; }
+
+void lv_obj_set_style(lv_obj_t*, lv_style_t*) { calls++; }
+
+void lv_obj_invalidate(const lv_obj_t*) { calls++; }
+
+void lv_style_copy(lv_style_t* dest, const lv_style_t* src) { *dest = *src; }
+
+lv_obj_t* lv_img_create(lv_obj_t* par, const lv_obj_t*) { return create(par); }
+
+void lv_img_set_src(lv_obj_t*, const void*) { calls++; }
+
+lv_obj_t* lv_btn_create(lv_obj_t* par, const lv_obj_t*) { return create(par); }
+
+void lv_btn_set_action(lv_obj_t* btn, lv_btn_action_t, lv_action_t action) { btn->action = action; }
+
+void lv_btn_set_style(lv_obj_t*, lv_btn_style_t, lv_style_t*) { calls++; }
+
+lv_obj_t* lv_label_create(lv_obj_t* par, const lv_obj_t*) { return create(par); }
+
+void lv_label_set_text(lv_obj_t* label, const char* text) {
+    calls++;
+    label->text = text;
+}
+
+const char* lv_label_get_text(const lv_obj_t* label) { return label->text.c_str(); }
+
+void lv_label_set_style(lv_obj_t*, lv_style_t*) { calls++; }
+
+lv_obj_t* lv_canvas_create(lv_obj_t* par, const lv_obj_t*) { return create(par); }
+
+void lv_canvas_set_buffer(lv_obj_t* canvas, void* buf, lv_coord_t w, lv_coord_t h, lv_img_cf_t) {
+    calls++;
+    canvas->buffer = static_cast<const lv_color_t*>(buf);
+    canvas->width = w;
+    canvas->height = h;
+    pixels += std::uint64_t(w) * h;
+}
+
+void lv_inv_area(const lv_area_t* area_p) {
+    calls++;
+    if (area_p->x2 >= area_p->x1 && area_p->y2 >= area_p->y1) {
+        pixels += std::uint64_t(area_p->x2 - area_p->x1 + 1) * (area_p->y2 - area_p->y1 + 1);
+    }
+}
+
+std::uint64_t sim::lvglCalls() { return calls; }
+
+std::uint64_t sim::lvglPixels() { return pixels; }
+
+bool sim::writeCanvas(const lv_obj_t* canvas, const char* name) {
+    if (canvas == nullptr || canvas->buffer == nullptr) return false;
+    std::FILE* file = std::fopen(name, "wb");
+    if (file == nullptr) return false;
+    std::fprintf(file, "P6\n%d %d\n255\n", canvas->width, canvas->height);
+    for (int i = 0; i < canvas->width * canvas->height; i++) {
+        const std::uint8_t pixel[3] = {canvas->buffer[i].red, canvas->buffer[i].green, canvas->buffer[i].blue};
+        std::fwrite(pixel, 1, sizeof(pixel), file);
+    }
+    return std::fclose(file) == 0;
+}
@@ -0,0 +1,428 @@
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "pros/adi.hpp"
+#include "pros/distance.hpp"
+#include "pros/imu.hpp"
+#include "pros/misc.hpp"
+#include "pros/motors.hpp"
+#include "pros/rotation.hpp"
+#include "pros/rtos.hpp"
+#include "sim/world.hpp"
+
+// PROS device classes on top of sim::World. Objects only remember their port and configuration,
+// so they can be constructed as globals before the host program creates the world. Every motor is
+// simulated at its output shaft, so gearsets only matter to the code that reads them back.
+
+namespace pros {
+
+namespace {
+
+constexpr double radToDeg = 180 / M_PI;
+
+} // namespace
+
+// motors
+
+Motor::Motor(std::int8_t port, motor_gearset_e_t gearset, bool reverse, motor_encoder_units_e_t encoder_units)
+    : port(static_cast<std::uint8_t>(std::abs(port))),
+      gearset(gearset),
+      units(encoder_units),
+      reversed(reverse != (port < 0)) {}
+
+Motor::Motor(std::int8_t port, bool reverse)
+    : Motor(port, E_MOTOR_GEARSET_18, reverse) {}
+
+std::int32_t Motor::move(std::int32_t voltage) { return move_voltage(voltage * 12000 / 127); }
+
+std::int32_t Motor::move_voltage(std::int32_t voltage) {
+    sim::MotorState& m = sim::world().motor(port);
+    m.mode = sim::MotorState::Mode::Voltage;
+    m.command = sign() * std::clamp(voltage, -12000, 12000);
+    if (m.command == 0) m.holdPosition = m.angle;
+    return 1;
+}
+
+std::int32_t Motor::move_velocity(std::int32_t velocity) {
+    sim::MotorState& m = sim::world().motor(port);
+    m.mode = sim::MotorState::Mode::Velocity;
+    m.command = sign() * velocity;
+    return 1;
+}
+
+std::int32_t Motor::brake() {
+    sim::MotorState& m = sim::world().motor(port);
+    m.mode = sim::MotorState::Mode::Brake;
+    m.holdPosition = m.angle;
+    return 1;
+}
+
+double Motor::get_actual_velocity() const {
+    return sign() * sim::world().motor(port).filteredRpm;
+}
+
+double Motor::get_position() const {
+    const sim::MotorState& m = sim::world().motor(port);
+    const double degrees = sign() * (m.angle - m.zero) * radToDeg;
+    switch (units) {
+        case E_MOTOR_ENCODER_ROTATIONS: return degrees / 360;
+        case E_MOTOR_ENCODER_COUNTS: return degrees * 300 / 360;
+        default: return degrees;
+    }
+}
+
+std::int32_t Motor::tare_position() const {
+    sim::MotorState& m = sim::world().motor(port);
+    m.zero = m.angle;
+    return 1;
+}
+
+std::int32_t Motor::set_zero_position(double position) const {
+    sim::MotorState& m = sim::world().motor(port);
+    m.zero = m.angle - sign() * position / radToDeg;
+    return 1;
+}
+
+double Motor::get_temperature() const {
+    // the motor reports temperature in 5 C steps
+    return std::floor(sim::world().motor(port).temperature / 5) * 5;
+}
+
+std::int32_t Motor::get_current_draw() const {
+    return static_cast<std::int32_t>(sign() * sim::world().motor(port).amps * 1000);
+}
+
+double Motor::get_power() const {
+    const sim::MotorState& m = sim::world().motor(port);
+    return std::abs(m.volts * m.amps);
+}
+
+double Motor::get_efficiency() const {
+    const sim::MotorState& m = sim::world().motor(port);
+    const double input = m.volts * m.amps;
+    if (input <= 0) return 0;
+    return std::clamp(m.torque * m.velocity / input * 100, 0.0, 100.0);
+}
+
+double Motor::get_torque() const { return std::abs(sim::world().motor(port).torque); }
+
+std::int32_t Motor::get_voltage() const {
+    return static_cast<std::int32_t>(sign() * sim::world().motor(port).volts * 1000);
+}
+
+std::int32_t Motor::is_over_temp() const { return sim::world().motor(port).temperature >= 55; }
+
+std::int32_t Motor::is_over_current() const {
+    const sim::MotorState& m = sim::world().motor(port);
+    return std::abs(m.amps) * 1000 >= m.currentLimit - 1;
+}
+
+std::int32_t Motor::set_brake_mode(motor_brake_mode_e_t mode) const {
+    sim::world().motor(port).brakeMode = mode;
+    return 1;
+}
+
+std::int32_t Motor::set_current_limit(std::int32_t limit) const {
+    sim::world().motor(port).currentLimit = std::clamp(limit, 0, 2500);
+    return 1;
+}
+
+std::int32_t Motor::get_current_limit() const {
+    return static_cast<std::int32_t>(sim::world().motor(port).currentLimit);
+}
+
+std::int32_t Motor::set_voltage_limit(std::int32_t limit) const {
+    sim::world().motor(port).voltageLimit = std::clamp(limit, 0, 12000);
+    return 1;
+}
+
+std::int32_t Motor::get_voltage_limit() const {
+    return static_cast<std::int32_t>(sim::world().motor(port).voltageLimit);
+}
+
+std::int32_t Motor::set_gearing(motor_gearset_e_t gearset) {
+    this->gearset = gearset;
+    return 1;
+}
+
+std::int32_t Motor::set_reversed(bool reverse) {
+    reversed = reverse;
+    return 1;
+}
+
+std::int32_t Motor::set_encoder_units(motor_encoder_units_e_t units) {
+    this->units = units;
+    return 1;
+}
+
+// motor groups
+
+MotorGroup::MotorGroup(std::initializer_list<Motor> motors)
+    : motors(motors) {}
+
+MotorGroup::MotorGroup(const std::vector<Motor>& motors)
+    : motors(motors) {}
+
+std::int32_t MotorGroup::move(std::int32_t voltage) {
+    for (auto& motor : motors) motor.move(voltage);
+    return 1;
+}
+
+std::int32_t MotorGroup::move_voltage(std::int32_t voltage) {
+    for (auto& motor : motors) motor.move_voltage(voltage);
+    return 1;
+}
+
+std::int32_t MotorGroup::move_velocity(std::int32_t velocity) {
+    for (auto& motor : motors) motor.move_velocity(velocity);
+    return 1;
+}
+
+std::int32_t MotorGroup::brake() {
+    for (auto& motor : motors) motor.brake();
+    return 1;
+}
+
+std::vector<double> MotorGroup::get_actual_velocities() {
+    std::vector<double> out;
+    for (const auto& motor : motors) out.push_back(motor.get_actual_velocity());
+    return out;
+}
+
+std::vector<double> MotorGroup::get_positions() {
+    std::vector<double> out;
+    for (const auto& motor : motors) out.push_back(motor.get_position());
+    return out;
+}
+
+std::int32_t MotorGroup::tare_position() {
+    for (const auto& motor : motors) motor.tare_position();
+    return 1;
+}
+
+std::vector<double> MotorGroup::get_temperatures() {
+    std::vector<double> out;
+    for (const auto& motor : motors) out.push_back(motor.get_temperature());
+    return out;
+}
+
+std::vector<std::int32_t> MotorGroup::get_current_draws() {
+    std::vector<std::int32_t> out;
+    for (const auto& motor : motors) out.push_back(motor.get_current_draw());
+    return out;
+}
+
+std::vector<double> MotorGroup::get_powers() {
+    std::vector<double> out;
+    for (const auto& motor : motors) out.push_back(motor.get_power());
+    return out;
+}
+
+std::vector<double> MotorGroup::get_efficiencies() {
+    std::vector<double> out;
+    for (const auto& motor : motors) out.push_back(motor.get_efficiency());
+    return out;
+}
+
+std::vector<std::int32_t> MotorGroup::get_voltages() {
+    std::vector<std::int32_t> out;
+    for (const auto& motor : motors) out.push_back(motor.get_voltage());
+    return out;
+}
+
+std::int32_t MotorGroup::set_brake_modes(motor_brake_mode_e_t mode) {
+    for (const auto& motor : motors) motor.set_brake_mode(mode);
+    return 1;
+}
+
+std::int32_t MotorGroup::set_current_limit(std::int32_t limit) {
+    for (const auto& motor : motors) motor.set_current_limit(limit);
+    return 1;
+}
+
+std::int32_t MotorGroup::set_voltage_limit(std::int32_t limit) {
+    for (const auto& motor : motors) motor.set_voltage_limit(limit);
+    return 1;
+}
+
+std::vector<std::int32_t> MotorGroup::get_voltage_limits() {
+    std::vector<std::int32_t> out;
+    for (const auto& motor : motors) out.push_back(motor.get_voltage_limit());
+    return out;
+}
+
+std::vector<motor_gearset_e_t> MotorGroup::get_gearing() {
+    std::vector<motor_gearset_e_t> out;
+    for (const auto& motor : motors) out.push_back(motor.get_gearing());
+    return out;
+}
+
+// three wire ports
+
+ADIDigitalOut::ADIDigitalOut(std::uint8_t adi_port, bool init_state)
+    : port(static_cast<char>(std::toupper(adi_port))),
+      initial(init_state) {}
+
+std::int32_t ADIDigitalOut::set_value(std::int32_t value) {
+    sim::world().setAdi(port, value != 0);
+    return 1;
+}
+
+// inertial sensor
+
+Imu::Imu(std::uint8_t port)
+    : port(port) {}
+
+std::int32_t Imu::set_data_rate(std::uint32_t) { return 1; }
+
+std::int32_t Imu::reset(bool blocking) {
+    sim::ImuState& imu = sim::world().imu(port);
+    imu.calibrating = true;
+    imu.calibratedAtUs = sim::world().nowUs() + static_cast<std::uint64_t>(sim::world().config().imuCalibrationMs * 1000);
+    if (blocking) {
+        while (imu.calibrating) pros::delay(10);
+    }
+    return 1;
+}
+
+// a port with nothing on it fails the way PROS does: an error status and infinite readings
+bool Imu::is_calibrating() const {
+    const sim::ImuState& imu = sim::world().imu(port);
+    return !imu.connected || imu.calibrating;
+}
+
+ImuStatus Imu::get_status() const {
+    const sim::ImuState& imu = sim::world().imu(port);
+    if (!imu.connected) return ImuStatus::error;
+    return imu.calibrating ? ImuStatus::calibrating : ImuStatus::ready;
+}
+
+double Imu::get_rotation() const {
+    const sim::ImuState& imu = sim::world().imu(port);
+    if (!imu.connected) return INFINITY;
+    if (imu.calibrating) return 0;
+    return imu.heading + imu.offset;
+}
+
+double Imu::get_heading() const {
+    const double rotation = get_rotation();
+    if (!std::isfinite(rotation)) return rotation;
+    const double heading = std::fmod(rotation, 360);
+    return heading < 0 ? heading + 360 : heading;
+}
+
+double Imu::get_yaw() const { return std::remainder(get_rotation(), 360); }
+
+std::int32_t Imu::tare() { return set_rotation(0); }
+
+std::int32_t Imu::tare_heading() { return set_rotation(0); }
+
+std::int32_t Imu::tare_rotation() { return set_rotation(0); }
+
+std::int32_t Imu::set_heading(double target) { return set_rotation(target); }
+
+std::int32_t Imu::set_rotation(double target) {
+    sim::ImuState& imu = sim::world().imu(port);
+    imu.offset = target - imu.heading;
+    return 1;
+}
+
+// rotation sensor
+
+Rotation::Rotation(std::uint8_t port, bool reverse_flag)
+    : port(port),
+      reversed(reverse_flag) {}
+
+std::int32_t Rotation::reset_position() {
+    sim::RotationState& r = sim::world().rotation(port);
+    r.zero = r.angle;
+    return 1;
+}
+
+std::int32_t Rotation::set_position(std::uint32_t position) {
+    sim::RotationState& r = sim::world().rotation(port);
+    r.zero = r.angle - sign() * position / 100.0 / radToDeg;
+    return 1;
+}
+
+std::int32_t Rotation::get_position() const {
+    const sim::RotationState& r = sim::world().rotation(port);
+    return static_cast<std::int32_t>(std::lround(sign() * (r.angle - r.zero) * radToDeg * 100));
+}
+
+std::int32_t Rotation::get_angle() const {
+    const std::int32_t angle = get_position() % 36000;
+    return angle < 0 ? angle + 36000 : angle;
+}
+
+std::int32_t Rotation::get_velocity() const {
+    return static_cast<std::int32_t>(sign() * sim::world().rotation(port).velocity * radToDeg * 100);
+}
+
+std::int32_t Rotation::set_data_rate(std::uint32_t) { return 1; }
+
+std::int32_t Rotation::set_reversed(bool value) {
+    reversed = value;
+    return 1;
+}
+
+// distance sensor
+
+Distance::Distance(std::uint8_t port)
+    : port(port) {}
+
+std::int32_t Distance::get() { return sim::world().distance(port).mm; }
+
+std::int32_t Distance::get_confidence() { return sim::world().distance(port).confidence; }
+
+std::int32_t Distance::get_object_size() { return sim::world().distance(port).mm == 9999 ? 0 : 400; }
+
+double Distance::get_object_velocity() { return 0; }
+
+// controller
+
+Controller::Controller(controller_id_e_t id)
+    : id(id) {}
+
+std::int32_t Controller::get_analog(controller_analog_e_t channel) {
+    if (id != E_CONTROLLER_MASTER) return 0;
+    return std::clamp(sim::world().controller().analog[channel], -127, 127);
+}
+
+std::int32_t Controller::get_digital(controller_digital_e_t button) {
+    if (id != E_CONTROLLER_MASTER) return 0;
+    return sim::world().controller().digital[button - E_CONTROLLER_DIGITAL_L1];
+}
+
+std::int32_t Controller::get_digital_new_press(controller_digital_e_t button) {
+    const int i = button - E_CONTROLLER_DIGITAL_L1;
+    const bool pressed = get_digital(button);
+    const bool edge = pressed && !latched[i];
+    latched[i] = pressed;
+    return edge;
+}
+
+std::uint8_t competition::is_connected() { return 0; }
+
+double battery::get_voltage() { return sim::world().batteryVolts() * 1000; }
+
+std::int32_t usd::is_installed() { return !sim::world().config().sdCard.empty(); }
+
+} // namespace pros
+
+// the robot opens files on the SD card as /usd/...; the host build links with --wrap=fopen so
+// those paths land in the directory standing in for the card
+
+extern "C" std::FILE* __real_fopen(const char* path, const char* mode);
+
+extern "C" std::FILE* __wrap_fopen(const char* path, const char* mode) {
+    if (std::strncmp(path, "/usd/", 5) != 0) return __real_fopen(path, mode);
+    const std::string& card = sim::world().config().sdCard;
+    if (card.empty()) return nullptr;
+    return __real_fopen((card + "/" + (path + 5)).c_str(), mode);
+}
@@ -0,0 +1,209 @@
+#include "sim/runtime.hpp"
+
+#include <pthread.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace sim {
+
+struct Task {
+        TaskId id;
+        std::function<void()> fn;
+        std::uint32_t priority;
+        std::string name;
+        std::uint64_t wake = 0;
+        std::uint64_t seq = 0;
+        bool done = false;
+        bool removed = false;
+        std::function<void()> body; // what the host thread runs around fn
+        pthread_t thread {};
+        bool joinable = false;
+};
+
+namespace {
+
+/** what a task's host thread runs, see Runtime::spawn */
+void* startThread(void* task) {
+    static_cast<Task*>(task)->body();
+    return nullptr;
+}
+
+} // namespace
+
+struct Runtime::Impl {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::map<TaskId, std::unique_ptr<Task>> tasks;
+        TickHook hook;
+        TaskId nextId = 1;
+        std::uint64_t seq = 0;
+        bool halting = false;
+
+        /** step the clock forward, ticking the world on every millisecond boundary */
+        void advance(std::uint64_t& now, std::uint64_t wake) {
+            while (now < wake) {
+                now = std::min(wake, (now / 1000 + 1) * 1000);
+                if (now % 1000 == 0 && hook) hook(now);
+            }
+        }
+};
+
+Runtime& Runtime::get() {
+    static Runtime runtime;
+    return runtime;
+}
+
+/**
+ * Pick the task with the earliest wake time. Ties go to the higher priority and then to whichever
+ * task went to sleep first, which is what FreeRTOS does for equal wake ticks.
+ */
+static Task* pickNext(std::map<TaskId, std::unique_ptr<Task>>& tasks) {
+    Task* best = nullptr;
+    for (auto& [id, task] : tasks) {
+        if (task->done) continue;
+        if (best == nullptr || task->wake < best->wake ||
+            (task->wake == best->wake &&
+             (task->priority > best->priority || (task->priority == best->priority && task->seq < best->seq)))) {
+            best = task.get();
+        }
+    }
+    return best;
+}
+
+void Runtime::run(const std::function<void()>& entry, TickHook hook) {
+    impl = new Impl;
+    impl->hook = std::move(hook);
+    auto main = std::make_unique<Task>();
+    main->id = 0;
+    main->priority = 8;
+    main->name = "main";
+    impl->tasks.emplace(0, std::move(main));
+    running = 0;
+    now = 0;
+
+    try {
+        entry();
+    } catch (Halt&) {}
+
+    // unwind the remaining tasks one at a time so their destructors never overlap
+    std::unique_lock<std::mutex> lock(impl->mutex);
+    impl->halting = true;
+    impl->tasks[0]->done = true;
+    for (auto& [id, task] : impl->tasks) {
+        if (id == 0 || !task->joinable) continue;
+        running = id;
+        impl->cv.notify_all();
+        impl->cv.wait(lock, [&] { return task->done; });
+        lock.unlock();
+        pthread_join(task->thread, nullptr);
+        lock.lock();
+    }
+    lock.unlock();
+    delete impl;
+    impl = nullptr;
+}
+
+TaskId Runtime::spawn(std::function<void()> fn, std::uint32_t priority, const char* name, void* stack,
+                      std::size_t stackSize) {
+    std::lock_guard<std::mutex> lock(impl->mutex);
+    auto task = std::make_unique<Task>();
+    Task* raw = task.get();
+    raw->id = impl->nextId++;
+    raw->fn = std::move(fn);
+    raw->priority = priority;
+    raw->name = name != nullptr ? name : "";
+    raw->wake = now;
+    raw->seq = ++impl->seq;
+    impl->tasks.emplace(raw->id, std::move(task));
+    raw->body = [this, raw] {
+        {
+            std::unique_lock<std::mutex> lock(impl->mutex);
+            impl->cv.wait(lock, [&] { return running == raw->id; });
+        }
+        if (!impl->halting && !raw->removed) {
+            try {
+                raw->fn();
+            } catch (Halt&) {}
+        }
+        std::unique_lock<std::mutex> lock(impl->mutex);
+        raw->done = true;
+        if (impl->halting) {
+            impl->cv.notify_all();
+            return;
+        }
+        Task* next = pickNext(impl->tasks);
+        impl->advance(now, next->wake);
+        running = next->id;
+        impl->cv.notify_all();
+    };
+    pthread_attr_t attributes;
+    pthread_attr_init(&attributes);
+    if (stack != nullptr) pthread_attr_setstack(&attributes, stack, stackSize);
+    raw->joinable = pthread_create(&raw->thread, &attributes, startThread, raw) == 0;
+    pthread_attr_destroy(&attributes);
+    return raw->id;
+}
+
+void Runtime::remove(TaskId id) {
+    std::unique_lock<std::mutex> lock(impl->mutex);
+    auto it = impl->tasks.find(id);
+    if (it == impl->tasks.end() || it->second->done) return;
+    it->second->removed = true;
+    if (id == running) {
+        lock.unlock();
+        throw Halt();
+    }
+    // wake it immediately so it unwinds before anything else runs
+    it->second->wake = now;
+    it->second->seq = 0;
+}
+
+bool Runtime::isDone(TaskId id) {
+    std::lock_guard<std::mutex> lock(impl->mutex);
+    auto it = impl->tasks.find(id);
+    return it == impl->tasks.end() || it->second->done;
+}
+
+void Runtime::sleepUntil(std::uint64_t wakeUs) {
+    std::unique_lock<std::mutex> lock(impl->mutex);
+    if (impl->halting) throw Halt();
+    Task* self = impl->tasks[running].get();
+    self->wake = std::max(wakeUs, now);
+    self->seq = ++impl->seq;
+
+    Task* next = pickNext(impl->tasks);
+    impl->advance(now, next->wake);
+    running = next->id;
+    if (next != self) {
+        impl->cv.notify_all();
+        impl->cv.wait(lock, [&] { return running == self->id; });
+    }
+    if (impl->halting || self->removed) throw Halt();
+}
+
+std::uint32_t Runtime::priority(TaskId id) {
+    std::lock_guard<std::mutex> lock(impl->mutex);
+    auto it = impl->tasks.find(id);
+    return it == impl->tasks.end() ? 0 : it->second->priority;
+}
+
+void Runtime::setPriority(TaskId id, std::uint32_t priority) {
+    std::lock_guard<std::mutex> lock(impl->mutex);
+    auto it = impl->tasks.find(id);
+    if (it != impl->tasks.end()) it->second->priority = priority;
+}
+
+const char* Runtime::name(TaskId id) {
+    // only the running task changes the task table, and this is called from it, so no lock. The
+    // heap guard asks from inside operator new, which may be under the lock already, or after the run
+    if (impl == nullptr) return "";
+    auto it = impl->tasks.find(id);
+    return it == impl->tasks.end() ? "" : it->second->name.c_str();
+}
+
+} // namespace sim
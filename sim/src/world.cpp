@@ -0,0 +1,324 @@
+#include "sim/world.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace sim {
+
+namespace {
+
+constexpr double inch = 0.0254; // m
+constexpr double gravity = 9.81;
+
+// V5 smart motor with the 600 rpm cartridge, referred to the output shaft
+constexpr double freeSpeed = 600 * 2 * M_PI / 60; // rad/s at 12 V
+constexpr double backEmf = 12.0 / freeSpeed; // V per rad/s
+constexpr double torqueConstant = 0.14; // Nm per A
+constexpr double windingResistance = 4.8; // ohm, 2.5 A stall
+constexpr double copperLoss = 2.4; // ohm, share of the winding losses that heats the motor
+constexpr double heatCapacity = 30; // J per C
+constexpr double heatTransfer = 0.12; // W per C
+constexpr double velocityGain = 0.5; // V per rad/s of error, built-in velocity controller
+constexpr double holdGain = 20; // V per rad, built-in position hold
+
+// drive train
+constexpr double wheelMass = 0.5; // kg, rotating mass of one side seen at the tread
+constexpr double bearingDrag = 0.3; // N per m/s
+constexpr double slipStiffness = 400; // N per m/s of slip
+constexpr double slidingGrip = 0.7; // share of the peak grip left once the wheels spin well past it
+constexpr double rollingDrag = 1.5; // N
+constexpr double turnScrub = 0.4; // Nm
+constexpr double lateralStiffness = 60; // N per m/s of sideways slide
+constexpr int substeps = 4;
+
+// field, in
+constexpr double perimeter = 72;
+constexpr double barrierHalfWidth = 0.7; // the long barrier down the middle, from x = -0.7 to 0.7
+constexpr double barrierHalfLength = 47;
+
+// V5 distance sensor
+constexpr std::uint64_t rangePeriod = 33000; // us between readings
+constexpr double maxRange = 2000; // mm
+constexpr double nearRange = 200; // mm, closer than this the error is fixed rather than proportional
+constexpr double nearNoise = 10; // mm
+constexpr double rangeNoise = 0.025; // of the distance
+constexpr double minIncidence = 0.3; // cosine, more glancing than this the pulse doesn't come back
+
+World* current = nullptr;
+
+double clamp(double value, double limit) { return std::clamp(value, -limit, limit); }
+
+/** tread force for a wheel turning slip m/s faster than the ground. It peaks and falls off as the wheel spins */
+double treadForce(double slip, double grip) {
+    const double peak = grip / slipStiffness;
+    if (std::abs(slip) <= peak) return slipStiffness * slip;
+    return std::copysign(grip * (slidingGrip + (1 - slidingGrip) * peak / std::abs(slip)), slip);
+}
+
+/** firmware current limit derating, as reported by PROS for the V5 motor */
+double thermalScale(double temperature) {
+    if (temperature >= 70) return 0;
+    if (temperature >= 65) return 0.125;
+    if (temperature >= 60) return 0.25;
+    if (temperature >= 55) return 0.5;
+    return 1;
+}
+
+} // namespace
+
+World& world() { return *current; }
+
+void setWorld(World* world) { current = world; }
+
+World::World(WorldConfig config)
+    : cfg(std::move(config)),
+      random(cfg.seed) {
+    for (auto& motor : motors) motor.temperature = cfg.startTempC;
+    for (const auto& spec : cfg.leftDrive) motors[spec.port].connected = true;
+    for (const auto& spec : cfg.rightDrive) motors[spec.port].connected = true;
+    for (const auto& spec : cfg.trackers) rotations[spec.port].connected = true;
+    imus[cfg.imuPort].connected = true;
+    for (const auto& spec : cfg.distanceSensors) distances[spec.port].connected = true;
+    battery = cfg.batteryVolts;
+    // up front, so the robot's heap guard doesn't count the log growing
+    events.reserve(1024);
+    place(cfg.start);
+}
+
+void World::place(const FieldPose& pose) {
+    // the IMU measures rotation, so picking the robot up and turning it must not show up as a turn
+    const double turned = pose.theta - heading * 180 / M_PI;
+    for (auto& imu : imus) {
+        imu.heading += turned;
+        imu.offset -= turned;
+    }
+    x = pose.x * inch;
+    y = pose.y * inch;
+    heading = pose.theta * M_PI / 180;
+    vx = vy = yawRate = 0;
+    leftWheel = rightWheel = 0;
+}
+
+FieldPose World::truePose() const { return {x / inch, y / inch, heading * 180 / M_PI}; }
+
+std::array<double, 3> World::trueVelocity() const {
+    const double forward = vx * std::sin(heading) + vy * std::cos(heading);
+    const double sideways = vx * std::cos(heading) - vy * std::sin(heading);
+    return {forward / inch, sideways / inch, yawRate * 180 / M_PI};
+}
+
+MotorState& World::motor(int port) { return motors[std::clamp(port, 0, 21)]; }
+
+RotationState& World::rotation(int port) { return rotations[std::clamp(port, 0, 21)]; }
+
+ImuState& World::imu(int port) { return imus[std::clamp(port, 0, 21)]; }
+
+DistanceState& World::distance(int port) { return distances[std::clamp(port, 0, 21)]; }
+
+bool World::adi(char port) const { return adiOut[std::clamp(port - 'A', 0, 7)]; }
+
+void World::setAdi(char port, bool value) {
+    bool& out = adiOut[std::clamp(port - 'A', 0, 7)];
+    if (out == value) return;
+    out = value;
+    events.push_back({now, port, value});
+}
+
+double World::sideForce(const std::vector<DriveMotorSpec>& specs, double wheelSpeed, double dt) {
+    const double radius = cfg.wheelDiameter * inch / 2;
+    const double supply = std::min(battery, 12.8);
+    double force = 0;
+    for (const auto& spec : specs) {
+        MotorState& m = motors[spec.port];
+        m.velocity = spec.mount * wheelSpeed / radius;
+        m.angle += m.velocity * dt;
+
+        MotorState::Mode mode = m.mode;
+        if (mode == MotorState::Mode::Voltage && m.command == 0) mode = MotorState::Mode::Brake;
+        bool open = false;
+        double volts = 0;
+        switch (mode) {
+            case MotorState::Mode::Voltage: volts = m.command / 1000; break;
+            case MotorState::Mode::Velocity: {
+                const double target = m.command * 2 * M_PI / 60;
+                volts = target * backEmf + velocityGain * (target - m.velocity);
+                break;
+            }
+            case MotorState::Mode::Brake:
+                if (m.brakeMode == 0) open = true; // coast
+                else if (m.brakeMode == 2) volts = holdGain * (m.holdPosition - m.angle);
+                break;
+        }
+        if (m.voltageLimit > 0) volts = clamp(volts, m.voltageLimit / 1000);
+        volts = clamp(volts, supply);
+
+        const double limit = m.currentLimit / 1000 * thermalScale(m.temperature);
+        m.amps = open ? 0 : clamp((volts - backEmf * m.velocity) / windingResistance, limit);
+        m.volts = open ? 0 : volts;
+        m.torque = torqueConstant * m.amps;
+        force += spec.mount * m.torque / radius;
+    }
+    return force;
+}
+
+void World::stepDrive(double dt) {
+    const double track = cfg.trackWidth * inch;
+    const double sideLoad = cfg.massKg * gravity / 2;
+    const double grip = cfg.traction * sideLoad;
+
+    const double fx = std::sin(heading), fy = std::cos(heading);
+    const double rx = std::cos(heading), ry = -std::sin(heading);
+    const double forward = vx * fx + vy * fy;
+    const double sideways = vx * rx + vy * ry;
+
+    // ground speed under each side
+    const double leftGround = forward + yawRate * track / 2;
+    const double rightGround = forward - yawRate * track / 2;
+
+    const double leftDrive = sideForce(cfg.leftDrive, leftWheel, dt);
+    const double rightDrive = sideForce(cfg.rightDrive, rightWheel, dt);
+    const double leftGrip = treadForce(leftWheel - leftGround, grip);
+    const double rightGrip = treadForce(rightWheel - rightGround, grip);
+    leftWheel += (leftDrive - leftGrip - bearingDrag * leftWheel) / wheelMass * dt;
+    rightWheel += (rightDrive - rightGrip - bearingDrag * rightWheel) / wheelMass * dt;
+
+    const double rolling = rollingDrag * std::tanh(forward / 0.02);
+    const double lateral = clamp(-lateralStiffness * sideways, cfg.lateralTraction * cfg.massKg * gravity);
+    const double longitudinal = leftGrip + rightGrip - rolling;
+    vx += (longitudinal * fx + lateral * rx) / cfg.massKg * dt;
+    vy += (longitudinal * fy + lateral * ry) / cfg.massKg * dt;
+    yawRate += ((leftGrip - rightGrip) * track / 2 - turnScrub * std::tanh(yawRate / 0.05)) / cfg.inertiaKgM2 * dt;
+
+    x += vx * dt;
+    y += vy * dt;
+    heading += yawRate * dt;
+
+    // field perimeter
+    const double wall = (72 - cfg.robotHalfSize) * inch;
+    if (std::abs(x) > wall) {
+        x = std::clamp(x, -wall, wall);
+        vx = 0;
+    }
+    if (std::abs(y) > wall) {
+        y = std::clamp(y, -wall, wall);
+        vy = 0;
+    }
+    // the long barrier, pushed out of along whichever side the robot is least far into it. The
+    // robot is longer than it is wide, so how far it reaches depends on the way it faces
+    if (onField) {
+        const double reachX = cfg.robotHalfSize * std::abs(fx) + cfg.robotHalfWidth * std::abs(fy);
+        const double reachY = cfg.robotHalfSize * std::abs(fy) + cfg.robotHalfWidth * std::abs(fx);
+        const double halfWidth = (barrierHalfWidth + reachX) * inch;
+        const double halfLength = (barrierHalfLength + reachY) * inch;
+        if (std::abs(x) < halfWidth && std::abs(y) < halfLength) {
+            if (halfWidth - std::abs(x) < halfLength - std::abs(y)) {
+                x = std::copysign(halfWidth, x);
+                vx = 0;
+            } else {
+                y = std::copysign(halfLength, y);
+                vy = 0;
+            }
+        }
+    }
+
+    // unpowered tracking wheels roll with the ground
+    for (const auto& spec : cfg.trackers) {
+        RotationState& r = rotations[spec.port];
+        const double speed = forward - (1 - cfg.trackerScrub) * yawRate * spec.offset * inch;
+        r.velocity = spec.mount * speed / (spec.diameter * inch / 2);
+        r.angle += r.velocity * dt;
+    }
+}
+
+void World::stepThermal(double dt) {
+    totalAmps = 0;
+    for (auto& m : motors) {
+        if (!m.connected) continue;
+        const double heat = m.amps * m.amps * copperLoss;
+        m.temperature += (heat - heatTransfer * (m.temperature - cfg.ambientC)) / heatCapacity * dt;
+        m.filteredRpm += (m.velocity * 60 / (2 * M_PI) - m.filteredRpm) * std::min(1.0, dt / 0.02);
+        totalAmps += std::abs(m.amps);
+    }
+    battery = cfg.batteryVolts - cfg.batteryResistance * totalAmps;
+}
+
+double World::castRay(double fromX, double fromY, double direction, double& incidence) const {
+    const double dx = std::sin(direction * M_PI / 180), dy = std::cos(direction * M_PI / 180);
+    double nearest = INFINITY;
+    // a wall along x = at, between low and high in y, or along y = at when vertical is false
+    auto wall = [&](bool vertical, double at, double low, double high) {
+        const double along = vertical ? dx : dy;
+        if (std::abs(along) < 1e-9) return;
+        const double distance = (at - (vertical ? fromX : fromY)) / along;
+        const double across = vertical ? fromY + distance * dy : fromX + distance * dx;
+        if (distance <= 0 || distance >= nearest || across < low || across > high) return;
+        nearest = distance;
+        incidence = std::abs(along);
+    };
+    for (double side : {-perimeter, perimeter}) {
+        wall(true, side, -perimeter, perimeter);
+        wall(false, side, -perimeter, perimeter);
+    }
+    if (onField) {
+        for (double side : {-barrierHalfWidth, barrierHalfWidth}) {
+            wall(true, side, -barrierHalfLength, barrierHalfLength);
+        }
+        for (double side : {-barrierHalfLength, barrierHalfLength}) {
+            wall(false, side, -barrierHalfWidth, barrierHalfWidth);
+        }
+    }
+    return nearest;
+}
+
+void World::stepRanging() {
+    const FieldPose pose = truePose();
+    const double s = std::sin(heading), c = std::cos(heading);
+    for (const auto& spec : cfg.distanceSensors) {
+        DistanceState& sensor = distances[spec.port];
+        double incidence = 0;
+        const double range = castRay(pose.x + spec.forward * s + spec.right * c,
+                                     pose.y + spec.forward * c - spec.right * s, pose.theta + spec.angle, incidence) *
+                             1000 * inch;
+        if (range > maxRange || incidence < minIncidence) {
+            sensor.mm = 9999;
+            sensor.confidence = 0;
+            continue;
+        }
+        std::normal_distribution<double> noise(0, range < nearRange ? nearNoise : rangeNoise * range);
+        sensor.mm = std::max(0, static_cast<int>(std::lround(range + noise(random))));
+        // a far or glancing target sends less back
+        sensor.confidence = static_cast<int>(63 * incidence * std::min(1.0, 1.5 - range / maxRange));
+    }
+}
+
+void World::step(std::uint64_t nowUs) {
+    now = nowUs;
+    if (driver && now % 10000 == 0) driver(now, pad);
+
+    // once the drive has been told to move, a later setPose is a reset, not where the robot was put
+    for (const auto* side : {&cfg.leftDrive, &cfg.rightDrive}) {
+        for (const DriveMotorSpec& spec : *side) placed = placed || motors[spec.port].command != 0;
+    }
+
+    const double dt = 0.001;
+    for (int i = 0; i < substeps; i++) stepDrive(dt / substeps);
+    stepThermal(dt);
+
+    imuDrift += cfg.imuDriftDegPerMin / 60000;
+    std::normal_distribution<double> noise(0, cfg.imuNoiseDeg);
+    for (auto& imu : imus) {
+        if (!imu.connected) continue;
+        imu.heading = heading * 180 / M_PI + imuDrift + noise(random);
+        if (imu.calibrating && now >= imu.calibratedAtUs) {
+            // the IMU zeroes itself when calibration finishes
+            imu.calibrating = false;
+            imu.offset = -imu.heading;
+        }
+    }
+
+    if (now % rangePeriod == 0) stepRanging();
+
+    for (auto& observer : observers) observer(*this);
+}
+
+} // namespace sim
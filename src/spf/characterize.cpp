@@ -0,0 +1,179 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+
+#include "pros/rtos.hpp"
+#include "spf/characterize.hpp"
+#include "spf/odometry.hpp"
+#include "spf/textLog.hpp"
+
+namespace spf {
+
+namespace {
+
+/** a stretch of voltage the drive runs, after a pause at rest */
+struct Phase {
+        float start; // mV
+        float rate; // mV per second
+        int duration; // ms
+};
+
+constexpr Phase phases[] = {
+    {0, 1000, 4000}, // quasistatic ramp forwards, to 4 V
+    {0, -1000, 4000}, // and backwards
+    {6000, 0, 1000}, // step forwards
+    {-6000, 0, 1000}, // and backwards
+};
+constexpr int pause = 500; // ms at 0 V before each phase, so the next one starts from rest
+constexpr int period = 10; // ms
+constexpr int maxSamples = 1000;
+// velocity and acceleration come from positions this many samples either side. The encoders
+// count 300 ticks a wheel turn, so over a single sample the acceleration would be noise
+constexpr int stencil = 5;
+// slower than this the sides are sticking and breaking loose, which the model doesn't cover, in/s
+constexpr float minSpeed = 2;
+constexpr int minSamples = 100;
+
+struct Sample {
+        std::array<float, 2> voltage; // mV, left and right
+        std::array<float, 2> position; // in
+        int phase;
+};
+
+// recorded into a fixed buffer, the heap guard is armed in autonomous
+std::array<Sample, maxSamples> samples;
+
+/** least squares fit of one side over the samples recorded */
+Feedforward fit(int count, int side, float& r2, int& used) {
+    // normal equations of V = kS sgn(v) + kV v + kA a
+    double ata[3][3] = {};
+    double atb[3] = {};
+    double sum = 0, sumSquares = 0;
+    used = 0;
+    const float dt = stencil * period / 1000.0f;
+    for (int i = stencil; i < count - stencil; i++) {
+        const Sample& before = samples[i - stencil];
+        const Sample& after = samples[i + stencil];
+        if (before.phase != samples[i].phase || after.phase != samples[i].phase) continue;
+        const float velocity = (after.position[side] - before.position[side]) / (2 * dt);
+        const float acceleration =
+            (after.position[side] - 2 * samples[i].position[side] + before.position[side]) / (dt * dt);
+        if (std::fabs(velocity) < minSpeed) continue;
+        const double row[3] = {velocity > 0 ? 1.0 : -1.0, velocity, acceleration};
+        const double voltage = samples[i].voltage[side];
+        for (int r = 0; r < 3; r++) {
+            for (int c = 0; c < 3; c++) ata[r][c] += row[r] * row[c];
+            atb[r] += row[r] * voltage;
+        }
+        sum += voltage;
+        sumSquares += voltage * voltage;
+        used++;
+    }
+
+    // Cramer's rule, the system is only 3 by 3
+    auto determinant = [](const double m[3][3]) {
+        return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) +
+               m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+    };
+    const double d = determinant(ata);
+    if (used < minSamples || std::fabs(d) < 1e-9) {
+        r2 = 0;
+        return {};
+    }
+    double gains[3];
+    for (int c = 0; c < 3; c++) {
+        double m[3][3];
+        for (int r = 0; r < 3; r++) {
+            for (int k = 0; k < 3; k++) m[r][k] = k == c ? atb[r] : ata[r][k];
+        }
+        gains[c] = determinant(m) / d;
+    }
+
+    // the residual follows from the normal equations: |b - Ax|^2 = b.b - x.A'b
+    double explained = 0;
+    for (int c = 0; c < 3; c++) explained += gains[c] * atb[c];
+    const double total = sumSquares - sum * sum / used;
+    r2 = total > 0 ? 1 - (sumSquares - explained) / total : 0;
+    return {float(gains[0]), float(gains[1]), float(gains[2])};
+}
+
+bool plausible(const Feedforward& gains) {
+    return std::isfinite(gains.kS) && std::isfinite(gains.kV) && std::isfinite(gains.kA) && gains.kS >= 0 &&
+           gains.kV > 0 && gains.kA > 0;
+}
+
+} // namespace
+
+Characterization characterize(pros::MotorGroup& leftMotors, pros::MotorGroup& rightMotors, const DriveModel& model) {
+    int count = 0;
+    std::uint32_t now = pros::millis();
+    for (int phase = 0; phase < int(std::size(phases)); phase++) {
+        leftMotors.move_voltage(0);
+        rightMotors.move_voltage(0);
+        pros::Task::delay_until(&now, pause);
+        for (int time = 0; time < phases[phase].duration && count < maxSamples; time += period) {
+            const float voltage = phases[phase].start + phases[phase].rate * time / 1000;
+            leftMotors.move_voltage(voltage);
+            rightMotors.move_voltage(voltage);
+            samples[count++] = {{voltage, voltage},
+                                {driveDistance(leftMotors, model.inchesPerDegree()),
+                                 driveDistance(rightMotors, model.inchesPerDegree())},
+                                phase};
+            pros::Task::delay_until(&now, period);
+        }
+    }
+    leftMotors.move_voltage(0);
+    rightMotors.move_voltage(0);
+
+    Characterization result;
+    int rightSamples = 0;
+    result.left = fit(count, 0, result.leftFit, result.samples);
+    result.right = fit(count, 1, result.rightFit, rightSamples);
+    result.samples = std::min(result.samples, rightSamples);
+    result.valid = result.samples >= minSamples && plausible(result.left) && plausible(result.right);
+    textLog().post("Characterized: left kS %.0f kV %.1f kA %.1f, r^2 %.3f", result.left.kS, result.left.kV,
+                   result.left.kA, result.leftFit);
+    textLog().post("Characterized: right kS %.0f kV %.1f kA %.1f, r^2 %.3f%s", result.right.kS, result.right.kV,
+                   result.right.kA, result.rightFit, result.valid ? "" : ", not usable");
+    return result;
+}
+
+bool saveCharacterization(const char* name, const Characterization& fit) {
+    if (!fit.valid) return false;
+    std::FILE* file = std::fopen(name, "w");
+    if (file == nullptr) return false;
+    std::fprintf(file, "# kS mV, kV mV per in/s, kA mV per in/s^2, fitted from %d samples, r^2 %.3f and %.3f\n",
+                 fit.samples, fit.leftFit, fit.rightFit);
+    std::fprintf(file, "left %.1f %.2f %.2f\n", fit.left.kS, fit.left.kV, fit.left.kA);
+    std::fprintf(file, "right %.1f %.2f %.2f\n", fit.right.kS, fit.right.kV, fit.right.kA);
+    return std::fclose(file) == 0;
+}
+
+bool loadCharacterization(const char* name, DriveModel& model) {
+    std::FILE* file = std::fopen(name, "r");
+    if (file == nullptr) return false;
+    Feedforward left {}, right {};
+    bool haveLeft = false, haveRight = false;
+    char line[128];
+    while (std::fgets(line, sizeof(line), file) != nullptr) {
+        Feedforward gains;
+        char side[8];
+        if (std::sscanf(line, "%7s %f %f %f", side, &gains.kS, &gains.kV, &gains.kA) != 4) continue;
+        if (!std::strcmp(side, "left")) {
+            left = gains;
+            haveLeft = true;
+        } else if (!std::strcmp(side, "right")) {
+            right = gains;
+            haveRight = true;
+        }
+    }
+    std::fclose(file);
+    if (!haveLeft || !haveRight || !plausible(left) || !plausible(right)) return false;
+    model.setSides(left, right);
+    return true;
+}
+
+} // namespace spf
@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include "lemlib/api.hpp"
+#include "pros/rtos.hpp"
+#include "spf/driverInput.hpp"
+#include "spf/textLog.hpp"
+
+namespace spf {
+
+DriverInput::DriverInput(pros::Controller& controller, const SeqLock<RobotState>& state)
+    : controller(controller),
+      state(state) {}
+
+bool DriverInput::record(const char* prefix) { return log.open(prefix); }
+
+bool DriverInput::replay(const char* path) {
+    std::FILE* file = std::fopen(path, "rb");
+    if (file == nullptr) return false;
+    InputHeader header;
+    const bool ok = std::fread(&header, sizeof(header), 1, file) == 1 &&
+                    std::memcmp(header.magic, InputHeader().magic, 4) == 0 && header.version == 1 &&
+                    header.recordSize == sizeof(InputRecord);
+    recording.clear();
+    InputRecord record;
+    while (ok && std::fread(&record, sizeof(record), 1, file) == 1) recording.push_back(record);
+    std::fclose(file);
+    next = 0;
+    started = false;
+    maxError = 0;
+    replaying = !recording.empty();
+    return replaying;
+}
+
+int DriverInput::replayRoute() const {
+    for (const InputRecord& record : recording) {
+        if (record.mode == InputMode::Autonomous) return record.route;
+    }
+    return 0;
+}
+
+void DriverInput::setMode(InputMode mode, int route) {
+    this->route.store(route, std::memory_order_relaxed);
+    this->mode.store(mode, std::memory_order_relaxed);
+}
+
+void DriverInput::update() {
+    const RobotState robot = state.read();
+    InputRecord record {};
+    record.time = pros::millis();
+    record.mode = mode.load(std::memory_order_relaxed);
+    record.route = record.mode == InputMode::Autonomous ? route.load(std::memory_order_relaxed) : 0;
+    record.battery = pros::battery::get_voltage();
+    record.x = robot.x;
+    record.y = robot.y;
+    record.theta = robot.theta;
+    for (int i = 0; i < 4; i++) record.axes[i] = controller.get_analog(pros::controller_analog_e_t(i));
+    for (int i = 0; i < buttons; i++) {
+        if (controller.get_digital(pros::controller_digital_e_t(pros::E_CONTROLLER_DIGITAL_L1 + i))) {
+            record.held |= 1 << i;
+        }
+    }
+
+    if (replaying && record.mode == InputMode::Driver) {
+        // the recording lines up with the start of driver control, and the replay ends with it
+        if (!started) {
+            while (next < recording.size() && recording[next].mode != InputMode::Driver) next++;
+            started = true;
+        }
+        const bool takenOver = std::any_of(std::begin(record.axes), std::end(record.axes),
+                                           [](std::int8_t axis) { return std::abs(axis) > takeOver; });
+        if (takenOver || next >= recording.size() || recording[next].mode != InputMode::Driver) {
+            replaying = false;
+            textLog().post("Replay %s, at worst %.2f in from the recorded pose",
+                           takenOver ? "taken over by the driver" : "finished", maxError);
+        } else {
+            const InputRecord& recorded = recording[next++];
+            std::copy(std::begin(recorded.axes), std::end(recorded.axes), std::begin(record.axes));
+            record.held = recorded.held;
+            maxError = std::max(maxError, std::hypot(recorded.x - robot.x, recorded.y - robot.y));
+        }
+    }
+
+    record.pressed = record.held & ~previousHeld;
+    previousHeld = record.held;
+    sample.publish(record);
+    log.push(record);
+}
+
+int DriverInput::analog(pros::controller_analog_e_t axis) const { return sample.read().axes[axis]; }
+
+bool DriverInput::held(pros::controller_digital_e_t button) const {
+    return sample.read().held >> (button - pros::E_CONTROLLER_DIGITAL_L1) & 1;
+}
+
+bool DriverInput::newPress(pros::controller_digital_e_t button) {
+    const int i = button - pros::E_CONTROLLER_DIGITAL_L1;
+    if (i < 0 || i >= buttons) return false;
+    const std::uint32_t version = sample.version();
+    if (!(sample.read().pressed >> i & 1) || consumed[i] == version) return false;
+    consumed[i] = version;
+    return true;
+}
+
+} // namespace spf
@@ -0,0 +1,226 @@
+#include <algorithm>
+#include <cmath>
+
+#include "spf/field.hpp"
+#include "spf/fieldMap.hpp"
+#include "spf/pathFile.hpp"
+
+namespace spf {
+
+namespace {
+
+using field::barrierHalfLength;
+using field::barrierHalfWidth;
+using field::goalDepth;
+using field::goalHalfWidth;
+using field::perimeter;
+using field::tile;
+
+const lv_color_t tileColor = LV_COLOR_MAKE(60, 60, 60);
+const lv_color_t seamColor = LV_COLOR_MAKE(80, 80, 80);
+const lv_color_t wallColor = LV_COLOR_MAKE(200, 200, 200);
+const lv_color_t redGoal = LV_COLOR_MAKE(200, 40, 40);
+const lv_color_t blueGoal = LV_COLOR_MAKE(40, 80, 220);
+const lv_color_t planColor = LV_COLOR_MAKE(230, 200, 0);
+const lv_color_t trailColor = LV_COLOR_MAKE(0, 230, 0);
+const lv_color_t robotColor = LV_COLOR_WHITE;
+const lv_color_t frontColor = LV_COLOR_MAKE(0, 200, 255);
+
+// px the robot has to move, or degrees turn, before it's drawn again
+constexpr float minMove = 0.5;
+constexpr float minTurn = 2;
+// the trail gets a segment once the robot is a pixel from its end. A jump further than this is
+// the pose being set, not driving, and starts the trail over from there
+constexpr float trailStep = 1; // px
+constexpr float maxJump = 12 * FieldMap::scale; // px
+
+float toColumn(float x) { return (x + perimeter) * FieldMap::scale; }
+float toRow(float y) { return (perimeter - y) * FieldMap::scale; }
+
+void plot(std::array<lv_color_t, FieldMap::size * FieldMap::size>& layer, int x, int y, lv_color_t color) {
+    if (x < 0 || y < 0 || x >= FieldMap::size || y >= FieldMap::size) return;
+    layer[y * FieldMap::size + x] = color;
+}
+
+void line(std::array<lv_color_t, FieldMap::size * FieldMap::size>& layer, float x0, float y0, float x1, float y1,
+          lv_color_t color) {
+    const int steps = std::max(1, int(std::ceil(std::max(std::fabs(x1 - x0), std::fabs(y1 - y0)))));
+    for (int i = 0; i <= steps; i++) {
+        plot(layer, std::lround(x0 + (x1 - x0) * i / steps), std::lround(y0 + (y1 - y0) * i / steps), color);
+    }
+}
+
+/** a rectangle of the field, in inches, outlined or filled */
+void rectangle(std::array<lv_color_t, FieldMap::size * FieldMap::size>& layer, float x1, float y1, float x2, float y2,
+               lv_color_t color, bool filled) {
+    const int left = std::lround(toColumn(x1)), right = std::lround(toColumn(x2)) - 1;
+    const int top = std::lround(toRow(y2)), bottom = std::lround(toRow(y1)) - 1;
+    for (int row = top; row <= bottom; row++) {
+        for (int column = left; column <= right; column++) {
+            if (filled || row == top || row == bottom || column == left || column == right) {
+                plot(layer, column, row, color);
+            }
+        }
+    }
+}
+
+} // namespace
+
+void FieldMap::attach(lv_obj_t* parent, lv_coord_t x, lv_coord_t y) {
+    object = lv_canvas_create(parent, nullptr);
+    lv_canvas_set_buffer(object, buffer.data(), size, size, LV_IMG_CF_TRUE_COLOR);
+    lv_obj_set_pos(object, x, y);
+    screenX = x;
+    screenY = y;
+    setHidden(true);
+}
+
+void FieldMap::setHidden(bool hidden) {
+    if (object != nullptr) lv_obj_set_hidden(object, hidden);
+    this->hidden.store(hidden, std::memory_order_relaxed);
+}
+
+void FieldMap::clearPlan() {
+    routeCount = 0;
+    fieldStale = true;
+}
+
+void FieldMap::plan(const Route& route) {
+    if (routeCount == maxRoutes) return;
+    routes[routeCount++] = &route;
+    fieldStale = true;
+}
+
+void FieldMap::renderField() {
+    field.fill(tileColor);
+    for (float seam = -perimeter + tile; seam < perimeter; seam += tile) {
+        line(field, toColumn(seam), 0, toColumn(seam), size - 1, seamColor);
+        line(field, 0, toRow(seam), size - 1, toRow(seam), seamColor);
+    }
+    rectangle(field, -perimeter, -perimeter, perimeter, perimeter, wallColor, false);
+    rectangle(field, -perimeter, -goalHalfWidth, -perimeter + goalDepth, goalHalfWidth, redGoal, false);
+    rectangle(field, perimeter - goalDepth, -goalHalfWidth, perimeter, goalHalfWidth, blueGoal, false);
+    rectangle(field, -barrierHalfWidth, -barrierHalfLength, barrierHalfWidth, barrierHalfLength, wallColor, true);
+    for (std::size_t i = 0; i < routeCount; i++) drawRoute(*routes[i]);
+}
+
+void FieldMap::drawRoute(const Route& route) {
+    if (!route.isCompiled()) return;
+    // a line from one point to the next, skipping points less than a pixel along
+    bool started = false;
+    float lastX = 0, lastY = 0;
+    auto extend = [&](float x, float y) {
+        const float column = toColumn(x), row = toRow(y);
+        if (!started) {
+            started = true;
+        } else if (std::hypot(column - lastX, row - lastY) >= 1) {
+            line(field, lastX, lastY, column, row, planColor);
+        } else {
+            return;
+        }
+        lastX = column;
+        lastY = row;
+    };
+    for (const Segment& segment : route.segments) {
+        if (segment.kind == Segment::Kind::Profile) {
+            for (const ProfileSample& sample : segment.profile.samples) extend(sample.x, sample.y);
+        } else if (segment.kind == Segment::Kind::Step && segment.step.type == StepType::Follow &&
+                   segment.step.path != nullptr) {
+            const PathFile path(segment.step.path->buf, segment.step.path->size);
+            for (std::size_t i = 0; i < path.size(); i++) extend(path.at(i).x, path.at(i).y);
+        } else if (segment.kind == Segment::Kind::Step && segment.step.type == StepType::SetPose) {
+            // the route starts over from somewhere else
+            started = false;
+        }
+    }
+}
+
+void FieldMap::drawRobot(float x, float y, float theta) {
+    const float heading = lemlib::degToRad(theta);
+    // ahead and to the right of the robot, in screen pixels, where rows go down the screen
+    const float aheadX = std::sin(heading) * robotHalfSize * scale, aheadY = -std::cos(heading) * robotHalfSize * scale;
+    const float rightX = -aheadY, rightY = aheadX;
+    const float cornerX[4] = {x + aheadX - rightX, x + aheadX + rightX, x - aheadX + rightX, x - aheadX - rightX};
+    const float cornerY[4] = {y + aheadY - rightY, y + aheadY + rightY, y - aheadY + rightY, y - aheadY - rightY};
+    for (int i = 0; i < 4; i++) {
+        const int next = (i + 1) % 4;
+        line(buffer, cornerX[i], cornerY[i], cornerX[next], cornerY[next], i == 0 ? frontColor : robotColor);
+    }
+    line(buffer, x, y, x + aheadX, y + aheadY, frontColor);
+
+    const float reach = robotHalfSize * scale * std::sqrt(2.0f) + 1;
+    robot = {lv_coord_t(std::max(0.0f, std::floor(x - reach))), lv_coord_t(std::max(0.0f, std::floor(y - reach))),
+             lv_coord_t(std::min(size - 1.0f, std::ceil(x + reach))),
+             lv_coord_t(std::min(size - 1.0f, std::ceil(y + reach)))};
+}
+
+void FieldMap::restore(const Box& box) {
+    for (lv_coord_t row = box.y1; row <= box.y2 && box.x2 >= box.x1; row++) {
+        const std::size_t start = row * size + box.x1;
+        std::copy_n(background.begin() + start, box.x2 - box.x1 + 1, buffer.begin() + start);
+    }
+}
+
+void FieldMap::invalidate(const Box& box) {
+    if (box.x2 < box.x1 || box.y2 < box.y1) return;
+    invalidated.fetch_add((box.x2 - box.x1 + 1) * (box.y2 - box.y1 + 1), std::memory_order_relaxed);
+    if (hidden.load(std::memory_order_relaxed)) return;
+    const lv_area_t area = {lv_coord_t(screenX + box.x1), lv_coord_t(screenY + box.y1), lv_coord_t(screenX + box.x2),
+                            lv_coord_t(screenY + box.y2)};
+    lv_inv_area(&area);
+}
+
+void FieldMap::update(float x, float y, float theta) {
+    if (object == nullptr) return;
+    const Box whole = {0, 0, size - 1, size - 1};
+    const bool cleared = clearRequested.exchange(false, std::memory_order_relaxed);
+    if (fieldStale || cleared) {
+        // a new plan or a new run, everything is drawn over again
+        if (fieldStale) renderField();
+        fieldStale = false;
+        background = field;
+        buffer = background;
+        placed = false;
+        trailStarted = false;
+        invalidate(whole);
+    }
+
+    const float column = toColumn(x), row = toRow(y);
+    if (placed && std::fabs(column - shownX) < minMove && std::fabs(row - shownY) < minMove &&
+        std::fabs(std::remainder(theta - shownTheta, 360.0f)) < minTurn) {
+        return;
+    }
+
+    // the trail goes into the layer under the robot
+    Box segment = {1, 1, 0, 0};
+    const float along = std::hypot(column - trailX, row - trailY);
+    if (!trailStarted || along > maxJump) {
+        trailStarted = true;
+        trailX = column;
+        trailY = row;
+    } else if (along >= trailStep) {
+        line(background, trailX, trailY, column, row, trailColor);
+        segment = {lv_coord_t(std::max(0L, std::lround(std::min(trailX, column)))),
+                   lv_coord_t(std::max(0L, std::lround(std::min(trailY, row)))),
+                   lv_coord_t(std::min(long(size - 1), std::lround(std::max(trailX, column)))),
+                   lv_coord_t(std::min(long(size - 1), std::lround(std::max(trailY, row))))};
+        trailX = column;
+        trailY = row;
+    }
+
+    // put back what was under the robot, and the new piece of trail, then draw it where it is now
+    const Box previous = robot;
+    if (placed) restore(previous);
+    restore(segment);
+    drawRobot(column, row, theta);
+    if (placed) invalidate(previous);
+    invalidate(segment);
+    invalidate(robot);
+    placed = true;
+    shownX = column;
+    shownY = row;
+    shownTheta = theta;
+    drawn.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace spf
@@ -0,0 +1,175 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "lemlib/api.hpp"
+#include "spf/health.hpp"
+#include "spf/textLog.hpp"
+
+namespace spf {
+
+namespace {
+
+// the firmware halves the current at 55 C. Aim a degree under, the estimate isn't exact
+constexpr float throttleTemperature = 55;
+constexpr float targetTemperature = 54;
+// how fast the derating moves, in fractions of the full current per second
+constexpr float derateRate = 0.05;
+constexpr float recoverRate = 0.02;
+// never derate below this, the robot still has to be able to push
+constexpr float minLimit = 0.4;
+// time constant of the recent load the predictions assume, in seconds
+constexpr float loadTime = 10;
+// spread of the temperature change between two steps, C^2. The step is exact, but the sample
+// catching it is up to one period late
+constexpr float stepNoise = 0.25;
+constexpr float fullCurrent = 2500; // mA
+
+constexpr float infinity = std::numeric_limits<float>::infinity();
+
+} // namespace
+
+// thermal model
+
+void ThermalModel::reset(float ambient) {
+    this->ambient = ambient;
+    estimate = ambient;
+    lastReported = -1;
+    anchored = false;
+    heatSum = 0;
+    coolSum = 0;
+    // start out trusting the default coefficients to within about half
+    covariance = {heating * heating / 4, 0, 0, cooling * cooling / 4};
+}
+
+void ThermalModel::update(float reported, float current, float dt) {
+    if (lastReported < 0) {
+        lastReported = reported;
+        estimate = std::max(ambient, reported + 2.5f);
+    }
+    estimate += (heating * current * current - cooling * (estimate - ambient)) * dt;
+    heatSum += current * current * dt;
+    coolSum += (estimate - ambient) * dt;
+
+    if (reported != lastReported) {
+        // the reading just crossed a step, so the temperature is right on it
+        const float known = std::max(reported, lastReported);
+        if (anchored) fit(known - anchor - (heating * heatSum - cooling * coolSum));
+        estimate = known;
+        anchor = known;
+        anchored = true;
+        heatSum = 0;
+        coolSum = 0;
+        lastReported = reported;
+    }
+    // between steps the reading bounds the estimate
+    estimate = std::clamp(estimate, reported, reported + 4.99f);
+}
+
+void ThermalModel::fit(float error) {
+    // recursive least squares: the change between two steps is heating * heatSum - cooling * coolSum,
+    // and error is how far the model was off
+    const float x0 = heatSum, x1 = -coolSum;
+    const float px0 = covariance[0] * x0 + covariance[1] * x1;
+    const float px1 = covariance[2] * x0 + covariance[3] * x1;
+    const float gain = 1 / (stepNoise + x0 * px0 + x1 * px1);
+    const float k0 = px0 * gain, k1 = px1 * gain;
+    heating = std::clamp(heating + k0 * error, 0.02f, 0.3f);
+    cooling = std::clamp(cooling + k1 * error, 0.001f, 0.02f);
+    covariance = {covariance[0] - k0 * px0, covariance[1] - k0 * px1, covariance[2] - k1 * px0,
+                  covariance[3] - k1 * px1};
+}
+
+float ThermalModel::timeTo(float target, float currentSquared) const {
+    if (estimate >= target) return 0;
+    const float steady = ambient + heating * currentSquared / cooling;
+    if (steady <= target) return infinity;
+    return -std::log((steady - target) / (steady - estimate)) / cooling;
+}
+
+float ThermalModel::currentSquaredFor(float target, float time) const {
+    // the steady temperature whose exponential approach passes target at time
+    const float decay = std::exp(-cooling * time);
+    const float steady = (target - estimate * decay) / (1 - decay);
+    return std::max(0.0f, cooling * (steady - ambient) / heating);
+}
+
+// health monitor
+
+HealthMonitor::HealthMonitor(const std::array<pros::Motor*, 8>& motors, pros::MotorGroup& leftMotors,
+                             pros::MotorGroup& rightMotors)
+    : motors(motors),
+      leftMotors(leftMotors),
+      rightMotors(rightMotors) {}
+
+void HealthMonitor::startRun(std::uint32_t duration) { runEnd.store(pros::millis() + duration); }
+
+void HealthMonitor::endRun() { runEnd.store(0); }
+
+void HealthMonitor::update() {
+    const std::uint32_t now = pros::millis();
+    HealthStatus status;
+    if (!started) {
+        // the motors start out cold, at room temperature
+        float ambient = 0;
+        for (pros::Motor* motor : motors) ambient += motor->get_temperature() + 2.5f;
+        ambient = std::min(ambient / motors.size(), 30.0f);
+        for (ThermalModel& model : models) model.reset(ambient);
+        started = true;
+        lastUpdate = now;
+    }
+    const float dt = (now - lastUpdate) / 1000.0f;
+    lastUpdate = now;
+
+    // how much current each motor could average and still only reach the target at the end of the run
+    const std::uint32_t end = runEnd.load();
+    const float remaining = end > now ? (end - now) / 1000.0f : 0;
+    float scale = infinity;
+    status.timeToThrottle = infinity;
+    for (std::size_t i = 0; i < motors.size(); i++) {
+        MotorStatus& motor = status.motors[i];
+        motor.reported = motors[i]->get_temperature();
+        motor.current = std::fabs(motors[i]->get_current_draw()) / 1000.0f;
+        motor.power = motors[i]->get_power();
+        motor.efficiency = motors[i]->get_efficiency();
+
+        ThermalModel& model = models[i];
+        model.update(motor.reported, motor.current, dt);
+        currentSquared[i] += (motor.current * motor.current - currentSquared[i]) * std::min(1.0f, dt / loadTime);
+        motor.temperature = model.temperature();
+        motor.timeToThrottle = model.timeTo(throttleTemperature, currentSquared[i]);
+        status.maxTemperature = std::max(status.maxTemperature, motor.temperature);
+        status.timeToThrottle = std::min(status.timeToThrottle, motor.timeToThrottle);
+
+        if (remaining > 0 && currentSquared[i] > 0) {
+            scale = std::min(scale, std::sqrt(model.currentSquaredFor(targetTemperature, remaining) / currentSquared[i]));
+        }
+    }
+
+    // the recent load was drawn under the current limit, so heat scales with the limit squared.
+    // Move towards the new limit slowly enough that the driver feels a fade, not a step
+    if (remaining > 0) {
+        const float target = std::clamp(limit * scale, minLimit, 1.0f);
+        limit = std::clamp(target, limit - derateRate * dt, limit + recoverRate * dt);
+    } else {
+        limit = 1;
+    }
+    applyLimit(limit);
+    status.currentLimit = limit;
+    published.publish(status);
+}
+
+void HealthMonitor::applyLimit(float limit) {
+    // limits are whole milliamps, and only worth sending when they change
+    const int milliamps = std::lround(limit * fullCurrent);
+    if (milliamps == appliedLimit) return;
+    if ((milliamps < fullCurrent) != (appliedLimit < fullCurrent)) {
+        if (milliamps < fullCurrent) textLog().post("Derating the drive to stay under %.0f C", throttleTemperature);
+        else textLog().post("Drive back to full current");
+    }
+    leftMotors.set_current_limit(milliamps);
+    rightMotors.set_current_limit(milliamps);
+    appliedLimit = milliamps;
+}
+
+} // namespace spf
@@ -0,0 +1,80 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#include "lemlib/api.hpp"
+#include "pros/rtos.hpp"
+#include "spf/heap.hpp"
+
+namespace spf {
+
+namespace {
+
+std::atomic<bool> armed {false};
+std::atomic<std::uint32_t> allocations {0};
+std::atomic<std::uint32_t> bytes {0};
+std::atomic<std::uint32_t> sites {0};
+HeapSite site[HeapStats::maxSites];
+// set while a site is being recorded, so looking up the task can't count itself
+std::atomic<bool> recording {false};
+
+void count(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    bytes.fetch_add(size, std::memory_order_relaxed);
+    if (recording.exchange(true, std::memory_order_acquire)) return;
+    const char* task = pros::Task::current().get_name();
+    const std::uint32_t count = sites.load(std::memory_order_relaxed);
+    std::uint32_t index = 0;
+    while (index < count && site[index].task != task) index++;
+    if (index == count && count < HeapStats::maxSites) {
+        site[index] = {task, 0, 0, pros::millis()};
+        sites.store(count + 1, std::memory_order_relaxed);
+    }
+    if (index < HeapStats::maxSites) {
+        site[index].allocations++;
+        site[index].bytes += size;
+    }
+    recording.store(false, std::memory_order_release);
+}
+
+} // namespace
+
+void armHeapGuard() { armed = true; }
+
+HeapStats heapStats() {
+    HeapStats stats;
+    stats.allocations = allocations;
+    stats.bytes = bytes;
+    stats.sites = sites;
+    for (std::uint32_t i = 0; i < stats.sites; i++) stats.site[i] = site[i];
+    return stats;
+}
+
+void dumpHeap(std::FILE* file, const HeapStats& stats) {
+    char line[128];
+    std::snprintf(line, sizeof(line), "heap: %lu allocations, %lu bytes since the match started",
+                  (unsigned long)stats.allocations, (unsigned long)stats.bytes);
+    lemlib::telemetrySink()->info("{}", std::string(line));
+    if (file != nullptr) std::fprintf(file, "%s\n", line);
+    for (std::uint32_t i = 0; i < stats.sites; i++) {
+        std::snprintf(line, sizeof(line), "  %s: %lu allocations, %lu bytes, the first at %lu ms", stats.site[i].task,
+                      (unsigned long)stats.site[i].allocations, (unsigned long)stats.site[i].bytes,
+                      (unsigned long)stats.site[i].first);
+        lemlib::telemetrySink()->info("{}", std::string(line));
+        if (file != nullptr) std::fprintf(file, "%s\n", line);
+    }
+}
+
+} // namespace spf
+
+// the array, nothrow and sized forms all end up here
+void* operator new(std::size_t size) {
+    if (spf::armed.load(std::memory_order_relaxed)) spf::count(size);
+    if (void* memory = std::malloc(size == 0 ? 1 : size)) return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
@@ -0,0 +1,276 @@
+#include <algorithm>
+#include <cmath>
+
+#include "spf/field.hpp"
+#include "spf/odometry.hpp"
+#include "spf/textLog.hpp"
+
+namespace spf {
+
+namespace {
+
+// variances the filter assumes, per update
+constexpr float trackerNoise = 1e-4; // in^2 per inch travelled, along the wheels
+constexpr float lateralNoise = 0.02; // in^2 per inch travelled, sideways through the omni rollers, which nothing measures
+constexpr float slipLateralNoise = 0.05; // in^2 per inch of slip, a spinning drive also skids sideways
+constexpr float scrub = 0.03; // tracking wheel heading error as a fraction of the turn
+constexpr float driveNoise = 0.01; // in^2 per inch, drive encoders standing in for the tracking wheels
+constexpr float imuNoise = 1.2e-5; // rad^2, about 0.2 degrees
+// how well a route's setPose knows where the robot was put down, in^2, about half an inch
+constexpr float placementNoise = 0.25;
+// a wall distance more standard deviations than this from where the pose puts the wall is
+// something else in the way, squared
+constexpr float rangeGate = 9;
+// a beam closer to running along the wall than this, as a cosine, gives away little and
+// depends a lot on the heading
+constexpr float minFacing = 0.3;
+// a tracking wheel moving further than this in one update is a bad reading, in
+constexpr float maxStep = 3;
+// slip is flagged when the drive wheels run this much faster or slower than the ground
+constexpr float slipThreshold = 4; // in/s
+constexpr float slipFraction = 0.15; // of the speed
+constexpr float slipSmoothing = 0.15; // per update
+// IMU calibrations tried before going without it, like LemLib, and how long one may take
+constexpr int imuAttempts = 5;
+constexpr std::uint32_t imuTimeout = 3000; // ms, calibration normally takes about 2 s
+
+constexpr float radToDeg = 180 / M_PI;
+
+} // namespace
+
+float driveDistance(pros::MotorGroup& motors, float inchesPerDegree) {
+    // the drive encoders as tracking wheels at each side, the same way LemLib uses them: the
+    // average of the motors, scaled from the motor to the wheels
+    float total = 0;
+    for (int i = 0; i < motors.size(); i++) total += motors[i].get_position();
+    return motors.size() > 0 ? total * inchesPerDegree / motors.size() : 0;
+}
+
+float driveVelocity(pros::MotorGroup& motors, float inchesPerDegree) {
+    // rpm is 6 degrees a second
+    float total = 0;
+    for (int i = 0; i < motors.size(); i++) total += motors[i].get_actual_velocity();
+    return motors.size() > 0 ? total * inchesPerDegree * 6 / motors.size() : 0;
+}
+
+Odometry::Odometry(lemlib::Chassis& chassis, const lemlib::Drivetrain& drivetrain, float inchesPerDegree,
+                   lemlib::TrackingWheel& tracker1, lemlib::TrackingWheel& tracker2, pros::Imu& imu, float driftTime,
+                   float halfLength)
+    : chassis(chassis),
+      tracker1(tracker1),
+      tracker2(tracker2),
+      leftDrive(*drivetrain.leftMotors),
+      rightDrive(*drivetrain.rightMotors),
+      inchesPerDegree(inchesPerDegree),
+      halfTrack(drivetrain.trackWidth / 2),
+      imu(imu),
+      driftTime(driftTime),
+      wall(field::perimeter - halfLength) {}
+
+void Odometry::calibrate() {
+    // calibrate the imu the way LemLib does: a missing or failed IMU reports an error status, or
+    // a heading that isn't a number, so retry a few times and then do without it
+    imuOk = false;
+    for (int attempt = 1; attempt <= imuAttempts && !imuOk; attempt++) {
+        imu.reset();
+        const std::uint32_t start = pros::millis();
+        do pros::delay(10);
+        while (imu.get_status() != pros::ImuStatus::error && imu.is_calibrating() &&
+               pros::millis() - start < imuTimeout);
+        imuOk = !imu.is_calibrating() && std::isfinite(imu.get_heading());
+        if (!imuOk) textLog().post("IMU failed to calibrate, attempt %d", attempt);
+    }
+    if (imuOk) imu.set_data_rate(period);
+    else textLog().post("No IMU, heading from the tracking wheels");
+    tracker1.reset();
+    tracker2.reset();
+    leftDrive.tare_position();
+    rightDrive.tare_position();
+    previous = {0, 0, 0, 0};
+    reset(chassis.getPose(true));
+    lastUpdate = pros::millis();
+    calibrated = true;
+}
+
+void Odometry::reset(const lemlib::Pose& to) {
+    pose = to;
+    written = to;
+    covariance = {};
+    covariance[0] = covariance[4] = placementNoise;
+    imuOffset = imuOk ? to.theta - lemlib::degToRad(imu.get_rotation()) : 0;
+    // wall distances matched against the pose before it moved
+    std::array<RangeFix, decltype(fixes)::capacity()> stale;
+    while (fixes.pop(stale.data(), stale.size()) > 0) {}
+}
+
+void Odometry::update() {
+    if (!calibrated) return;
+    // a setPose from a route or LemLib since the last update
+    const lemlib::Pose current = chassis.getPose(true);
+    if (std::fabs(current.x - written.x) > 1e-4 || std::fabs(current.y - written.y) > 1e-4 ||
+        std::fabs(current.theta - written.theta) > 1e-6) {
+        reset(current);
+    }
+
+    const std::uint32_t now = pros::millis();
+    const float dt = std::max(now - lastUpdate, std::uint32_t(1)) / 1000.0f;
+    lastUpdate = now;
+
+    const std::array<float, 4> reading = {tracker1.getDistanceTraveled(), tracker2.getDistanceTraveled(),
+                                          driveDistance(leftDrive, inchesPerDegree),
+                                          driveDistance(rightDrive, inchesPerDegree)};
+    std::array<float, 4> delta;
+    for (std::size_t i = 0; i < delta.size(); i++) delta[i] = reading[i] - previous[i];
+    previous = reading;
+    const float imuHeading = imuOk ? lemlib::degToRad(imu.get_rotation()) + imuOffset : pose.theta;
+
+    // a wheel at offset o (right is positive) rolls d - dTheta * o
+    const float offset1 = tracker1.getOffset(), offset2 = tracker2.getOffset();
+    const bool ok1 = std::isfinite(delta[0]) && std::fabs(delta[0]) < maxStep;
+    const bool ok2 = std::isfinite(delta[1]) && std::fabs(delta[1]) < maxStep;
+    const float driveDistance = (delta[2] + delta[3]) / 2;
+    float distance, turn, distanceNoise, turnNoise;
+    if (ok1 && ok2) {
+        turn = (delta[1] - delta[0]) / (offset1 - offset2);
+        distance = delta[0] + turn * offset1;
+        distanceNoise = trackerNoise * std::fabs(distance);
+        // scrub is a steady scale error rather than noise, so it adds up with the turn, not its square
+        turnNoise = scrub * scrub * std::fabs(turn);
+    } else {
+        // one wheel, or none, and the heading from the IMU alone, or the drive encoders without one
+        turn = imuOk ? lemlib::angleError(imuHeading, pose.theta, true) : (delta[2] - delta[3]) / (2 * halfTrack);
+        if (ok1) distance = delta[0] + turn * offset1;
+        else if (ok2) distance = delta[1] + turn * offset2;
+        else distance = driveDistance;
+        distanceNoise = (ok1 || ok2 ? trackerNoise : driveNoise) * std::fabs(distance);
+        turnNoise = imuOk ? imuNoise : driveNoise * std::fabs(turn);
+    }
+
+    // slip: how much faster the drive wheels turn than the ground goes by
+    slip += ((driveDistance - distance) / dt - slip) * slipSmoothing;
+    OdometryStatus status;
+    status.trackerFault = !(ok1 && ok2);
+    status.slip = slip;
+    status.slipping = !status.trackerFault && std::fabs(status.slip) > slipThreshold + slipFraction * std::fabs(distance / dt);
+    // each side against the ground under it, which moves with the turn, for traction control
+    for (int side = 0; side < 2; side++) {
+        const float ground = (distance + (side == 0 ? turn : -turn) * halfTrack) / dt;
+        sideSpeed[side] += (ground - sideSpeed[side]) * slipSmoothing;
+        sideSlip[side] += ((delta[2 + side] / dt - ground) - sideSlip[side]) * slipSmoothing;
+    }
+    status.leftSlip = sideSlip[0];
+    status.rightSlip = sideSlip[1];
+    status.leftSpeed = sideSpeed[0];
+    status.rightSpeed = sideSpeed[1];
+
+    // the omni rollers let the robot slide outwards in turns, until their sideways grip provides
+    // the centripetal force. The tracking wheels can't see that, so it is predicted
+    const float target = -driftTime * (distance / dt) * (turn / dt);
+    sideways += (target - sideways) * std::min(1.0f, dt / driftTime);
+    const float side = sideways * dt;
+
+    // predict along the arc
+    const float mid = pose.theta + turn / 2;
+    const float s = std::sin(mid), c = std::cos(mid);
+    pose.x += distance * s + side * c;
+    pose.y += distance * c - side * s;
+    pose.theta += turn;
+    // the walls stop a slide that the robot would otherwise make
+    if (std::fabs(pose.x) > wall || std::fabs(pose.y) > wall) {
+        pose.x = std::clamp(pose.x, -wall, wall);
+        pose.y = std::clamp(pose.y, -wall, wall);
+        sideways = 0;
+    }
+
+    // covariance: P = F P F^T + G Q G^T, with the noise in distance, sideways and turn
+    const float sideNoise =
+        lateralNoise * std::fabs(distance) + (status.slipping ? slipLateralNoise * std::fabs(status.slip * dt) : 0);
+    const std::array<float, 9> f = {1, 0, distance * c, 0, 1, -distance * s, 0, 0, 1};
+    const std::array<float, 9> g = {s, c, distance * c / 2, c, -s, -distance * s / 2, 0, 0, 1};
+    const std::array<float, 3> q = {distanceNoise, sideNoise, turnNoise};
+    std::array<float, 9> next {};
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            float sum = 0;
+            for (int k = 0; k < 3; k++) {
+                for (int l = 0; l < 3; l++) sum += f[i * 3 + k] * covariance[k * 3 + l] * f[j * 3 + l];
+                sum += g[i * 3 + k] * q[k] * g[j * 3 + k];
+            }
+            next[i * 3 + j] = sum;
+        }
+    }
+    covariance = next;
+
+    // correct the heading towards the IMU, if there is one
+    if (imuOk) {
+        const float innovation = lemlib::angleError(imuHeading, pose.theta, true);
+        const float gain = 1 / (covariance[8] + imuNoise);
+        const std::array<float, 3> k = {covariance[2] * gain, covariance[5] * gain, covariance[8] * gain};
+        pose.x += k[0] * innovation;
+        pose.y += k[1] * innovation;
+        pose.theta += k[2] * innovation;
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) next[i * 3 + j] = covariance[i * 3 + j] - k[i] * covariance[6 + j];
+        }
+        covariance = next;
+    }
+
+    // distances to the walls, measured since the last update
+    std::array<RangeFix, decltype(fixes)::capacity()> pending;
+    const std::size_t count = fixes.pop(pending.data(), pending.size());
+    for (std::size_t i = 0; i < count; i++) {
+        if (applyRange(pending[i])) rangeFixes++;
+        else rangeRejected++;
+    }
+
+    chassis.setPose(pose, true);
+    written = chassis.getPose(true);
+
+    status.x = pose.x;
+    status.y = pose.y;
+    status.theta = pose.theta * radToDeg;
+    status.varianceX = covariance[0];
+    status.varianceY = covariance[4];
+    status.varianceTheta = covariance[8] * radToDeg * radToDeg;
+    status.covarianceXY = covariance[1];
+    status.rangeFixes = rangeFixes;
+    status.rangeRejected = rangeRejected;
+    published.publish(status);
+}
+
+bool Odometry::applyRange(const RangeFix& fix) {
+    // where the beam starts and the way it goes
+    const float s = std::sin(pose.theta), c = std::cos(pose.theta);
+    const float fromX = pose.x + fix.forward * s + fix.right * c;
+    const float fromY = pose.y + fix.forward * c - fix.right * s;
+    const float beamX = std::sin(pose.theta + fix.angle), beamY = std::cos(pose.theta + fix.angle);
+    const float facing = fix.nx * beamX + fix.ny * beamY;
+    if (std::fabs(facing) < minFacing) return false;
+    const float predicted = (fix.c - fix.nx * fromX - fix.ny * fromY) / facing;
+    if (predicted <= 0) return false;
+
+    // how the distance changes with the pose: sliding towards the wall shortens it, and turning
+    // both moves the sensor and swings the beam
+    const float turnX = fix.forward * c - fix.right * s, turnY = -fix.forward * s - fix.right * c;
+    const std::array<float, 3> h = {
+        -fix.nx / facing, -fix.ny / facing,
+        -(fix.nx * turnX + fix.ny * turnY) / facing - predicted * (fix.nx * beamY - fix.ny * beamX) / facing};
+    std::array<float, 3> ph {}; // P h^T
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) ph[i] += covariance[i * 3 + j] * h[j];
+    }
+    const float variance = h[0] * ph[0] + h[1] * ph[1] + h[2] * ph[2] + fix.variance;
+    const float innovation = fix.distance - predicted;
+    if (innovation * innovation > rangeGate * variance) return false;
+
+    const std::array<float, 3> k = {ph[0] / variance, ph[1] / variance, ph[2] / variance};
+    pose.x += k[0] * innovation;
+    pose.y += k[1] * innovation;
+    pose.theta += k[2] * innovation;
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) covariance[i * 3 + j] -= k[i] * ph[j];
+    }
+    return true;
+}
+
+} // namespace spf
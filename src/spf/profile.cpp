@@ -0,0 +1,299 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "spf/profile.hpp"
+
+namespace spf {
+
+namespace {
+
+/** one control period of a 1d profile */
+struct Motion {
+        int index; // segment the motion is in, between positions[index] and positions[index + 1]
+        float distance;
+        float velocity;
+        float acceleration;
+};
+
+/**
+ * limit velocities by acceleration and deceleration, from rest to rest. shares, if there are any,
+ * are the fraction of them the middle of the robot gets at each position
+ */
+void limitAcceleration(const std::vector<float>& positions, std::vector<float>& limits, float acceleration,
+                       float deceleration, const std::vector<float>& shares = {}) {
+    const std::size_t n = positions.size();
+    auto share = [&](std::size_t i) { return shares.empty() ? 1.0f : std::min(shares[i - 1], shares[i]); };
+    limits.front() = 0;
+    limits.back() = 0;
+    // forward pass, acceleration limit
+    for (std::size_t i = 1; i < n; i++) {
+        const float ds = positions[i] - positions[i - 1];
+        limits[i] =
+            std::min(limits[i], std::sqrt(limits[i - 1] * limits[i - 1] + 2 * acceleration * share(i) * ds));
+    }
+    // backward pass, deceleration limit
+    for (std::size_t i = n - 1; i > 0; i--) {
+        const float ds = positions[i] - positions[i - 1];
+        limits[i - 1] = std::min(limits[i - 1], std::sqrt(limits[i] * limits[i] + 2 * deceleration * share(i) * ds));
+    }
+}
+
+/**
+ * Velocity limited by acceleration and deceleration along a set of positions, sampled every
+ * control period. The motion starts and ends at rest.
+ */
+std::vector<Motion> sampleMotion(const std::vector<float>& positions, std::vector<float> limits, float acceleration,
+                                 float deceleration, const std::vector<float>& shares = {}) {
+    const std::size_t n = positions.size();
+    limitAcceleration(positions, limits, acceleration, deceleration, shares);
+
+    // time at each position, with constant acceleration between positions
+    std::vector<float> times(n, 0);
+    for (std::size_t i = 1; i < n; i++) {
+        const float ds = positions[i] - positions[i - 1];
+        const float sum = limits[i - 1] + limits[i];
+        times[i] = times[i - 1] + (sum > 1e-6 ? 2 * ds / sum : 0);
+    }
+
+    std::vector<Motion> motion;
+    const float dt = Profile::period / 1000.0;
+    std::size_t i = 0;
+    for (int k = 0;; k++) {
+        const float t = k * dt;
+        while (i + 1 < n - 1 && times[i + 1] <= t) i++;
+        if (t >= times.back()) break;
+        const float span = times[i + 1] - times[i];
+        const float a = span > 0 ? (limits[i + 1] - limits[i]) / span : 0;
+        const float tau = std::clamp(t - times[i], 0.0f, span);
+        motion.push_back({int(i), positions[i] + limits[i] * tau + a * tau * tau / 2, limits[i] + a * tau, a});
+    }
+    motion.push_back({int(n - 2), positions.back(), 0, 0});
+    return motion;
+}
+
+/**
+ * distance of each point of a path, the fastest the robot may pass it, and the share of the
+ * acceleration limit it may speed up or slow down with there
+ */
+void pathLimits(const std::vector<PathPoint>& path, const DriveModel& model, std::vector<float>& positions,
+                std::vector<float>& limits, std::vector<float>& shares) {
+    positions.assign(path.size(), 0);
+    limits.resize(path.size());
+    shares.resize(path.size());
+    const float halfTrack = model.trackWidth / 2;
+    for (std::size_t i = 0; i < path.size(); i++) {
+        if (i > 0) positions[i] = positions[i - 1] + std::hypot(path[i].x - path[i - 1].x, path[i].y - path[i - 1].y);
+        const float curvature = std::fabs(path[i].curvature);
+        // on a curve the outside wheel speeds up by 1 + curvature * half track for every in/s the
+        // middle does, and it's the wheel that's limited
+        shares[i] = 1 / (1 + curvature * halfTrack);
+        float limit = std::min(path[i].speedLimit, model.maxVelocity() / (1 + curvature * halfTrack));
+        if (curvature > 1e-4) limit = std::min(limit, std::sqrt(model.maxLateralAcceleration / curvature));
+        limits[i] = limit;
+    }
+    // where the curvature changes the wheels have to speed up and slow down against each other,
+    // v^2 * dk/ds * half track is the extra acceleration each side sees
+    for (std::size_t i = 1; i < path.size(); i++) {
+        const float ds = positions[i] - positions[i - 1];
+        if (ds <= 0) continue;
+        const float change = std::fabs(path[i].curvature - path[i - 1].curvature) / ds * halfTrack;
+        if (change < 1e-6) continue;
+        const float limit = std::sqrt(model.maxAcceleration / change);
+        limits[i - 1] = std::min(limits[i - 1], limit);
+        limits[i] = std::min(limits[i], limit);
+    }
+}
+
+} // namespace
+
+// drive model
+
+DriveModel::DriveModel(float trackWidth, float wheelDiameter, float rpm, float cartridgeRpm, float speedHeadroom,
+                       float maxAcceleration, float maxDeceleration, float maxLateralAcceleration, float kS, float kV,
+                       float kA, float kATurn)
+    : trackWidth(trackWidth),
+      wheelDiameter(wheelDiameter),
+      rpm(rpm),
+      cartridgeRpm(cartridgeRpm),
+      speedHeadroom(speedHeadroom),
+      maxAcceleration(maxAcceleration),
+      maxDeceleration(maxDeceleration),
+      maxLateralAcceleration(maxLateralAcceleration),
+      kS(kS),
+      kV(kV),
+      kA(kA),
+      kATurn(kATurn),
+      left {kS, kV, kA},
+      right {kS, kV, kA} {}
+
+float DriveModel::freeSpeed() const { return wheelDiameter * M_PI * rpm / 60; }
+
+float DriveModel::maxVelocity() const { return freeSpeed() * speedHeadroom; }
+
+float DriveModel::inchesPerDegree() const { return inchesPerMotorDegree(wheelDiameter, rpm, cartridgeRpm); }
+
+void DriveModel::setSides(const Feedforward& left, const Feedforward& right) {
+    this->left = left;
+    this->right = right;
+    kS = (left.kS + right.kS) / 2;
+    kV = (left.kV + right.kV) / 2;
+    kA = (left.kA + right.kA) / 2;
+}
+
+float Feedforward::voltage(float velocity, float acceleration) const {
+    // static friction only once the side is meant to move
+    const float friction = std::fabs(velocity) > 0.1 ? std::copysign(kS, velocity) : 0;
+    return friction + kV * velocity + kA * acceleration;
+}
+
+// profile
+
+const ProfileSample& Profile::at(int time) const {
+    const std::size_t index = std::max(time, 0) / period;
+    return samples[std::min(index, samples.size() - 1)];
+}
+
+int Profile::timeAt(float distance) const {
+    // samples are in order of distance, so this is a binary search
+    const auto it = std::lower_bound(samples.begin(), samples.end(), distance,
+                                     [](const ProfileSample& sample, float d) { return sample.distance < d; });
+    return std::min<int>(it - samples.begin(), samples.size() - 1) * period;
+}
+
+int Profile::duration() const { return samples.empty() ? 0 : (samples.size() - 1) * period; }
+
+// paths
+
+std::vector<PathPoint> bezierPath(float x1, float y1, float theta1, float x2, float y2, float theta2, bool forwards,
+                                  float speedLimit, float wall, float spacing) {
+    // control points along the direction of travel at each end
+    const float h1 = (theta1 + (forwards ? 0 : 180)) * M_PI / 180;
+    const float h2 = (theta2 + (forwards ? 0 : 180)) * M_PI / 180;
+    const float d = std::hypot(x2 - x1, y2 - y1) * 0.4;
+    // the curve stays between its control points, so keeping them off the walls keeps the path off
+    // them too. An arm that would reach past a wall is cut short at it
+    auto arm = [&](float x, float y, float dx, float dy) {
+        float length = d;
+        if (dx > 1e-6) length = std::min(length, (wall - x) / dx);
+        if (dx < -1e-6) length = std::min(length, (-wall - x) / dx);
+        if (dy > 1e-6) length = std::min(length, (wall - y) / dy);
+        if (dy < -1e-6) length = std::min(length, (-wall - y) / dy);
+        return std::max(length, 0.0f);
+    };
+    const float d1 = arm(x1, y1, std::sin(h1), std::cos(h1));
+    const float d2 = arm(x2, y2, -std::sin(h2), -std::cos(h2));
+    const float px[4] = {x1, x1 + d1 * std::sin(h1), x2 - d2 * std::sin(h2), x2};
+    const float py[4] = {y1, y1 + d1 * std::cos(h1), y2 - d2 * std::cos(h2), y2};
+    auto point = [&](const float* p, float u) {
+        const float v = 1 - u;
+        return v * v * v * p[0] + 3 * v * v * u * p[1] + 3 * v * u * u * p[2] + u * u * u * p[3];
+    };
+    auto first = [&](const float* p, float u) {
+        const float v = 1 - u;
+        return 3 * v * v * (p[1] - p[0]) + 6 * v * u * (p[2] - p[1]) + 3 * u * u * (p[3] - p[2]);
+    };
+    auto second = [&](const float* p, float u) {
+        return 6 * (1 - u) * (p[2] - 2 * p[1] + p[0]) + 6 * u * (p[3] - 2 * p[2] + p[1]);
+    };
+
+    // arc length table, then points at even distances along it
+    const int steps = std::max(32, int(d * 40));
+    std::vector<float> lengths(steps + 1, 0);
+    for (int i = 1; i <= steps; i++) {
+        const float u0 = float(i - 1) / steps;
+        const float u1 = float(i) / steps;
+        lengths[i] = lengths[i - 1] + std::hypot(point(px, u1) - point(px, u0), point(py, u1) - point(py, u0));
+    }
+    const int count = std::max(1, int(std::round(lengths.back() / spacing)));
+    std::vector<PathPoint> path;
+    path.reserve(count + 1);
+    int j = 0;
+    for (int i = 0; i <= count; i++) {
+        const float s = lengths.back() * i / count;
+        while (j < steps - 1 && lengths[j + 1] < s) j++;
+        const float span = lengths[j + 1] - lengths[j];
+        const float u = (j + (span > 0 ? (s - lengths[j]) / span : 0)) / steps;
+        const float dx = first(px, u);
+        const float dy = first(py, u);
+        const float speed = std::hypot(dx, dy);
+        // the standard curvature is counterclockwise positive
+        const float curvature = speed > 1e-6 ? -(dx * second(py, u) - dy * second(px, u)) / (speed * speed * speed) : 0;
+        // an arm cut to nothing leaves the curve no direction at that end, so it keeps the end's heading
+        const float heading = speed > 1e-6 ? std::atan2(dx, dy) : u < 0.5 ? h1 : h2;
+        path.push_back({point(px, u), point(py, u), heading, curvature, speedLimit});
+    }
+    return path;
+}
+
+Profile timeOptimalProfile(const std::vector<PathPoint>& path, bool forwards, const DriveModel& model) {
+    Profile profile;
+    const float sign = forwards ? 1 : -1;
+    const float flip = forwards ? 0 : 180;
+    if (path.size() < 2) {
+        if (!path.empty()) {
+            const PathPoint& p = path.front();
+            profile.samples.push_back({p.x, p.y, float(p.heading * 180 / M_PI + flip), 0, 0, 0, 0, 0});
+        }
+        return profile;
+    }
+
+    std::vector<float> positions;
+    std::vector<float> limits;
+    std::vector<float> shares;
+    pathLimits(path, model, positions, limits, shares);
+    profile.length = positions.back();
+
+    const std::vector<Motion> motion =
+        sampleMotion(positions, limits, model.maxAcceleration, model.maxDeceleration, shares);
+    profile.samples.reserve(motion.size());
+    for (const Motion& m : motion) {
+        const PathPoint& a = path[m.index];
+        const PathPoint& b = path[m.index + 1];
+        const float ds = positions[m.index + 1] - positions[m.index];
+        const float t = ds > 0 ? (m.distance - positions[m.index]) / ds : 0;
+        const float heading = a.heading + std::remainder(b.heading - a.heading, 2 * M_PI) * t;
+        const float curvature = a.curvature + (b.curvature - a.curvature) * t;
+        const float dCurvature = ds > 0 ? (b.curvature - a.curvature) / ds : 0;
+        // the heading turns at velocity * curvature whichever way the robot faces
+        const float angularVelocity = m.velocity * curvature;
+        const float angularAcceleration = m.acceleration * curvature + m.velocity * m.velocity * dCurvature;
+        profile.samples.push_back({a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, float(heading * 180 / M_PI + flip),
+                                   m.distance, sign * m.velocity, sign * m.acceleration,
+                                   float(angularVelocity * 180 / M_PI), float(angularAcceleration * 180 / M_PI)});
+    }
+    return profile;
+}
+
+std::vector<float> pathVelocities(const std::vector<PathPoint>& path, const DriveModel& model) {
+    if (path.size() < 2) return std::vector<float>(path.size(), 0);
+    std::vector<float> positions;
+    std::vector<float> limits;
+    std::vector<float> shares;
+    pathLimits(path, model, positions, limits, shares);
+    limitAcceleration(positions, limits, model.maxAcceleration, model.maxDeceleration, shares);
+    return limits;
+}
+
+Profile turnProfile(float x, float y, float from, float to, float speedLimit, const DriveModel& model) {
+    Profile profile;
+    const float halfTrack = model.trackWidth / 2;
+    const float sign = to >= from ? 1 : -1;
+    // plan the wheel arc, half a degree of heading per position
+    const float angle = std::fabs(to - from);
+    const int count = std::max(1, int(std::ceil(angle * 2)));
+    std::vector<float> positions(count + 1);
+    for (int i = 0; i <= count; i++) positions[i] = angle * i / count * M_PI / 180 * halfTrack;
+    const std::vector<float> limits(count + 1, std::min(speedLimit, model.maxVelocity()));
+
+    const float toDegrees = 180 / M_PI / halfTrack;
+    for (const Motion& m : sampleMotion(positions, limits, model.maxAcceleration, model.maxDeceleration)) {
+        const float turned = m.distance * toDegrees;
+        profile.samples.push_back({x, y, from + sign * turned, turned, 0, 0, sign * m.velocity * toDegrees,
+                                   sign * m.acceleration * toDegrees});
+    }
+    profile.length = angle;
+    return profile;
+}
+
+} // namespace spf
@@ -0,0 +1,53 @@
+#include <string>
+
+#include "lemlib/api.hpp"
+#include "spf/profiler.hpp"
+
+namespace spf {
+
+ProfileRegion::ProfileRegion(const char* name, std::uint32_t budget)
+    : name(name),
+      budget(budget),
+      next(head) {
+    head = this;
+}
+
+void ProfileRegion::add(std::uint32_t us) {
+    time.add(us);
+    if (budget > 0 && us > budget) misses++;
+}
+
+void ProfileRegion::write(std::FILE* file) const {
+    // share of the time since it first ran, whichever task it runs on
+    const std::uint64_t elapsed = pros::micros() - started;
+    char line[160];
+    int length = std::snprintf(line, sizeof(line), "region %s: %lu runs, cpu %.2f%%", name,
+                               (unsigned long)time.count, elapsed > 0 ? 100.0 * time.total / elapsed : 0.0);
+    if (budget > 0 && length < int(sizeof(line))) {
+        std::snprintf(line + length, sizeof(line) - length, ", %lu over the %lu us budget", (unsigned long)misses,
+                      (unsigned long)budget);
+    }
+    lemlib::telemetrySink()->info("{}", std::string(line));
+    if (file != nullptr) std::fprintf(file, "%s\n", line);
+    time.write(file, "runtime");
+}
+
+void ProfileRegion::clear() {
+    time = {};
+    misses = 0;
+    started = 0;
+}
+
+void dumpRegions(std::FILE* file) {
+    for (const ProfileRegion* region = ProfileRegion::first(); region != nullptr; region = region->following()) {
+        if (region->time.count > 0) region->write(file);
+    }
+}
+
+void clearRegions() {
+    for (ProfileRegion* region = ProfileRegion::first(); region != nullptr; region = region->following()) {
+        region->clear();
+    }
+}
+
+} // namespace spf
@@ -0,0 +1,171 @@
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+#include "spf/field.hpp"
+#include "spf/relocalize.hpp"
+#include "spf/textLog.hpp"
+
+namespace spf {
+
+namespace {
+
+/** a straight wall along x = at (or y = at), from low to high in the other axis */
+struct Wall {
+        bool vertical;
+        float at;
+        float low;
+        float high;
+        bool goal; // the front or side of a goal, which the sensors see through the net unreliably
+};
+
+using field::barrierHalfLength;
+using field::barrierHalfWidth;
+using field::goalDepth;
+using field::goalHalfWidth;
+using field::perimeter;
+
+constexpr Wall walls[] = {
+    {true, -perimeter, -perimeter, perimeter, false},
+    {true, perimeter, -perimeter, perimeter, false},
+    {false, -perimeter, -perimeter, perimeter, false},
+    {false, perimeter, -perimeter, perimeter, false},
+    {true, -barrierHalfWidth, -barrierHalfLength, barrierHalfLength, false},
+    {true, barrierHalfWidth, -barrierHalfLength, barrierHalfLength, false},
+    {true, -perimeter + goalDepth, -goalHalfWidth, goalHalfWidth, true},
+    {false, -goalHalfWidth, -perimeter, -perimeter + goalDepth, true},
+    {false, goalHalfWidth, -perimeter, -perimeter + goalDepth, true},
+    {true, perimeter - goalDepth, -goalHalfWidth, goalHalfWidth, true},
+    {false, -goalHalfWidth, perimeter - goalDepth, perimeter, true},
+    {false, goalHalfWidth, perimeter - goalDepth, perimeter, true},
+};
+// a hit nearer the end of a wall than this could be off the wall beside it, or nothing
+constexpr float endMargin = 3; // in
+
+// V5 distance sensor
+constexpr float mmPerInch = 25.4;
+constexpr std::int32_t noObject = 9999;
+constexpr std::int32_t minConfidence = 32; // out of 63
+constexpr float maxRange = 60; // in, further than this the error and the chance of hitting something else grow
+constexpr float nearRange = 8; // in, closer than this the error is a fixed 15 mm rather than 5%
+constexpr float nearNoise = 15 / mmPerInch; // in
+constexpr float rangeNoise = 0.05; // of the distance
+constexpr float latency = 0.05; // s, a reading is about this old by the time it is read
+constexpr float maxLag = 0.5; // in the distance could have changed since the reading, at most
+// a beam this far from square to the wall, as a cosine of about 50 degrees, goes through a
+// triball's worth of error for a small error in heading
+constexpr float minFacing = 0.64;
+// a reading this far from the wall the pose expects is off something else in the way
+constexpr float maxInnovation = 6; // in
+
+// pushing into a wall
+constexpr float stallCurrent = 1200; // mA, average over the drive motors
+constexpr float stallSpeed = 2; // in/s, the ground under the robot
+constexpr float pushVoltage = 3000; // mV, both sides the same way
+constexpr std::uint32_t stallTime = 100; // ms
+constexpr float bumpMargin = 3; // in, the wall has to be this close to where the pose puts it
+constexpr float bumpNoise = 0.09; // in^2, the bumper and the wall flex
+constexpr float squareFacing = 0.9; // cosine, the robot has to be nearly square to the wall
+
+} // namespace
+
+WallHit wallAlong(float x, float y, float heading) {
+    const float dx = std::sin(heading), dy = std::cos(heading);
+    WallHit hit;
+    for (const Wall& wall : walls) {
+        const float along = wall.vertical ? dx : dy;
+        if (std::fabs(along) < 1e-6f) continue;
+        const float distance = (wall.at - (wall.vertical ? x : y)) / along;
+        const float across = wall.vertical ? y + distance * dy : x + distance * dx;
+        if (distance <= 0 || (hit.distance > 0 && distance >= hit.distance)) continue;
+        if (across < wall.low || across > wall.high) continue;
+        hit.distance = distance;
+        hit.nx = wall.vertical ? 1 : 0;
+        hit.ny = wall.vertical ? 0 : 1;
+        hit.c = wall.at;
+        hit.usable = !wall.goal && across > wall.low + endMargin && across < wall.high - endMargin;
+    }
+    return hit;
+}
+
+Relocalizer::Relocalizer(Odometry& odometry, const lemlib::Drivetrain& drivetrain, std::vector<RangeSensor> sensors,
+                         float bumper)
+    : odometry(odometry),
+      leftDrive(*drivetrain.leftMotors),
+      rightDrive(*drivetrain.rightMotors),
+      trackWidth(drivetrain.trackWidth),
+      sensors(std::move(sensors)),
+      bumper(bumper),
+      last(this->sensors.size(), noObject) {}
+
+float Relocalizer::driveCurrent(pros::MotorGroup& motors) const {
+    // motor by motor, the group's own reads return vectors, which allocate every tick
+    float total = 0;
+    for (int i = 0; i < motors.size(); i++) total += std::abs(motors[i].get_current_draw());
+    return motors.size() > 0 ? total / motors.size() : 0;
+}
+
+float Relocalizer::driveVoltage(pros::MotorGroup& motors) const {
+    float total = 0;
+    for (int i = 0; i < motors.size(); i++) total += motors[i].get_voltage();
+    return motors.size() > 0 ? total / motors.size() : 0;
+}
+
+void Relocalizer::update() {
+    const OdometryStatus status = odometry.status();
+    const float theta = lemlib::degToRad(status.theta);
+    const float s = std::sin(theta), c = std::cos(theta);
+    const float speed = (status.leftSpeed + status.rightSpeed) / 2; // in/s
+    const float turnRate = (status.leftSpeed - status.rightSpeed) / trackWidth; // rad/s
+
+    for (std::size_t i = 0; i < sensors.size(); i++) {
+        const RangeSensor& spec = sensors[i];
+        const std::int32_t mm = spec.sensor->get();
+        // the sensor measures every 33 ms, so some updates see the same reading again
+        if (mm == last[i]) continue;
+        last[i] = mm;
+        if (mm <= 0 || mm >= noObject || spec.sensor->get_confidence() < minConfidence) continue;
+        const float measured = mm / mmPerInch;
+        if (measured > maxRange) continue;
+
+        const float angle = lemlib::degToRad(spec.angle);
+        const float fromX = status.x + spec.forward * s + spec.right * c;
+        const float fromY = status.y + spec.forward * c - spec.right * s;
+        const WallHit hit = wallAlong(fromX, fromY, theta + angle);
+        if (!hit.usable) continue;
+        const float facing = std::fabs(hit.nx * std::sin(theta + angle) + hit.ny * std::cos(theta + angle));
+        if (facing < minFacing) continue;
+        // how far the distance could have moved on while the reading was on its way
+        const float lag = latency * (std::fabs(speed) + std::fabs(turnRate) * hit.distance) / facing;
+        if (lag > maxLag) continue;
+        if (std::fabs(measured - hit.distance) > maxInnovation) continue;
+
+        const float noise = measured < nearRange ? nearNoise : rangeNoise * measured;
+        odometry.addRange({measured, noise * noise + lag * lag, spec.forward, spec.right, angle, hit.nx, hit.ny,
+                           hit.c});
+    }
+
+    // pushing into something: both sides driven the same way hard, drawing current, going nowhere
+    const float left = driveVoltage(leftDrive), right = driveVoltage(rightDrive);
+    const bool pushing = std::fabs(left) > pushVoltage && std::fabs(right) > pushVoltage && left * right > 0;
+    const float current = (driveCurrent(leftDrive) + driveCurrent(rightDrive)) / 2;
+    if (!pushing || current < stallCurrent || std::fabs(speed) > stallSpeed || status.trackerFault) {
+        stalled = 0;
+        bumped = false;
+        return;
+    }
+    stalled += period;
+    if (bumped || stalled < stallTime) return;
+    bumped = true;
+
+    const float angle = left > 0 ? 0 : M_PI;
+    const WallHit hit = wallAlong(status.x, status.y, theta + angle);
+    const float facing = std::fabs(hit.nx * std::sin(theta + angle) + hit.ny * std::cos(theta + angle));
+    if (!hit.usable || facing < squareFacing || std::fabs(hit.distance - bumper) > bumpMargin) return;
+    if (!odometry.addRange({bumper, bumpNoise, 0, 0, angle, hit.nx, hit.ny, hit.c})) return;
+    bumpCount.fetch_add(1, std::memory_order_relaxed);
+    textLog().post("Relocalized: %s bumper against the wall at %s = %.1f, %.1f in from where the pose put it",
+                   angle == 0 ? "front" : "back", hit.nx != 0 ? "x" : "y", hit.c, hit.distance - bumper);
+}
+
+} // namespace spf
@@ -0,0 +1,665 @@
+#include <algorithm>
+#include <cmath>
+
+#include "pros/rtos.hpp"
+#include "spf/field.hpp"
+#include "spf/odometry.hpp"
+#include "spf/pathFile.hpp"
+#include "spf/profiler.hpp"
+#include "spf/route.hpp"
+#include "spf/textLog.hpp"
+
+namespace spf {
+
+namespace {
+
+// RAMSETE gains, converted from the usual per-meter values to inches
+constexpr float ramseteB = 2.0 * 0.0254 * 0.0254; // 1/in^2
+constexpr float ramseteZeta = 0.7;
+// feedback gain that stays when the reference is at rest, 1/s
+constexpr float restGain = 10;
+// wheel velocity feedback on top of the feedforward, mV per in/s a side is off
+constexpr float wheelVelocityGain = 60;
+// how long a motion may keep correcting after its profile ends, in milliseconds
+constexpr int settleTime = 250;
+
+// compiled paths: slowest the follower drives before it reaches the end, in in/s, and how close
+// along the path to the end counts as there, in inches
+constexpr float minPathSpeed = 6;
+constexpr float pathEndTolerance = 0.5;
+constexpr float velocityGain = 1;
+
+// sharpest corner chaining rounds off, in degrees. Past this the arc is slower than turning in place
+constexpr float maxChainAngle = 120;
+
+// a tick of a profiled motion or path, on the autonomous task
+ProfileRegion motionTime("motion", Profile::period * 1000 / 2);
+
+float sinc(float x) { return std::fabs(x) < 1e-4 ? 1 : std::sin(x) / x; }
+
+/**
+ * whether a step is an output or a wait, which attach to the motion before them. waitUntilDone()
+ * and waitFor() don't: the robot stops at them, so nothing merges or chains across them
+ */
+bool attaches(StepType type) {
+    return type == StepType::Output || type == StepType::WaitUntil || type == StepType::WaitFraction ||
+           type == StepType::After;
+}
+
+/** the next step after index that doesn't attach to the motion before it */
+std::size_t nextMotion(const std::vector<Step>& steps, std::size_t index) {
+    for (std::size_t i = index + 1; i < steps.size(); i++) {
+        if (!attaches(steps[i].type)) return i;
+    }
+    return steps.size();
+}
+
+/** add a marker to a turn or followed path, keeping them in order */
+void insertMarker(std::vector<Marker>& markers, const Marker& marker) {
+    const auto after = std::upper_bound(markers.begin(), markers.end(), marker.distance,
+                                        [](float distance, const Marker& other) { return distance < other.distance; });
+    markers.insert(after, marker);
+}
+
+/**
+ * Compile steps into segments. Every corner that can be chained is, except the one numbered
+ * unchained, which is how Route::compile measures what each corner saves. Paths stay within wall
+ * of the middle of the field, and moves to past it go to it instead.
+ */
+std::vector<Segment> build(const std::vector<Step>& steps, const DriveModel& model, int unchained, float wall,
+                           lemlib::Pose& planned) {
+    std::vector<Segment> segments;
+    // planned is where the robot should be after the steps so far. It starts where the route
+    // starts, unless the route sets a pose, and ends where the route leaves the robot
+
+    // consecutive moves collect here until something needs the robot to stop
+    std::vector<PathPoint> path;
+    std::vector<Marker> markers;
+    std::vector<Transition> transitions;
+    bool pathForwards = true;
+    float pathLength = 0;
+    // the move the path ends with, while a turn after it may still be chained
+    const Step* lastMove = nullptr;
+    int corners = 0;
+
+    // the motion outputs attach to, and where along it they happen
+    enum class Attach { None, Path, Turn, Follow };
+    Attach attach = Attach::None;
+    float motionStart = 0;
+    float motionEnd = 0;
+    float motionScale = 1; // distance along the path per unit waitUntil is given in
+    float anchor = 0;
+    // how much longer after() and waitFor() hold the next outputs back, until the next wait or motion
+    int holdTime = 0;
+    std::function<bool()> holdCondition;
+    auto release = [&]() {
+        holdTime = 0;
+        holdCondition = nullptr;
+    };
+
+    auto flush = [&]() {
+        if (!path.empty()) {
+            Segment segment {Segment::Kind::Profile};
+            segment.profile = timeOptimalProfile(path, pathForwards, model);
+            std::stable_sort(markers.begin(), markers.end(),
+                             [](const Marker& a, const Marker& b) { return a.distance < b.distance; });
+            segment.markers = std::move(markers);
+            segment.transitions = std::move(transitions);
+            segments.push_back(std::move(segment));
+        }
+        path.clear();
+        markers.clear();
+        transitions.clear();
+        pathLength = 0;
+        lastMove = nullptr;
+        if (attach == Attach::Path) attach = Attach::None;
+    };
+    auto append = [&](const std::vector<PathPoint>& piece) {
+        // pieces share their end points
+        for (std::size_t i = path.empty() ? 0 : 1; i < piece.size(); i++) {
+            if (!path.empty()) pathLength += std::hypot(piece[i].x - path.back().x, piece[i].y - path.back().y);
+            path.push_back(piece[i]);
+        }
+    };
+    auto runAsIs = [&](const Step& step) {
+        flush();
+        Segment segment {Segment::Kind::Step};
+        segment.step = step;
+        segments.push_back(std::move(segment));
+        attach = Attach::None;
+        release();
+    };
+    // round the corner of the turn at steps[index] into an arc between the moves either side of it
+    auto chain = [&](std::size_t index) {
+        const Step& turn = steps[index];
+        if (lastMove == nullptr || lastMove->options.exitRadius <= 0 || turn.options.reactive) return false;
+        const std::size_t nextIndex = nextMotion(steps, index);
+        if (nextIndex >= steps.size()) return false;
+        const Step& next = steps[nextIndex];
+        const float nextLength = std::hypot(next.x - planned.x, next.y - planned.y);
+        if (next.type != StepType::Move || next.options.reactive || next.options.forwards != pathForwards ||
+            nextLength < 1) {
+            return false;
+        }
+        const float angle = std::fabs(lemlib::angleError(turn.theta, planned.theta, false));
+        if (angle < 0.5 || angle > maxChainAngle) return false;
+        if (corners++ == unchained) return false;
+
+        // hand off the exit radius before the corner, and rejoin the same distance after it
+        const float radius = std::min({lastMove->options.exitRadius, (motionEnd - motionStart) / 2, nextLength / 2});
+        while (path.size() > 1 && pathLength > motionEnd - radius) {
+            pathLength -= std::hypot(path.back().x - path[path.size() - 2].x, path.back().y - path[path.size() - 2].y);
+            path.pop_back();
+        }
+        for (Marker& marker : markers) marker.distance = std::min(marker.distance, pathLength);
+        const float flip = pathForwards ? 0 : 180;
+        const float exit = lemlib::degToRad(turn.theta + flip);
+        const lemlib::Pose rejoin(planned.x + radius * std::sin(exit), planned.y + radius * std::cos(exit), turn.theta);
+        const PathPoint from = path.back();
+        const float cornerStart = pathLength;
+        append(bezierPath(from.x, from.y, lemlib::radToDeg(from.heading) - flip, rejoin.x, rejoin.y, rejoin.theta,
+                          pathForwards, model.maxVelocity() * turn.options.maxSpeed / 127, wall));
+        transitions.push_back({corners - 1, cornerStart, pathLength, 0});
+
+        attach = Attach::Path;
+        motionStart = cornerStart;
+        motionEnd = pathLength;
+        motionScale = (motionEnd - motionStart) / angle;
+        anchor = motionStart;
+        release();
+        planned = rejoin;
+        lastMove = nullptr;
+        return true;
+    };
+    auto turn = [&](std::size_t index) {
+        const Step& step = steps[index];
+        if (chain(index)) return;
+        flush();
+        const float error = lemlib::angleError(step.theta, planned.theta, false);
+        if (step.options.reactive) {
+            Segment segment {Segment::Kind::Step};
+            segment.step = step;
+            segment.step.type = StepType::Turn;
+            segments.push_back(std::move(segment));
+            attach = Attach::None;
+        } else if (std::fabs(error) >= 0.5) {
+            Segment segment {Segment::Kind::Turn};
+            segment.profile = turnProfile(planned.x, planned.y, planned.theta, planned.theta + error,
+                                          model.maxVelocity() * step.options.maxSpeed / 127, model);
+            segments.push_back(std::move(segment));
+            attach = Attach::Turn;
+            motionStart = 0;
+            motionEnd = std::fabs(error);
+            motionScale = 1;
+            anchor = 0;
+        } else {
+            attach = Attach::None;
+        }
+        release();
+        planned.theta = step.theta;
+    };
+
+    for (std::size_t i = 0; i < steps.size(); i++) {
+        const Step& step = steps[i];
+        switch (step.type) {
+            case StepType::SetPose:
+                runAsIs(step);
+                planned = lemlib::Pose(step.x, step.y, step.theta);
+                break;
+            case StepType::SetX:
+                runAsIs(step);
+                planned.x = step.x;
+                break;
+            case StepType::Turn: turn(i); break;
+            case StepType::Move: {
+                const float x = std::clamp(step.x, -wall, wall);
+                const float y = std::clamp(step.y, -wall, wall);
+                if (std::hypot(x - planned.x, y - planned.y) < 1) {
+                    turn(i);
+                    break;
+                }
+                if (step.options.reactive) {
+                    runAsIs(step);
+                    segments.back().step.x = x;
+                    segments.back().step.y = y;
+                    planned = lemlib::Pose(x, y, step.theta);
+                    break;
+                }
+                if (!path.empty() && pathForwards != step.options.forwards) flush();
+                motionStart = pathLength;
+                append(bezierPath(planned.x, planned.y, planned.theta, x, y, step.theta, step.options.forwards,
+                                  model.maxVelocity() * step.options.maxSpeed / 127, wall));
+                pathForwards = step.options.forwards;
+                lastMove = &step;
+                attach = Attach::Path;
+                motionEnd = pathLength;
+                motionScale = 1;
+                anchor = motionStart;
+                release();
+                planned = lemlib::Pose(x, y, step.theta);
+                break;
+            }
+            case StepType::WaitUntil:
+                anchor = std::min(motionStart + step.x * motionScale, motionEnd);
+                release();
+                break;
+            case StepType::WaitFraction:
+                anchor = motionStart + std::clamp(step.x, 0.0f, 1.0f) * (motionEnd - motionStart);
+                release();
+                break;
+            // the robot stops here: the motion ends its segment, and what comes after starts from rest
+            case StepType::WaitUntilDone:
+                flush();
+                attach = Attach::None;
+                release();
+                break;
+            case StepType::After: holdTime += step.time; break;
+            case StepType::WaitFor:
+                flush();
+                attach = Attach::None;
+                release();
+                holdCondition = step.condition;
+                break;
+            case StepType::Delay: runAsIs(step); break;
+            case StepType::Output: {
+                const Marker marker {anchor, step.output, step.value, step.action, holdTime, holdCondition};
+                if (attach == Attach::Path) markers.push_back(marker);
+                else if (attach == Attach::Turn || attach == Attach::Follow) {
+                    insertMarker(segments.back().markers, marker);
+                } else {
+                    // not during a motion, so it happens now or is held back from now. The hold
+                    // carries on to the outputs after it
+                    flush();
+                    Segment segment {Segment::Kind::Step};
+                    segment.markers.push_back(marker);
+                    segment.step = step;
+                    segments.push_back(std::move(segment));
+                }
+                break;
+            }
+            // where a path file ends isn't known here, moves after it start from the last known pose
+            case StepType::Follow: {
+                runAsIs(step);
+                attach = Attach::Follow;
+                motionStart = 0;
+                motionEnd = PathFile(step.path->buf, step.path->size).length();
+                motionScale = 1;
+                anchor = 0;
+                break;
+            }
+        }
+    }
+    flush();
+    return segments;
+}
+
+} // namespace
+
+// steps
+
+Step setPose(float x, float y, float theta) { return {.type = StepType::SetPose, .x = x, .y = y, .theta = theta}; }
+
+Step setX(float x) { return {.type = StepType::SetX, .x = x}; }
+
+Step moveTo(float x, float y, float theta, MoveOptions options) {
+    return {.type = StepType::Move, .x = x, .y = y, .theta = theta, .options = options};
+}
+
+Step turnTo(float theta, MoveOptions options) { return {.type = StepType::Turn, .theta = theta, .options = options}; }
+
+Step waitUntil(float distance) { return {.type = StepType::WaitUntil, .x = distance}; }
+
+Step waitUntilFraction(float fraction) { return {.type = StepType::WaitFraction, .x = fraction}; }
+
+Step waitUntilDone() { return {.type = StepType::WaitUntilDone}; }
+
+Step after(int time) { return {.type = StepType::After, .time = time}; }
+
+Step waitFor(std::function<bool()> condition) {
+    return {.type = StepType::WaitFor, .condition = std::move(condition)};
+}
+
+Step delay(int time) { return {.type = StepType::Delay, .time = time}; }
+
+Step set(Piston& output, bool value) {
+    return {.type = StepType::Output, .output = &output, .value = value};
+}
+
+Step call(std::function<void()> action) { return {.type = StepType::Output, .action = std::move(action)}; }
+
+Step follow(const asset& path, float lookahead, int timeout, bool forwards) {
+    return {.type = StepType::Follow,
+            .options = {.forwards = forwards},
+            .time = timeout,
+            .path = &path,
+            .lookahead = lookahead};
+}
+
+// route
+
+Route::Route(int id, const char* name, std::vector<Step> steps)
+    : id(id),
+      name(name),
+      steps(std::move(steps)) {}
+
+void Route::compile(const DriveModel& model, float halfLength, const lemlib::Pose& start) {
+    const float wall = field::perimeter - halfLength;
+    for (const Step& step : steps) {
+        if (step.type == StepType::Move && (std::fabs(step.x) > wall || std::fabs(step.y) > wall)) {
+            textLog().post("Route %d: (%.1f, %.1f) is off the field, moving to the wall", id, step.x, step.y);
+        }
+    }
+    end = start;
+    segments = build(steps, model, -1, wall, end);
+    // what each chained corner saves is what the route takes with just that corner stopped at
+    const int chainedTime = plannedTime();
+    for (Segment& segment : segments) {
+        for (Transition& transition : segment.transitions) {
+            int stoppedTime = 0;
+            lemlib::Pose planned = start;
+            for (const Segment& other : build(steps, model, transition.corner, wall, planned)) {
+                stoppedTime += other.profile.duration();
+            }
+            transition.savedTime = stoppedTime - chainedTime;
+        }
+    }
+    compiled = true;
+}
+
+int Route::plannedTime() const {
+    int time = 0;
+    for (const Segment& segment : segments) time += segment.profile.duration();
+    return time;
+}
+
+int Route::savedTime() const {
+    int time = 0;
+    for (const Segment& segment : segments) {
+        for (const Transition& transition : segment.transitions) time += transition.savedTime;
+    }
+    return time;
+}
+
+// runner
+
+RouteRunner::RouteRunner(lemlib::Chassis& chassis, pros::MotorGroup& leftMotors, pros::MotorGroup& rightMotors,
+                         const DriveModel& model)
+    : chassis(chassis),
+      leftMotors(leftMotors),
+      rightMotors(rightMotors),
+      model(model) {}
+
+void RouteRunner::run(const Route& route) {
+    if (!route.isCompiled()) {
+        textLog().post("Route %d not compiled, skipped", route.id);
+        return;
+    }
+    for (const Segment& segment : route.segments) {
+        if (segment.kind != Segment::Kind::Step) track(segment);
+        else if (segment.step.type == StepType::Follow) follow(segment);
+        else if (segment.step.type == StepType::Output) reach(segment.markers.front());
+        else runStep(segment.step);
+    }
+}
+
+void RouteRunner::reach(const Marker& marker) {
+    if (marker.delay <= 0 && (!marker.condition || marker.condition())) {
+        marker.fire();
+        return;
+    }
+    pendingMutex.take();
+    const bool full = pendingCount == maxPending;
+    if (!full) pending[pendingCount++] = {&marker, pros::millis() + std::max(marker.delay, 0)};
+    pendingMutex.give();
+    // better early than never
+    if (full) {
+        textLog().post("Too many outputs held back, firing one early");
+        marker.fire();
+    }
+}
+
+void RouteRunner::updateActions() {
+    std::array<const Marker*, maxPending> ready;
+    std::size_t readyCount = 0;
+    pendingMutex.take();
+    const std::uint32_t now = pros::millis();
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < pendingCount; i++) {
+        const Marker& marker = *pending[i].marker;
+        if (int(now - pending[i].due) >= 0 && (!marker.condition || marker.condition())) {
+            ready[readyCount++] = &marker;
+        } else {
+            pending[kept++] = pending[i];
+        }
+    }
+    pendingCount = kept;
+    pendingMutex.give();
+    // outside the lock, an action may take a while
+    for (std::size_t i = 0; i < readyCount; i++) ready[i]->fire();
+}
+
+void RouteRunner::cancelActions() {
+    pendingMutex.take();
+    pendingCount = 0;
+    pendingMutex.give();
+}
+
+void RouteRunner::runStep(const Step& step) {
+    switch (step.type) {
+        case StepType::SetPose: chassis.setPose(step.x, step.y, step.theta); break;
+        case StepType::SetX: {
+            const lemlib::Pose pose = chassis.getPose();
+            chassis.setPose(step.x, pose.y, pose.theta);
+            break;
+        }
+        case StepType::Move:
+            chassis.moveToPose(step.x, step.y, step.theta, step.options.timeout,
+                               {.forwards = step.options.forwards,
+                                .maxSpeed = step.options.maxSpeed,
+                                .minSpeed = step.options.minSpeed,
+                                .earlyExitRange = step.options.exitRadius},
+                               false);
+            break;
+        case StepType::Turn:
+            chassis.turnToHeading(step.theta, step.options.timeout,
+                                  {.maxSpeed = int(step.options.maxSpeed),
+                                   .minSpeed = int(step.options.minSpeed),
+                                   .earlyExitRange = step.options.exitRadius},
+                                  false);
+            break;
+        case StepType::Delay: pros::delay(step.time); break;
+        default: break;
+    }
+}
+
+void RouteRunner::track(const Segment& segment) {
+    const Profile& profile = segment.profile;
+    const float halfTrack = model.trackWidth / 2;
+    std::size_t nextMarker = 0;
+    std::size_t nextTransition = 0;
+    const std::uint32_t start = pros::millis();
+    std::uint32_t now = start;
+    // turns start from wherever the last motion left the robot, and blend that out as they go
+    const float turnOffset =
+        segment.kind == Segment::Kind::Turn
+            ? lemlib::angleError(chassis.getPose().theta, profile.samples.front().theta, false)
+            : 0;
+    motion.store(segment.kind == Segment::Kind::Turn ? Motion::Turn : Motion::Profile, std::memory_order_relaxed);
+    // how closely the wheels follow the velocities they are asked for, in (in/s)^2
+    float velocityError = 0;
+    int ticks = 0;
+    // how far the robot is from the reference, when it stops
+    float miss = 0;
+
+    while (true) {
+        const std::uint64_t tickStart = pros::micros();
+        const int time = now - start;
+        ProfileSample reference = profile.at(time);
+        if (profile.length > 0) reference.theta += turnOffset * (1 - reference.distance / profile.length);
+        while (nextMarker < segment.markers.size() && segment.markers[nextMarker].distance <= reference.distance) {
+            reach(segment.markers[nextMarker++]);
+        }
+
+        // error in the robot's frame
+        const lemlib::Pose pose = chassis.getPose(true);
+        const float dx = reference.x - pose.x;
+        const float dy = reference.y - pose.y;
+        const float forwardError = dx * std::sin(pose.theta) + dy * std::cos(pose.theta);
+        const float rightError = dx * std::cos(pose.theta) - dy * std::sin(pose.theta);
+        const float headingError = lemlib::angleError(lemlib::degToRad(reference.theta), pose.theta, true);
+
+        // report each chained corner as the robot comes out of it
+        while (nextTransition < segment.transitions.size() &&
+               segment.transitions[nextTransition].end <= reference.distance) {
+            const Transition& transition = segment.transitions[nextTransition++];
+            textLog().post("Chained corner %d: %.1f in/s, %.2f in off the path, %d ms saved", transition.corner,
+                           std::fabs(reference.velocity), std::hypot(dx, dy), transition.savedTime);
+        }
+
+        // keep correcting a little after the profile ends, until the robot is on the final pose
+        miss = std::hypot(dx, dy);
+        if (time >= profile.duration()) {
+            const bool settled = std::fabs(forwardError) < 0.5 && std::fabs(rightError) < 0.5 &&
+                                 std::fabs(headingError) < lemlib::degToRad(1);
+            if (settled || time >= profile.duration() + settleTime) break;
+        }
+
+        // RAMSETE, with clockwise angles so the signs match the compass convention
+        const float velocity = reference.velocity;
+        const float angularVelocity = lemlib::degToRad(reference.angularVelocity);
+        const float gain = 2 * ramseteZeta *
+                               std::sqrt(angularVelocity * angularVelocity + ramseteB * velocity * velocity) +
+                           restGain;
+        const float v = velocity * std::cos(headingError) + gain * forwardError;
+        const float w = angularVelocity + gain * headingError + ramseteB * velocity * sinc(headingError) * rightError;
+
+        const float error = drive(v + w * halfTrack, v - w * halfTrack, reference.acceleration,
+                                  lemlib::degToRad(reference.angularAcceleration) * halfTrack);
+        velocityError += error * error;
+        ticks++;
+        motionTime.add(pros::micros() - tickStart);
+        pros::Task::delay_until(&now, Profile::period);
+    }
+
+    // anything the profile didn't reach still happens
+    for (; nextMarker < segment.markers.size(); nextMarker++) reach(segment.markers[nextMarker]);
+    leftMotors.move_voltage(0);
+    rightMotors.move_voltage(0);
+    motion.store(Motion::None, std::memory_order_relaxed);
+    textLog().post("%s done in %lu ms, %.2f in off, wheels %.1f in/s rms off their velocity",
+                   segment.kind == Segment::Kind::Turn ? "Turn" : "Profile", (unsigned long)(now - start), miss,
+                   ticks > 0 ? std::sqrt(velocityError / ticks) : 0.0f);
+}
+
+void RouteRunner::follow(const Segment& segment) {
+    const Step& step = segment.step;
+    const PathFile path(step.path->buf, step.path->size);
+    if (!path.valid()) {
+        textLog().post("Not a compiled path, see tools/spf_pathc");
+        return;
+    }
+    std::size_t nextMarker = 0;
+    const float halfTrack = model.trackWidth / 2;
+    const float sign = step.options.forwards ? 1 : -1;
+    const std::size_t last = path.size() - 1;
+    // points are evenly spaced, so the lookahead is a fixed number of points
+    const std::size_t ahead = std::max(1L, std::lround(step.lookahead / path.spacing()));
+    const float pursuitB = 2 / std::max(step.lookahead * step.lookahead, 1.0f);
+    const PathFilePoint end = path.at(last);
+    std::size_t closest = 0;
+    lemlib::Pose lastPose = chassis.getPose(true);
+    const std::uint32_t start = pros::millis();
+    std::uint32_t now = start;
+    std::uint32_t arrived = 0;
+    motion.store(Motion::Path, std::memory_order_relaxed);
+
+    while (int(now - start) < step.time) {
+        const std::uint64_t tickStart = pros::micros();
+        const lemlib::Pose pose = chassis.getPose(true);
+        const float moved = (pose.x - lastPose.x) * std::sin(pose.theta) + (pose.y - lastPose.y) * std::cos(pose.theta);
+        const float measured = moved / (Profile::period / 1000.0f);
+        lastPose = pose;
+        auto distanceTo = [&](const PathFilePoint& point) { return std::hypot(point.x - pose.x, point.y - pose.y); };
+
+        // the robot only goes forwards along the path, so the closest point is found by walking on
+        // from the last one. Over the whole path that is one pass, not a search per tick
+        PathFilePoint here = path.at(closest);
+        float hereDistance = distanceTo(here);
+        while (closest < last) {
+            const PathFilePoint next = path.at(closest + 1);
+            const float nextDistance = distanceTo(next);
+            if (nextDistance > hereDistance) break;
+            here = next;
+            hereDistance = nextDistance;
+            closest++;
+        }
+        while (nextMarker < segment.markers.size() && segment.markers[nextMarker].distance <= here.distance) {
+            reach(segment.markers[nextMarker++]);
+        }
+
+        // done once the robot has stopped level with the end, measured along the path's final
+        // heading, or has had a while to
+        const bool approaching = closest + ahead >= last;
+        const float remaining = (end.x - pose.x) * std::sin(end.heading) + (end.y - pose.y) * std::cos(end.heading);
+        if (approaching && remaining < pathEndTolerance) {
+            if (arrived == 0) arrived = now;
+            if (std::fabs(measured) < minPathSpeed || int(now - arrived) >= settleTime) break;
+        }
+
+        // error from the closest point, in the robot's frame
+        const float dx = here.x - pose.x;
+        const float dy = here.y - pose.y;
+        const float rightError = dx * std::cos(pose.theta) - dy * std::sin(pose.theta);
+        const float headingError =
+            std::remainder(here.heading + (step.options.forwards ? 0 : M_PI) - pose.theta, 2 * M_PI);
+
+        // the plan brakes to a stop at the end, the robot may not have. The last stretch also slows
+        // for however far is actually left, backing up if it has gone past
+        float speed = std::max(here.velocity, minPathSpeed);
+        if (approaching) speed = std::min(speed, restGain * remaining);
+        // without a time reference to fall behind, velocity is corrected on the measured speed
+        const float v = sign * speed + velocityGain * (sign * speed - measured);
+        // the path's own curvature, plus RAMSETE's heading and sideways feedback. The sideways gain
+        // is pure pursuit's: a robot beside the path steers for the point a lookahead down it
+        const float angularVelocity = speed * here.curvature;
+        const float gain = 2 * ramseteZeta * std::sqrt(angularVelocity * angularVelocity + pursuitB * speed * speed) +
+                           restGain;
+        const float w = angularVelocity + gain * headingError + pursuitB * v * sinc(headingError) * rightError;
+        // there is no time reference to correct against, so braking feedforward that gets ahead of a
+        // slow robot could stop it short of the end. Braking never asks for less than the voltage
+        // that holds the slowest speed
+        const float acceleration =
+            std::max(here.acceleration, model.kV * (std::min(minPathSpeed, speed) - speed) / model.kA);
+        // the heading accelerates with the speed and with the change in curvature
+        const float curvatureChange =
+            (path.at(std::min(closest + 1, last)).curvature - here.curvature) / path.spacing();
+        const float angularAcceleration = acceleration * here.curvature + speed * speed * curvatureChange;
+        drive(v + w * halfTrack, v - w * halfTrack, sign * acceleration, angularAcceleration * halfTrack);
+        motionTime.add(pros::micros() - tickStart);
+        pros::Task::delay_until(&now, Profile::period);
+    }
+
+    for (; nextMarker < segment.markers.size(); nextMarker++) reach(segment.markers[nextMarker]);
+    leftMotors.move_voltage(0);
+    rightMotors.move_voltage(0);
+    motion.store(Motion::None, std::memory_order_relaxed);
+    const lemlib::Pose pose = chassis.getPose();
+    textLog().post("Path done in %lu ms, %.2f in from the end", (unsigned long)(pros::millis() - start),
+                   std::hypot(end.x - pose.x, end.y - pose.y));
+}
+
+float RouteRunner::drive(float leftVelocity, float rightVelocity, float acceleration, float turnAcceleration) {
+    // feedforward from each side's gains, and feedback on how far each side's wheels are off the
+    // velocity asked of them, so a side that runs slow or a low battery is caught within a tick
+    const float leftError = leftVelocity - driveVelocity(leftMotors, model.inchesPerDegree());
+    const float rightError = rightVelocity - driveVelocity(rightMotors, model.inchesPerDegree());
+    const float turnVoltage = model.kATurn * turnAcceleration;
+    const float leftVoltage = model.left.voltage(leftVelocity, acceleration) + turnVoltage + wheelVelocityGain * leftError;
+    const float rightVoltage =
+        model.right.voltage(rightVelocity, acceleration) - turnVoltage + wheelVelocityGain * rightError;
+    leftMotors.move_voltage(std::clamp(leftVoltage, -12000.0f, 12000.0f));
+    rightMotors.move_voltage(std::clamp(rightVoltage, -12000.0f, 12000.0f));
+    return std::sqrt((leftError * leftError + rightError * rightError) / 2);
+}
+
+} // namespace spf
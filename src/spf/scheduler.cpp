@@ -0,0 +1,195 @@
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include "lemlib/api.hpp"
+#include "spf/scheduler.hpp"
+#include "spf/textLog.hpp"
+
+namespace spf {
+
+namespace {
+
+// what a task's stack is filled with before it starts, the same FreeRTOS fills stacks with when it
+// checks them, so the pattern holds whether or not the kernel fills it again
+constexpr pros::c::task_stack_t stackPaint = 0xa5a5a5a5;
+
+} // namespace
+
+// histogram
+
+void TimingHistogram::add(std::uint32_t us) {
+    std::size_t bucket = 0;
+    while (bucket < edges.size() && us >= edges[bucket]) bucket++;
+    counts[bucket]++;
+    count++;
+    total += us;
+    if (us > max) max = us;
+}
+
+void TimingHistogram::write(std::FILE* file, const char* label) const {
+    char line[256];
+    int length = std::snprintf(line, sizeof(line), "  %-8s mean %5lu us  max %6lu us |", label,
+                               (unsigned long)(count > 0 ? total / count : 0), (unsigned long)max);
+    for (std::size_t i = 0; i < counts.size() && length < int(sizeof(line)); i++) {
+        if (i < edges.size()) {
+            length += std::snprintf(line + length, sizeof(line) - length, " <%lu:%lu", (unsigned long)edges[i],
+                                    (unsigned long)counts[i]);
+        } else {
+            length += std::snprintf(line + length, sizeof(line) - length, " more:%lu", (unsigned long)counts[i]);
+        }
+    }
+    lemlib::telemetrySink()->info("{}", std::string(line));
+    if (file != nullptr) std::fprintf(file, "%s\n", line);
+}
+
+// job
+
+float Job::cpu() const {
+    const std::uint64_t elapsed = pros::micros() - started;
+    return elapsed > 0 && runtime.count > 0 ? float(runtime.total) / elapsed : 0;
+}
+
+// scheduler
+
+Job* Scheduler::add(const char* name, std::uint32_t period, std::uint32_t priority, std::function<void()> function,
+                    bool here) {
+    mutex.take();
+    Job* job = nullptr;
+    bool running = false;
+    for (std::size_t i = 0; i < jobCount && job == nullptr && !running; i++) {
+        if (std::strcmp(jobs[i].name, name) != 0) continue;
+        // a task from every() runs forever, and swapping its function out from under it would
+        // race. A runHere() job's task is deleted before its name comes round again
+        if (here && jobs[i].here) {
+            job = &jobs[i];
+            job->period = period;
+            job->priority = priority;
+            job->function = std::move(function);
+        } else {
+            running = true;
+        }
+    }
+    const bool full = job == nullptr && !running && jobCount == maxJobs;
+    if (job == nullptr && !running && !full) {
+        jobs[jobCount] = Job {name, period, priority, std::move(function)};
+        jobs[jobCount].here = here;
+        job = &jobs[jobCount++];
+    }
+    mutex.give();
+    if (running) textLog().post("Loop %s is already running, not started again", name);
+    if (full) textLog().post("Too many loops for the scheduler, %s not started", name);
+    return job;
+}
+
+void Scheduler::every(const char* name, std::uint32_t period, std::uint32_t priority,
+                      std::function<void()> function) {
+    Job* job = add(name, period, priority, std::move(function), false);
+    if (job == nullptr) return;
+    // nothing runs on the stack yet, so all of it can be painted
+    TaskMemory& memory = tasks[job - jobs.data()];
+    memory.stack.fill(stackPaint);
+    job->stack = memory.stack.data();
+    job->stackSize = sizeof(memory.stack);
+    pros::c::task_create_static([](void* job) { loop(*static_cast<Job*>(job)); }, job, priority, memory.stack.size(),
+                                name, memory.stack.data(), &memory.task);
+}
+
+void Scheduler::runHere(const char* name, std::uint32_t period, std::uint32_t priority,
+                        std::function<void()> function) {
+    Job* job = add(name, period, priority, std::move(function), true);
+    if (job == nullptr) return;
+    pros::Task::current().set_priority(priority);
+    loop(*job);
+}
+
+void Scheduler::loop(Job& job) {
+    // about once a second
+    const std::uint32_t checkEvery = std::max<std::uint32_t>(1000 / job.period, 1);
+    std::uint32_t ticks = 0;
+
+    std::uint32_t wake = pros::millis();
+    while (true) {
+        const std::uint64_t start = pros::micros();
+        if (job.started == 0) job.started = start;
+        job.jitter.add(start - std::uint64_t(wake) * 1000);
+        job.function();
+        const std::uint32_t runtime = pros::micros() - start;
+        job.runtime.add(runtime);
+        if (runtime > job.period * 1000) job.overruns++;
+        if (job.stack != nullptr && ++ticks % checkEvery == 0) {
+            // the stack grows down, so the untouched words are at the start of it
+            const std::uint32_t words = job.stackSize / sizeof(pros::c::task_stack_t);
+            std::uint32_t untouched = 0;
+            while (untouched < words && job.stack[untouched] == stackPaint) untouched++;
+            job.stackUsed = job.stackSize - untouched * sizeof(pros::c::task_stack_t);
+        }
+
+        // after an overrun, drop the periods that have already passed rather than running
+        // back to back to catch up
+        const std::uint32_t now = pros::millis();
+        if (now >= wake + 2 * job.period) {
+            const std::uint32_t behind = (now - wake) / job.period - 1;
+            job.skipped += behind;
+            wake += behind * job.period;
+        }
+        pros::Task::delay_until(&wake, job.period);
+    }
+}
+
+void Scheduler::dump(std::FILE* file) const {
+    mutex.take();
+    for (std::size_t i = 0; i < jobCount; i++) {
+        const Job& job = jobs[i];
+        if (job.runtime.count == 0) continue;
+        char stack[48] = "stack not measured";
+        if (job.stack != nullptr) {
+            std::snprintf(stack, sizeof(stack), "stack %lu of %lu bytes", (unsigned long)job.stackUsed,
+                          (unsigned long)job.stackSize);
+        }
+        char line[192];
+        std::snprintf(line, sizeof(line),
+                      "loop %s: every %lu ms at priority %lu, %lu ticks, %lu overruns, %lu skipped, cpu %.2f%%, %s",
+                      job.name, (unsigned long)job.period, (unsigned long)job.priority,
+                      (unsigned long)job.runtime.count, (unsigned long)job.overruns, (unsigned long)job.skipped,
+                      100 * job.cpu(), stack);
+        lemlib::telemetrySink()->info("{}", std::string(line));
+        if (file != nullptr) std::fprintf(file, "%s\n", line);
+        job.jitter.write(file, "jitter");
+        job.runtime.write(file, "runtime");
+    }
+    mutex.give();
+}
+
+void Scheduler::summary(char* text, std::size_t size, int lines) const {
+    std::array<const Job*, maxJobs> busiest;
+    mutex.take();
+    for (std::size_t i = 0; i < jobCount; i++) busiest[i] = &jobs[i];
+    std::sort(busiest.begin(), busiest.begin() + jobCount,
+              [](const Job* a, const Job* b) { return a->cpu() > b->cpu(); });
+    int length = 0;
+    text[0] = '\0';
+    for (int i = 0; i < lines && i < int(jobCount) && length < int(size); i++) {
+        const Job& job = *busiest[i];
+        char stack[16] = "-";
+        if (job.stack != nullptr) std::snprintf(stack, sizeof(stack), "%.1fK", job.stackUsed / 1024.0);
+        length += std::snprintf(text + length, size - length, "%s%s %.1f%% %s %lu", i > 0 ? "\n" : "", job.name,
+                                100 * job.cpu(), stack, (unsigned long)job.overruns);
+    }
+    mutex.give();
+}
+
+void Scheduler::clearStats() {
+    mutex.take();
+    for (std::size_t i = 0; i < jobCount; i++) {
+        Job& job = jobs[i];
+        job.jitter = {};
+        job.runtime = {};
+        job.overruns = 0;
+        job.skipped = 0;
+        job.started = 0;
+    }
+    mutex.give();
+}
+
+} // namespace spf
@@ -0,0 +1,28 @@
+#include <cmath>
+#include <cstdio>
+
+#include "spf/screen.hpp"
+
+namespace spf {
+
+LabelField::LabelField(const char* format, float threshold)
+    : format(format),
+      threshold(threshold) {}
+
+void LabelField::attach(lv_obj_t* label) {
+    this->label = label;
+    drawn = false;
+}
+
+bool LabelField::update(float value) {
+    if (label == nullptr) return false;
+    if (drawn && std::fabs(value - shown) < threshold) return false;
+    char text[48];
+    std::snprintf(text, sizeof(text), format, value);
+    lv_label_set_text(label, text);
+    shown = value;
+    drawn = true;
+    return true;
+}
+
+} // namespace spf
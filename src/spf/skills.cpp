@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#include "lemlib/api.hpp"
+#include "pros/rtos.hpp"
+#include "spf/skills.hpp"
+#include "spf/textLog.hpp"
+
+namespace spf {
+
+namespace {
+
+// time to leave the finish over its planned time, for what the plan doesn't cover: delays,
+// settling and reactive motions, in ms
+constexpr std::uint32_t finishMargin = 1000;
+// the same for a cycle before one has been timed
+constexpr std::uint32_t cycleMargin = 500;
+// gentle cycles stop once the drive would reach throttling this much later than the window ends
+constexpr float clearance = 1.5;
+// weight of the latest cycle in the prediction of the next
+constexpr float smoothing = 0.5;
+
+/** planned time of a cycle's routes, in ms */
+std::uint32_t plannedTime(const std::vector<SkillsPhase>& phases) {
+    std::uint32_t total = cycleMargin;
+    for (const SkillsPhase& phase : phases) total += phase.route.plannedTime();
+    return total;
+}
+
+} // namespace
+
+SkillsRunner::SkillsRunner(RouteRunner& runner, const HealthMonitor& health, Route setup,
+                           std::vector<SkillsPhase> cycle, int triballsPerCycle, Route finish, float gentleAcceleration)
+    : runner(runner),
+      health(health),
+      setup(std::move(setup)),
+      cycle(std::move(cycle)),
+      gentleCycle(this->cycle),
+      triballsPerCycle(triballsPerCycle),
+      finish(std::move(finish)),
+      gentleAcceleration(gentleAcceleration) {}
+
+void SkillsRunner::compile(const DriveModel& model, float halfLength) {
+    DriveModel gentleModel = model;
+    gentleModel.maxAcceleration *= gentleAcceleration;
+    gentleModel.maxDeceleration *= gentleAcceleration;
+    // each route is planned from where the one before it leaves the robot. A cycle ends where it
+    // started, so every cycle and the finish plan from the same place
+    setup.compile(model, halfLength);
+    lemlib::Pose pose = setup.endPose();
+    for (std::size_t i = 0; i < cycle.size(); i++) {
+        gentleCycle[i].route.compile(gentleModel, halfLength, pose);
+        cycle[i].route.compile(model, halfLength, pose);
+        pose = cycle[i].route.endPose();
+    }
+    finish.compile(model, halfLength, pose);
+}
+
+std::uint32_t SkillsRunner::runCycle(bool gentle, CycleRecord& record) {
+    std::vector<SkillsPhase>& phases = gentle ? gentleCycle : cycle;
+    const std::uint32_t start = pros::millis();
+    for (std::size_t i = 0; i < phases.size(); i++) {
+        const std::uint32_t phaseStart = pros::millis();
+        runner.run(phases[i].route);
+        if (i < record.phaseTime.size()) record.phaseTime[i] = pros::millis() - phaseStart;
+    }
+    return pros::millis() - start;
+}
+
+void SkillsRunner::publish(std::uint32_t start, bool finishing) {
+    SkillsStatus status;
+    status.cycles = cycles;
+    status.triballs = cycles * triballsPerCycle;
+    status.elapsed = (pros::millis() - start) / 1000.0f;
+    std::uint32_t cycling = 0;
+    for (int i = 0; i < cycles; i++) cycling += records[i].time;
+    status.rate = cycling > 0 ? status.triballs * 1000.0f / cycling : 0;
+    status.gentle = gentle;
+    status.finishing = finishing;
+    published.publish(status);
+}
+
+void SkillsRunner::run(std::uint32_t window) {
+    const std::uint32_t start = pros::millis();
+    cycles = 0;
+    gentle = false;
+    expected = {float(plannedTime(cycle)), float(plannedTime(gentleCycle))};
+    publish(start, false);
+
+    runner.run(setup);
+    setupTime = pros::millis() - start;
+
+    const std::uint32_t reserve = finish.plannedTime() + finishMargin;
+    while (cycles < int(maxCycles)) {
+        const std::uint32_t elapsed = pros::millis() - start;
+        const float remaining = elapsed < window ? window - elapsed : 0;
+        // cycle gently while the drive would throttle before the end at the recent load
+        const HealthStatus health = this->health.status();
+        if (health.timeToThrottle * 1000 < remaining || health.currentLimit < 1) gentle = true;
+        else if (health.timeToThrottle * 1000 > clearance * remaining) gentle = false;
+        if (remaining < expected[gentle] + reserve) break;
+
+        CycleRecord& record = records[cycles];
+        record = {};
+        record.start = elapsed;
+        record.temperature = health.maxTemperature;
+        record.gentle = gentle;
+        record.time = runCycle(gentle, record);
+        expected[gentle] += smoothing * (record.time - expected[gentle]);
+        cycles++;
+        publish(start, false);
+
+        char phases[48];
+        int length = 0;
+        phases[0] = '\0';
+        const std::vector<SkillsPhase>& ran = gentle ? gentleCycle : cycle;
+        for (std::size_t i = 0; i < ran.size() && i < record.phaseTime.size() && length < int(sizeof(phases)); i++) {
+            length += std::snprintf(phases + length, sizeof(phases) - length, "%s%s %.2f", i > 0 ? ", " : "",
+                                    ran[i].name, record.phaseTime[i] / 1000.0f);
+        }
+        const SkillsStatus status = this->status();
+        textLog().post("Skills cycle %d: %.2f s (%s), %.2f triballs/s, %.0f C%s", cycles, record.time / 1000.0f,
+                       phases, status.rate, record.temperature, record.gentle ? ", gentle" : "");
+    }
+
+    publish(start, true);
+    const std::uint32_t finishStart = pros::millis();
+    runner.run(finish);
+    finishTime = pros::millis() - finishStart;
+    totalTime = pros::millis() - start;
+    publish(start, true);
+    textLog().post("Skills: %d triballs in %.1f s, %.2f triballs/s, finish %.2f s", cycles * triballsPerCycle,
+                   totalTime / 1000.0f, cycles * triballsPerCycle * 1000.0f / std::max(totalTime, std::uint32_t(1)),
+                   finishTime / 1000.0f);
+}
+
+void SkillsRunner::dump(std::FILE* file) const {
+    if (totalTime == 0) return;
+    auto write = [file](const char* line, bool sink) {
+        if (sink) lemlib::telemetrySink()->info("{}", std::string(line));
+        if (file != nullptr) std::fprintf(file, "%s\n", line);
+    };
+    char line[160];
+    int gentleCycles = 0;
+    for (int i = 0; i < cycles; i++) gentleCycles += records[i].gentle;
+    const int triballs = cycles * triballsPerCycle;
+    std::snprintf(line, sizeof(line),
+                  "skills: %d cycles, %d triballs in %.1f s, %.3f triballs/s, %d gentle cycles, setup %.2f s, "
+                  "finish %.2f s",
+                  cycles, triballs, totalTime / 1000.0f, triballs * 1000.0f / totalTime, gentleCycles,
+                  setupTime / 1000.0f, finishTime / 1000.0f);
+    write(line, true);
+
+    // each phase over every cycle, the normal and the gentle ones together
+    for (std::size_t phase = 0; phase < cycle.size() && phase < CycleRecord::maxPhases; phase++) {
+        std::uint32_t total = 0, least = UINT32_MAX, most = 0;
+        for (int i = 0; i < cycles; i++) {
+            const std::uint32_t time = records[i].phaseTime[phase];
+            total += time;
+            least = std::min(least, time);
+            most = std::max(most, time);
+        }
+        if (cycles == 0) continue;
+        std::snprintf(line, sizeof(line), "skills phase %s: mean %.2f s, min %.2f s, max %.2f s", cycle[phase].name,
+                      total / 1000.0f / cycles, least / 1000.0f, most / 1000.0f);
+        write(line, true);
+    }
+
+    // and every cycle, only to the file
+    for (int i = 0; i < cycles && file != nullptr; i++) {
+        const CycleRecord& record = records[i];
+        int length = std::snprintf(line, sizeof(line), "skills cycle %d at %.2f s: %.2f s,", i + 1,
+                                   record.start / 1000.0f, record.time / 1000.0f);
+        const std::vector<SkillsPhase>& ran = record.gentle ? gentleCycle : cycle;
+        for (std::size_t phase = 0; phase < ran.size() && phase < CycleRecord::maxPhases && length < int(sizeof(line));
+             phase++) {
+            length += std::snprintf(line + length, sizeof(line) - length, " %s %.2f", ran[phase].name,
+                                    record.phaseTime[phase] / 1000.0f);
+        }
+        if (length < int(sizeof(line))) {
+            std::snprintf(line + length, sizeof(line) - length, ", %.0f C%s", record.temperature,
+                          record.gentle ? ", gentle" : "");
+        }
+        write(line, false);
+    }
+}
+
+} // namespace spf
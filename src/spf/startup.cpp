@@ -0,0 +1,95 @@
+#include <cstring>
+#include <string>
+
+#include "lemlib/api.hpp"
+#include "spf/startup.hpp"
+#include "spf/textLog.hpp"
+
+namespace spf {
+
+StartupPhase& Startup::add(const char* name) {
+    // phases are only added from initialize(), one at a time
+    const std::size_t index = count.load();
+    // out of room, the last phase is reused and only its own completion is waited for
+    StartupPhase& phase = phases[index < maxPhases ? index : maxPhases - 1];
+    phase.name = name;
+    phase.start = pros::millis();
+    phase.duration = 0;
+    phase.done.store(false);
+    if (index < maxPhases) count.store(index + 1);
+    return phase;
+}
+
+void Startup::finish(StartupPhase& phase) {
+    phase.duration = pros::millis() - phase.start;
+    phase.done.store(true);
+    textLog().post("Startup: %s done in %lu ms, at %lu ms", phase.name, (unsigned long)phase.duration,
+                   (unsigned long)(phase.start + phase.duration));
+    if (isReady()) textLog().post("Startup: ready at %lu ms", (unsigned long)pros::millis());
+}
+
+void Startup::start(const char* name, std::function<void()> work, std::uint32_t priority) {
+    StartupPhase& phase = add(name);
+    pros::Task task(
+        [this, &phase, work = std::move(work)]() {
+            work();
+            finish(phase);
+        },
+        priority, TASK_STACK_DEPTH_DEFAULT, name);
+}
+
+void Startup::runHere(const char* name, const std::function<void()>& work) {
+    StartupPhase& phase = add(name);
+    work();
+    finish(phase);
+}
+
+bool Startup::isReady() const {
+    for (std::size_t i = 0; i < count.load(); i++) {
+        if (!phases[i].done.load()) return false;
+    }
+    return true;
+}
+
+bool Startup::waitReady(std::uint32_t timeout) const {
+    const std::uint32_t start = pros::millis();
+    while (!isReady()) {
+        if (timeout != TIMEOUT_MAX && pros::millis() - start >= timeout) return false;
+        pros::delay(5);
+    }
+    return true;
+}
+
+bool Startup::isDone(const char* name) const {
+    for (std::size_t i = 0; i < count.load(); i++) {
+        if (phases[i].name != nullptr && !std::strcmp(phases[i].name, name) && phases[i].done.load()) return true;
+    }
+    return false;
+}
+
+bool Startup::waitFor(const char* name, std::uint32_t timeout) const {
+    const std::uint32_t start = pros::millis();
+    while (!isDone(name)) {
+        if (timeout != TIMEOUT_MAX && pros::millis() - start >= timeout) return false;
+        pros::delay(5);
+    }
+    return true;
+}
+
+void Startup::dump(std::FILE* file) const {
+    for (std::size_t i = 0; i < count.load(); i++) {
+        const StartupPhase& phase = phases[i];
+        char line[96];
+        if (phase.done.load()) {
+            std::snprintf(line, sizeof(line), "startup %s: at %lu ms, took %lu ms", phase.name,
+                          (unsigned long)phase.start, (unsigned long)phase.duration);
+        } else {
+            std::snprintf(line, sizeof(line), "startup %s: at %lu ms, still running", phase.name,
+                          (unsigned long)phase.start);
+        }
+        lemlib::telemetrySink()->info("{}", std::string(line));
+        if (file != nullptr) std::fprintf(file, "%s\n", line);
+    }
+}
+
+} // namespace spf
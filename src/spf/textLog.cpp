@@ -0,0 +1,51 @@
+#include <cstdarg>
+#include <cstdio>
+
+#include "lemlib/api.hpp"
+#include "spf/textLog.hpp"
+
+namespace spf {
+
+bool TextLog::post(const char* format, ...) {
+    // a loop never waits on the task flushing
+    if (!mutex.take(0)) {
+        drops.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    const bool full = count == slots;
+    if (full) {
+        drops.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        std::va_list args;
+        va_start(args, format);
+        std::vsnprintf(lines[(first + count) % slots].text, length, format, args);
+        va_end(args);
+        count++;
+    }
+    mutex.give();
+    return !full;
+}
+
+void TextLog::flush() {
+    while (true) {
+        Line line;
+        mutex.take();
+        if (count == 0) {
+            mutex.give();
+            return;
+        }
+        line = lines[first];
+        first = (first + 1) % slots;
+        count--;
+        mutex.give();
+        // outside the lock, the sink is slow
+        lemlib::telemetrySink()->info("{}", line.text);
+    }
+}
+
+TextLog& textLog() {
+    static TextLog log;
+    return log;
+}
+
+} // namespace spf
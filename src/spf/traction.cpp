@@ -0,0 +1,89 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "spf/textLog.hpp"
+#include "spf/traction.hpp"
+
+namespace spf {
+
+namespace {
+
+constexpr float maxVoltage = 12000; // mV
+// a side slips when its wheels run this much faster than the ground under it
+constexpr float slipThreshold = 6; // in/s
+constexpr float slipFraction = 0.2; // of the ground speed
+// and grips again below this much of the threshold
+constexpr float gripHysteresis = 0.5;
+// slower than this the side counts as at rest, so it can launch either way
+constexpr float restSpeed = 1; // in/s
+// slip a side is steered towards while its wheels spin, about where omnis on foam tiles grip best
+constexpr float targetSlip = 4; // in/s
+constexpr float targetSlipFraction = 0.1; // of the ground speed
+// how fast a side's acceleration follows the slip, in inches per second squared per second, per in/s
+// of slip over the target
+constexpr float slipGain = 300;
+constexpr float minAcceleration = 0.2; // of maxAcceleration, so a slipping side still gets going
+constexpr float period = 0.01; // s, arcade is called every 10 ms
+
+} // namespace
+
+TractionControl::TractionControl(pros::MotorGroup& leftMotors, pros::MotorGroup& rightMotors,
+                                 const Odometry& odometry, const DriveModel& model, float maxAcceleration)
+    : leftMotors(leftMotors),
+      rightMotors(rightMotors),
+      odometry(odometry),
+      model(model),
+      maxAcceleration(maxAcceleration),
+      acceleration({maxAcceleration, maxAcceleration}) {}
+
+void TractionControl::arcade(int throttle, int turn, float desaturateBias) {
+    // the same mix as chassis.arcade
+    float forward = throttle, steer = turn;
+    if (std::abs(throttle) + std::abs(turn) > 127) {
+        forward *= 1 - desaturateBias * std::abs(turn / 127.0f);
+        steer *= 1 - (1 - desaturateBias) * std::abs(throttle / 127.0f);
+    }
+    const std::array<float, 2> wanted = {(forward + steer) / 127 * maxVoltage, (forward - steer) / 127 * maxVoltage};
+
+    const OdometryStatus status = odometry.status();
+    const std::array<float, 2> slip = {status.leftSlip, status.rightSlip};
+    const std::array<float, 2> ground = {status.leftSpeed, status.rightSpeed};
+    std::array<float, 2> output {}; // mV
+    bool limited = false;
+    for (int side = 0; side < 2; side++) {
+        float voltage = wanted[side];
+        const float direction = voltage > 0 ? 1 : -1;
+        // only pushing the way the ground is already going, or from rest, is limited. Braking never is
+        if (!status.trackerFault && voltage != 0 && direction * ground[side] > -restSpeed) {
+            const float speed = std::fabs(ground[side]);
+            const float spin = slip[side] * direction;
+            const float threshold = slipThreshold + slipFraction * speed;
+            if (!slipping[side] && spin > threshold) {
+                slipping[side] = true;
+                events.fetch_add(1, std::memory_order_relaxed);
+                textLog().post("Traction control: %s wheels slipping, %.1f in/s over the ground at %.1f in/s",
+                               side == 0 ? "left" : "right", spin, speed);
+            } else if (slipping[side] && spin < threshold * gripHysteresis) {
+                slipping[side] = false;
+            }
+            // less acceleration while the wheels spin past the target, more as they grip again
+            acceleration[side] = std::clamp(
+                acceleration[side] + slipGain * (targetSlip + targetSlipFraction * speed - spin) * period,
+                minAcceleration * maxAcceleration, maxAcceleration);
+            // what accelerates the side from the speed the ground is going
+            const float cap = model.kS + model.kV * speed + model.kA * acceleration[side];
+            if (std::fabs(voltage) > cap) voltage = direction * cap;
+        } else {
+            slipping[side] = false;
+            acceleration[side] = maxAcceleration;
+        }
+        limited = limited || acceleration[side] < maxAcceleration;
+        output[side] = voltage;
+    }
+    limiting.store(limited, std::memory_order_relaxed);
+    leftMotors.move_voltage(std::lround(output[0]));
+    rightMotors.move_voltage(std::lround(output[1]));
+}
+
+} // namespace spf
@@ -0,0 +1,327 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "lemlib/api.hpp"
+#include "main.h"
+#include "sim/runtime.hpp"
+#include "sim/world.hpp"
+#include "spf/odometry.hpp"
+#include "spf/robotConfig.hpp"
+#include "spf/traction.hpp"
+
+/**
+ * Times the computations of a control tick on the host, and estimates what they cost on the brain
+ *
+ * spf_bench [--samples N] [--factor F] [--calibrate FILE] [--save FILE] [--baseline FILE]
+ *
+ * Each benchmark calls the robot's own objects from main.cpp, with the simulator's devices standing
+ * in for the brain's: the drive curves, the traction controlled arcade mix, the odometry update with
+ * the robot driving circles, a PID step with the lateral gains and the info page's pose text. Calls
+ * are timed in batches, and each benchmark reports the distribution of the time per call from the
+ * best of three rounds, the one the rest of the host disturbed least.
+ *
+ * Times on the brain are estimated by multiplying by a factor. By default it is measured here, from
+ * how long a chain of dependent single precision multiplies and adds takes the host, against the
+ * Cortex-A9's latencies at 667 MHz. That leaves out the brain's slower memory and libm, so it is a
+ * lower bound. --calibrate replaces it with one fitted to the robot: the mean times of the pose and
+ * arcade regions in a loop_stats.txt from the brain's SD card, against the odometry and arcade
+ * benchmarks here. --factor sets it directly. --save writes the brain estimates as a baseline, and
+ * --baseline compares against one, failing when a median has grown by more than a fifth.
+ */
+
+extern lemlib::Chassis chassis;
+extern spf::DriveCurveTable throttleCurve;
+extern spf::DriveCurveTable steerCurve;
+extern lemlib::ControllerSettings linearController;
+extern pros::MotorGroup leftMotors;
+extern pros::MotorGroup rightMotors;
+extern spf::Odometry odometry;
+extern spf::TractionControl traction;
+
+namespace {
+
+// the brain's Cortex-A9 runs at 667 MHz, a dependent VMUL.F32 takes 5 cycles and a VADD.F32 4
+constexpr double brainClock = 667e6; // Hz
+constexpr double referenceCycles = 9; // per step of the reference chain
+constexpr int referenceSteps = 1000000;
+constexpr double regression = 0.2; // growth of a median over the baseline that fails
+constexpr int rounds = 3; // each benchmark keeps its best round
+
+/** the time per call of one benchmark, in nanoseconds on the host */
+struct Result {
+        const char* name;
+        double period; // ms, how often the robot runs it
+        double mean = 0, p50 = 0, p90 = 0, p99 = 0, max = 0;
+};
+
+std::vector<Result> results;
+volatile float sink; // keeps the results of the calls alive
+double clockCost = 0; // ns, reading the clock twice around nothing, taken off every batch
+
+double percentile(std::vector<double>& times, double fraction) {
+    const std::size_t index = std::min(times.size() - 1, std::size_t(fraction * times.size()));
+    std::nth_element(times.begin(), times.begin() + index, times.end());
+    return times[index];
+}
+
+/**
+ * time samples batches of calls to call(i), with between() run untimed before each batch
+ *
+ * @param period how often the robot makes the call, in milliseconds, to show the share of it used
+ */
+template <typename Between, typename Call>
+void measure(const char* name, double period, int samples, int batch, Between between, Call call) {
+    std::vector<double> times;
+    times.reserve(samples);
+    int i = 0;
+    // the first tenth warms the caches up and isn't kept
+    for (int sample = -samples / 10; sample < samples; sample++) {
+        between();
+        const auto start = std::chrono::steady_clock::now();
+        for (int k = 0; k < batch; k++) call(i++);
+        const auto end = std::chrono::steady_clock::now();
+        const double time = std::chrono::duration<double, std::nano>(end - start).count() - clockCost;
+        if (sample >= 0) times.push_back(std::max(0.0, time) / batch);
+    }
+    Result result {name, period};
+    double total = 0;
+    for (double time : times) total += time;
+    result.mean = total / times.size();
+    result.p50 = percentile(times, 0.5);
+    result.p90 = percentile(times, 0.9);
+    result.p99 = percentile(times, 0.99);
+    result.max = *std::max_element(times.begin(), times.end());
+    // of the rounds, the one the rest of the host got in the way of least
+    for (Result& previous : results) {
+        if (std::strcmp(previous.name, name)) continue;
+        if (result.p50 < previous.p50) previous = result;
+        return;
+    }
+    results.push_back(result);
+}
+
+/**
+ * the host's nanoseconds per step of a chain of dependent multiplies and adds, the median of a few
+ * runs. Timed the same way as the benchmarks, so a host that speeds up or slows down for a while
+ * moves both
+ */
+double referenceTime() {
+    std::vector<double> times;
+    for (int run = 0; run < 9; run++) {
+        float x = sink;
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < referenceSteps; i++) x = x * 0.9999f + 0.0001f;
+        const auto end = std::chrono::steady_clock::now();
+        sink = x;
+        times.push_back(std::chrono::duration<double, std::nano>(end - start).count() / referenceSteps);
+    }
+    return percentile(times, 0.5);
+}
+
+/** the least the clock takes to read twice */
+double clockTime() {
+    double best = 1e9;
+    for (int i = 0; i < 10000; i++) {
+        const auto start = std::chrono::steady_clock::now();
+        const auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count());
+    }
+    return best;
+}
+
+const Result* find(const char* name) {
+    for (const Result& result : results) {
+        if (!std::strcmp(result.name, name)) return &result;
+    }
+    return nullptr;
+}
+
+/** the mean time of a profiled region in a loop stats file from the brain, in us, or -1 */
+double regionMean(const char* file, const char* region) {
+    std::FILE* in = std::fopen(file, "r");
+    if (in == nullptr) return -1;
+    char line[256], name[64];
+    double mean = -1;
+    bool found = false;
+    while (std::fgets(line, sizeof(line), in) != nullptr) {
+        // the last run in the file, which is appended to every time the robot is disabled
+        if (std::sscanf(line, "region %63[^:]:", name) == 1) found = !std::strcmp(name, region);
+        else if (found && std::sscanf(line, " runtime mean %lf us", &mean) == 1) found = false;
+    }
+    std::fclose(in);
+    return mean;
+}
+
+/** how much slower the brain is, from its own profiled regions. 0 if the file doesn't have them */
+double calibrate(const char* file) {
+    const std::pair<const char*, const char*> pairs[] = {{"pose", "odometry"}, {"arcade", "arcade"}};
+    double logs = 0;
+    int count = 0;
+    for (const auto& [region, benchmark] : pairs) {
+        const double brain = regionMean(file, region);
+        const Result* host = find(benchmark);
+        if (brain <= 0 || host == nullptr) continue;
+        std::printf("calibrating: region %s %.1f us on the brain, %.3f us here\n", region, brain, host->mean / 1e3);
+        logs += std::log(brain * 1e3 / host->mean);
+        count++;
+    }
+    return count > 0 ? std::exp(logs / count) : 0;
+}
+
+bool save(const char* file, double factor) {
+    std::FILE* out = std::fopen(file, "w");
+    if (out == nullptr) return false;
+    std::fprintf(out, "# spf_bench: estimated brain time per call in us, median and 99th percentile, factor %.2f\n",
+                 factor);
+    for (const Result& result : results) {
+        std::fprintf(out, "%s %.4f %.4f\n", result.name, result.p50 * factor / 1e3, result.p99 * factor / 1e3);
+    }
+    return std::fclose(out) == 0;
+}
+
+/** print how each median compares with a baseline. Returns how many have regressed, -1 without one */
+int compare(const char* file, double factor) {
+    std::FILE* in = std::fopen(file, "r");
+    if (in == nullptr) return -1;
+    int regressed = 0;
+    char line[256], name[64];
+    double p50, p99;
+    std::printf("\nagainst %s:\n", file);
+    while (std::fgets(line, sizeof(line), in) != nullptr) {
+        // names have spaces in them, the two numbers are the last fields
+        char* last = std::strrchr(line, ' ');
+        if (line[0] == '#' || last == nullptr) continue;
+        *last = '\0';
+        char* middle = std::strrchr(line, ' ');
+        if (middle == nullptr) continue;
+        *middle = '\0';
+        if (std::sscanf(middle + 1, "%lf", &p50) != 1 || std::sscanf(last + 1, "%lf", &p99) != 1) continue;
+        std::snprintf(name, sizeof(name), "%.*s", int(sizeof(name)) - 1, line);
+        const Result* result = find(name);
+        if (result == nullptr || p50 <= 0) continue;
+        const double now = result->p50 * factor / 1e3;
+        const double change = now / p50 - 1;
+        const bool worse = change > regression;
+        regressed += worse;
+        std::printf("  %-12s %8.3f us, was %8.3f us, %+6.1f%%%s\n", name, now, p50, change * 100,
+                    worse ? "  SLOWER" : "");
+    }
+    std::fclose(in);
+    return regressed;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int samples = 2000;
+    double factor = 0;
+    const char* calibration = nullptr;
+    const char* saveFile = nullptr;
+    const char* baselineFile = nullptr;
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--samples") && hasValue) samples = std::max(10, std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--factor") && hasValue) factor = std::atof(argv[++i]);
+        else if (!std::strcmp(argv[i], "--calibrate") && hasValue) calibration = argv[++i];
+        else if (!std::strcmp(argv[i], "--save") && hasValue) saveFile = argv[++i];
+        else if (!std::strcmp(argv[i], "--baseline") && hasValue) baselineFile = argv[++i];
+        else {
+            std::fprintf(stderr,
+                         "usage: spf_bench [--samples N] [--factor F] [--calibrate FILE] [--save FILE] "
+                         "[--baseline FILE]\n");
+            return 2;
+        }
+    }
+    lemlib::telemetrySink()->enabled = false;
+
+    // somewhere the drive can circle without reaching a wall or the barrier
+    sim::WorldConfig config;
+    config.start = {24, -44, 0};
+    sim::World world(config);
+    sim::setWorld(&world);
+
+    // only this task runs, so nothing else is timed with the calls. The simulated clock only moves
+    // between batches, when the odometry benchmark lets the drive move on
+    sim::Runtime::get().run(
+        [&] {
+            clockCost = clockTime();
+            odometry.calibrate();
+            chassis.setPose(24, -44, 0);
+            leftMotors.move_voltage(6000);
+            rightMotors.move_voltage(3000);
+            pros::delay(500);
+
+            for (int round = 0; round < rounds; round++) {
+                measure("drive curves", 10, samples, 64, [] {}, [](int i) {
+                    const float stick = i % 255 - 127;
+                    sink = throttleCurve.curve(stick) + steerCurve.curve(-stick);
+                });
+                measure("arcade", 10, samples, 16, [] {}, [](int i) {
+                    traction.arcade(i % 255 - 127, (i * 7) % 255 - 127);
+                });
+                // the arcade left the drive wherever the last call put it
+                leftMotors.move_voltage(6000);
+                rightMotors.move_voltage(3000);
+                measure("odometry", spf::Odometry::period, samples, 1, [] { pros::delay(spf::Odometry::period); },
+                        [](int) { odometry.update(); });
+                lemlib::PID pid(linearController.kP, linearController.kI, linearController.kD,
+                                linearController.windupRange);
+                measure("pid", 10, samples, 64, [] {}, [&pid](int i) { sink = pid.update(24 - (i % 480) * 0.1f); });
+                measure("pose text", 50, samples, 16, [] {}, [](int i) {
+                    char text[48];
+                    const float value = (i % 1000) * 0.37f - 185;
+                    std::snprintf(text, sizeof(text), "X: %.2f", value);
+                    std::snprintf(text, sizeof(text), "Y: %.2f", -value);
+                    std::snprintf(text, sizeof(text), "Theta: %.2f", value * 3);
+                    sink = text[4];
+                });
+            }
+            leftMotors.move_voltage(0);
+            rightMotors.move_voltage(0);
+        },
+        [&](std::uint64_t nowUs) { world.step(nowUs); });
+
+    const char* source = "set";
+    if (calibration != nullptr) {
+        factor = calibrate(calibration);
+        if (factor <= 0) {
+            std::fprintf(stderr, "%s: no pose or arcade region to calibrate with\n", calibration);
+            return 1;
+        }
+        source = "calibrated on the brain";
+    } else if (factor <= 0) {
+        const double host = referenceTime();
+        factor = referenceCycles / brainClock * 1e9 / host;
+        source = "from the reference chain, a lower bound";
+    }
+
+    std::printf("%-12s %9s | %8s %8s %8s %8s %8s | %9s %9s %8s\n", "", "calls", "mean", "p50", "p90", "p99",
+                "max", "brain p50", "brain p99", "of tick");
+    for (const Result& result : results) {
+        const double brain = result.p99 * factor / 1e3; // us
+        std::printf("%-12s %9d | %8.1f %8.1f %8.1f %8.1f %8.1f | %9.3f %9.3f %7.3f%%\n", result.name, samples,
+                    result.mean, result.p50, result.p90, result.p99, result.max, result.p50 * factor / 1e3, brain,
+                    brain / (result.period * 1e3) * 100);
+    }
+    std::printf("host times in ns per call, brain estimates in us at %.2fx the host, %s\n", factor, source);
+
+    if (saveFile != nullptr && !save(saveFile, factor)) {
+        std::fprintf(stderr, "%s: can't write the baseline\n", saveFile);
+        return 1;
+    }
+    if (baselineFile != nullptr) {
+        const int regressed = compare(baselineFile, factor);
+        if (regressed < 0) {
+            std::fprintf(stderr, "%s: can't read the baseline\n", baselineFile);
+            return 1;
+        }
+        if (regressed > 0) return 1;
+    }
+    return 0;
+}
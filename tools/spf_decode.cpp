@@ -0,0 +1,93 @@
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+
+#include "spf/telemetryRecord.hpp"
+
+/**
+ * Turns a binary telemetry log from the SD card into CSV
+ *
+ * spf_decode LOG.bin [OUT.csv]
+ *
+ * Writes to stdout without an output file. A summary of the log, including gaps where records
+ * were dropped, goes to stderr.
+ */
+
+namespace {
+
+constexpr const char* motorNames[] = {"lF", "lM", "lR", "lB", "rF", "rM", "rR", "rB"};
+constexpr const char* axisNames[] = {"lx", "ly", "rx", "ry"};
+constexpr const char* outputNames[] = {"wings1", "wings2", "intake", "slipping", "traction"};
+
+void writeHeader(std::FILE* out) {
+    std::fprintf(out, "time_ms,x,y,theta");
+    for (const char* motor : motorNames) std::fprintf(out, ",%s_rpm", motor);
+    for (const char* motor : motorNames) std::fprintf(out, ",%s_ma", motor);
+    for (const char* motor : motorNames) std::fprintf(out, ",%s_c", motor);
+    for (const char* axis : axisNames) std::fprintf(out, ",%s", axis);
+    for (const char* output : outputNames) std::fprintf(out, ",%s", output);
+    std::fprintf(out, ",motion,battery_mv\n");
+}
+
+void writeRecord(std::FILE* out, const spf::TelemetryRecord& record) {
+    std::fprintf(out, "%lu,%.3f,%.3f,%.2f", (unsigned long)record.time, record.x, record.y, record.theta);
+    for (auto velocity : record.velocity) std::fprintf(out, ",%d", velocity);
+    for (auto current : record.current) std::fprintf(out, ",%d", current);
+    for (auto temperature : record.temperature) std::fprintf(out, ",%d", temperature);
+    for (auto axis : record.axes) std::fprintf(out, ",%d", axis);
+    for (int i = 0; i < 5; i++) std::fprintf(out, ",%d", (record.outputs >> i) & 1);
+    const auto motion = static_cast<std::size_t>(record.motion);
+    std::fprintf(out, ",%s,%u\n", motion < std::size(spf::motionNames) ? spf::motionNames[motion] : "?",
+                 record.battery);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        std::fprintf(stderr, "usage: spf_decode LOG.bin [OUT.csv]\n");
+        return 2;
+    }
+    std::FILE* in = std::fopen(argv[1], "rb");
+    if (in == nullptr) {
+        std::perror(argv[1]);
+        return 1;
+    }
+    spf::TelemetryHeader header;
+    if (std::fread(&header, sizeof(header), 1, in) != 1 || std::memcmp(header.magic, "SPFT", 4) != 0) {
+        std::fprintf(stderr, "%s: not a telemetry log\n", argv[1]);
+        return 1;
+    }
+    if (header.version != 1 || header.recordSize != sizeof(spf::TelemetryRecord)) {
+        std::fprintf(stderr, "%s: log version %u with %u byte records, this reads version 1 with %zu\n", argv[1],
+                     header.version, header.recordSize, sizeof(spf::TelemetryRecord));
+        return 1;
+    }
+    std::FILE* out = argc == 3 ? std::fopen(argv[2], "w") : stdout;
+    if (out == nullptr) {
+        std::perror(argv[2]);
+        return 1;
+    }
+
+    writeHeader(out);
+    spf::TelemetryRecord record;
+    unsigned long count = 0, gaps = 0, missing = 0;
+    std::uint32_t first = 0, last = 0;
+    while (std::fread(&record, sizeof(record), 1, in) == 1) {
+        if (count == 0) first = record.time;
+        // records are 10 ms apart, anything longer is ticks the loop skipped or records the ring dropped
+        else if (record.time - last > 15) {
+            gaps++;
+            missing += (record.time - last + 5) / 10 - 1;
+        }
+        last = record.time;
+        writeRecord(out, record);
+        count++;
+    }
+    if (out != stdout) std::fclose(out);
+    std::fclose(in);
+
+    std::fprintf(stderr, "%lu records, %.2f s from %.2f s after startup, %lu gaps missing %lu records\n", count,
+                 count > 0 ? (last - first) / 1e3 : 0.0, first / 1e3, gaps, missing);
+    return 0;
+}
@@ -0,0 +1,251 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "lemlib/api.hpp"
+#include "main.h"
+#include "sim/parallel.hpp"
+#include "sim/runtime.hpp"
+#include "sim/world.hpp"
+#include "spf/pathFile.hpp"
+#include "spf/route.hpp"
+#include "spf/startup.hpp"
+
+/**
+ * Monte Carlo robustness and timing of the autonomous routes
+ *
+ * spf_montecarlo [--runs N] [--routes 1,2] [--spread F] [--jobs N]
+ *
+ * Runs initialize() and autonomous() N times for each route, each time with the robot put down a
+ * little off its start pose and with different traction, omni slide, tracking wheel scrub, IMU
+ * drift, battery charge and motor temperature, scaled by --spread. Each run is its own process,
+ * --jobs of them at once, by default one per host core.
+ *
+ * For each route it reports the distribution of the time autonomous takes, how far from the
+ * route's final pose the robot ends up, and how often an output the unperturbed robot sets is
+ * never set, e.g. because the 15 s ran out first. A route is ready when 99% of runs finish inside
+ * the 15 s.
+ */
+
+extern int autonRoute;
+extern lemlib::Chassis chassis;
+extern std::vector<spf::Route> routes;
+extern spf::Startup startup;
+
+namespace {
+
+constexpr std::uint64_t autonLength = 15000000; // us
+constexpr std::size_t maxEvents = 48;
+
+struct Result {
+        bool finished = false;
+        double time = 0; // s, the whole 15 s for runs that didn't finish
+        double position = 0; // in from the route's final pose
+        double heading = 0; // deg from it
+        std::size_t events = 0;
+        sim::AdiEvent event[maxEvents]; // pneumatic outputs set during autonomous, in order
+};
+
+struct Options {
+        int runs = 1000;
+        std::vector<int> routes;
+        double spread = 1;
+        int jobs = 1;
+};
+
+/** the robot for one run, run 0 is the unperturbed robot the others are compared against */
+sim::WorldConfig perturbed(std::size_t run, double spread) {
+    sim::WorldConfig config;
+    if (run == 0) return config;
+    config.seed = 5000 + run;
+    std::mt19937 random(config.seed);
+    std::uniform_real_distribution<double> unit(-1, 1);
+    std::uniform_real_distribution<double> positive(0, 1);
+    std::normal_distribution<double> normal(0, 1);
+    // put down by hand against the field tiles, routes without a setPose start off the origin
+    config.placementError = {0.5 * spread * normal(random), 0.5 * spread * normal(random), spread * normal(random)};
+    config.start = config.placementError;
+    config.traction *= 1 + 0.1 * spread * unit(random);
+    config.lateralTraction *= 1 + 0.2 * spread * unit(random);
+    config.trackerScrub = std::max(0.0, config.trackerScrub + 0.02 * spread * unit(random));
+    config.imuDriftDegPerMin = spread * unit(random);
+    config.batteryVolts -= 1.2 * spread * positive(random);
+    config.startTempC += 25 * spread * positive(random);
+    return config;
+}
+
+/** where a route's steps leave the robot, in inches and compass degrees */
+lemlib::Pose finalPose(const spf::Route& route) {
+    lemlib::Pose pose(0, 0, 0);
+    for (const spf::Step& step : route.steps) {
+        switch (step.type) {
+            case spf::StepType::SetPose:
+            case spf::StepType::Move: pose = lemlib::Pose(step.x, step.y, step.theta); break;
+            case spf::StepType::SetX: pose.x = step.x; break;
+            case spf::StepType::Turn: pose.theta = step.theta; break;
+            case spf::StepType::Follow: {
+                const spf::PathFile path(step.path->buf, step.path->size);
+                if (!path.valid()) break;
+                const spf::PathFilePoint end = path.at(path.size() - 1);
+                pose = lemlib::Pose(end.x, end.y, lemlib::radToDeg(end.heading) + (step.options.forwards ? 0 : 180));
+                break;
+            }
+            default: break;
+        }
+    }
+    return pose;
+}
+
+Result run(int route, std::size_t index, double spread) {
+    sim::World world(perturbed(index, spread));
+    sim::setWorld(&world);
+    autonRoute = route;
+
+    Result result;
+    std::uint64_t start = 0;
+    sim::Runtime& runtime = sim::Runtime::get();
+    runtime.run(
+        [&] {
+            initialize();
+            // the robot sits on the field for a while before the match, calibrated by the time it starts
+            startup.waitReady();
+            competition_initialize();
+            start = runtime.nowUs();
+            pros::Task auton(autonomous, "autonomous");
+            while (runtime.nowUs() - start < autonLength) {
+                pros::delay(10);
+                if (auton.get_state() == pros::E_TASK_STATE_DELETED && !chassis.isInMotion()) {
+                    result.finished = true;
+                    break;
+                }
+            }
+            result.time = (runtime.nowUs() - start) / 1e6;
+            auton.remove();
+            chassis.cancelAllMotions();
+        },
+        [&](std::uint64_t nowUs) { world.step(nowUs); });
+
+    for (const spf::Route& candidate : routes) {
+        if (candidate.id != route) continue;
+        const lemlib::Pose target = finalPose(candidate);
+        const sim::FieldPose truth = world.truePose();
+        result.position = std::hypot(truth.x - target.x, truth.y - target.y);
+        result.heading = std::fabs(std::remainder(truth.theta - target.theta, 360));
+    }
+    for (const sim::AdiEvent& event : world.adiEvents()) {
+        if (event.timeUs >= start && result.events < maxEvents) result.event[result.events++] = event;
+    }
+    return result;
+}
+
+/** outputs the unperturbed run set that a run never did, matched in order */
+int missedActions(const Result& nominal, const Result& result) {
+    int missed = 0;
+    std::size_t next = 0;
+    for (std::size_t i = 0; i < nominal.events; i++) {
+        std::size_t j = next;
+        while (j < result.events &&
+               (result.event[j].port != nominal.event[i].port || result.event[j].value != nominal.event[i].value)) {
+            j++;
+        }
+        if (j == result.events) missed++;
+        else next = j + 1;
+    }
+    return missed;
+}
+
+/** the value q of the way through sorted values, 0 to 1 */
+double percentile(const std::vector<double>& sorted, double q) {
+    if (sorted.empty()) return 0;
+    const std::size_t index = std::size_t(std::ceil(q * sorted.size()));
+    return sorted[std::clamp<std::size_t>(index, 1, sorted.size()) - 1];
+}
+
+bool parse(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--runs") && hasValue) options.runs = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--routes") && hasValue) {
+            for (char* token = std::strtok(argv[++i], ","); token != nullptr; token = std::strtok(nullptr, ",")) {
+                options.routes.push_back(std::atoi(token));
+            }
+        } else if (!std::strcmp(argv[i], "--spread") && hasValue) options.spread = std::atof(argv[++i]);
+        else if (!std::strcmp(argv[i], "--jobs") && hasValue) options.jobs = std::atoi(argv[++i]);
+        else return false;
+    }
+    return options.runs > 0 && options.jobs > 0 && options.spread >= 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    options.jobs = sim::hostCores();
+    if (!parse(argc, argv, options)) {
+        std::fprintf(stderr, "usage: spf_montecarlo [--runs N] [--routes 1,2] [--spread F] [--jobs N]\n");
+        return 2;
+    }
+    if (options.routes.empty()) {
+        for (const spf::Route& route : routes) options.routes.push_back(route.id);
+    }
+    lemlib::telemetrySink()->enabled = false;
+
+    std::printf("%d runs of each route, %d jobs\n\n", options.runs, options.jobs);
+    std::printf("%-16s %5s %7s | %-27s | %-20s | %6s | %7s\n", "", "", "", "time, s", "end position, in",
+                "deg", "missed");
+    std::printf("%-16s %5s %7s | %6s %6s %6s %6s | %6s %6s %6s | %6s | %7s\n", "route", "runs", "in 15 s", "p50",
+                "p90", "p99", "max", "p50", "p99", "max", "p99", "runs");
+    std::vector<std::string> verdicts;
+    for (int route : options.routes) {
+        const auto name = std::find_if(routes.begin(), routes.end(), [&](const spf::Route& r) { return r.id == route; });
+        if (name == routes.end()) {
+            std::fprintf(stderr, "there is no route %d\n", route);
+            continue;
+        }
+        // run 0 is the unperturbed robot
+        const std::vector<std::optional<Result>> results = sim::runParallel<Result>(
+            options.runs + 1, options.jobs, [&](std::size_t i) { return run(route, i, options.spread); });
+        if (!results[0]) {
+            std::fprintf(stderr, "route %d: the unperturbed run failed\n", route);
+            continue;
+        }
+
+        std::vector<double> times, positions, headings;
+        int finished = 0, missing = 0;
+        for (std::size_t i = 1; i < results.size(); i++) {
+            if (!results[i]) continue;
+            times.push_back(results[i]->time);
+            positions.push_back(results[i]->position);
+            headings.push_back(results[i]->heading);
+            finished += results[i]->finished;
+            missing += missedActions(*results[0], *results[i]) > 0;
+        }
+        if (times.empty()) continue;
+        std::sort(times.begin(), times.end());
+        std::sort(positions.begin(), positions.end());
+        std::sort(headings.begin(), headings.end());
+        const double n = times.size();
+        const std::string label = std::to_string(route) + " " + name->name;
+        std::printf("%-16.16s %5zu %6.1f%% | %6.2f %6.2f %6.2f %6.2f | %6.2f %6.2f %6.2f | %6.1f | %6.1f%%\n",
+                    label.c_str(), times.size(), 100 * finished / n, percentile(times, 0.5), percentile(times, 0.9),
+                    percentile(times, 0.99), times.back(), percentile(positions, 0.5), percentile(positions, 0.99),
+                    positions.back(), percentile(headings, 0.99), 100 * missing / n);
+
+        char verdict[160];
+        const bool ready = finished >= 0.99 * n;
+        std::snprintf(verdict, sizeof(verdict), "route %d: %s, %.1f%% of runs finish inside 15 s%s", route,
+                      ready ? "ready" : "NOT ready", 100 * finished / n,
+                      int(results.size() - 1) > int(n) ? " (some runs failed to simulate)" : "");
+        verdicts.push_back(verdict);
+    }
+    std::printf("\nruns that didn't finish count as the full 15 s. Missed: runs that never set an output the\n"
+                "unperturbed robot sets\n\n");
+    for (const std::string& verdict : verdicts) std::printf("%s\n", verdict.c_str());
+    return 0;
+}
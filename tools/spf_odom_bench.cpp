@@ -0,0 +1,212 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include "lemlib/api.hpp"
+#include "main.h"
+#include "sim/runtime.hpp"
+#include "sim/world.hpp"
+#include "spf/startup.hpp"
+
+/**
+ * Measures odometry drift against the simulator's ground truth
+ *
+ * spf_odom_bench [--runs N] [--routes 1,2,5,6]
+ *
+ * Runs each autonomous route, and a hard driving script with wheelspin, N times with different
+ * traction, IMU drift and tracking wheel scrub, each run in its own process. Alongside the robot's
+ * fused odometry it integrates the drive encoders and IMU the way LemLib's default odometry does,
+ * from the same sensors and picking up the same resets, so the two can be compared.
+ */
+
+extern lemlib::Chassis chassis;
+extern int autonRoute;
+extern pros::MotorGroup leftMotors;
+extern pros::MotorGroup rightMotors;
+extern pros::Imu imu;
+extern spf::Startup startup;
+
+namespace {
+
+struct Result {
+        double distance = 0; // in driven
+        double fusedFinal = 0, fusedMax = 0, fusedSquares = 0, fusedHeading = 0;
+        double baseFinal = 0, baseMax = 0, baseSquares = 0, baseHeading = 0;
+        int samples = 0;
+};
+
+/** launches, spins and reversals at full power, to make the drive wheels slip */
+void hardDriver(std::uint64_t nowUs, sim::ControllerState& pad) {
+    const double t = (nowUs % 8000000) / 1e6;
+    pad = {};
+    if (t < 1.2) pad.analog[1] = 127;
+    else if (t < 2.0) pad.analog[1] = -127;
+    else if (t < 3.0) pad.analog[2] = 127;
+    else if (t < 4.5) {
+        pad.analog[1] = 127;
+        pad.analog[2] = -80;
+    } else if (t < 5.5) pad.analog[1] = -127;
+    else if (t < 6.5) {
+        pad.analog[1] = 127;
+        pad.analog[2] = 127;
+    }
+}
+
+Result run(int route, std::uint32_t seed) {
+    sim::WorldConfig config;
+    config.seed = seed;
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<double> unit(-1, 1);
+    config.traction *= 1 + 0.1 * unit(random);
+    config.lateralTraction *= 1 + 0.2 * unit(random);
+    config.imuDriftDegPerMin = unit(random);
+    config.trackerScrub = 0.03 + 0.02 * unit(random);
+    sim::World world(config);
+    sim::setWorld(&world);
+    if (route > 0) autonRoute = route;
+
+    // LemLib's default odometry: the left drive encoders along the IMU heading
+    const lemlib::Drivetrain drive(&leftMotors, &rightMotors, 11, lemlib::Omniwheel::NEW_325, 600, 2);
+    lemlib::TrackingWheel encoder(drive.leftMotors, drive.wheelDiameter, -drive.trackWidth / 2, drive.rpm);
+    lemlib::Pose base(0, 0, 0), last(0, 0, 0);
+    float previousDistance = 0, previousHeading = 0;
+    bool tracking = false;
+    sim::FieldPose lastTruth;
+
+    Result result;
+    world.observers.push_back([&](sim::World& w) {
+        if (w.nowUs() % 5000 != 0 || w.nowUs() < 2100000) return;
+        const lemlib::Pose fused = chassis.getPose(true);
+        const float distance = encoder.getDistanceTraveled();
+        const float heading = lemlib::degToRad(imu.get_rotation());
+        // a jump in the robot's pose is a setPose, which the baseline takes too
+        if (!tracking || std::hypot(fused.x - last.x, fused.y - last.y) > 2 ||
+            std::fabs(fused.theta - last.theta) > 0.1) {
+            base = fused;
+            tracking = true;
+        } else {
+            const float deltaHeading = heading - previousHeading;
+            const float deltaDistance = distance - previousDistance;
+            float local = deltaDistance;
+            if (deltaHeading != 0) local = 2 * std::sin(deltaHeading / 2) * (deltaDistance / deltaHeading - drive.trackWidth / 2);
+            const float mid = base.theta + deltaHeading / 2;
+            base.x += local * std::sin(mid);
+            base.y += local * std::cos(mid);
+            base.theta += deltaHeading;
+        }
+        previousDistance = distance;
+        previousHeading = heading;
+        last = fused;
+
+        const sim::FieldPose truth = w.truePose();
+        if (result.samples > 0) result.distance += std::hypot(truth.x - lastTruth.x, truth.y - lastTruth.y);
+        lastTruth = truth;
+        const double fusedError = std::hypot(truth.x - fused.x, truth.y - fused.y);
+        const double baseError = std::hypot(truth.x - base.x, truth.y - base.y);
+        result.fusedFinal = fusedError;
+        result.baseFinal = baseError;
+        result.fusedMax = std::max(result.fusedMax, fusedError);
+        result.baseMax = std::max(result.baseMax, baseError);
+        result.fusedSquares += fusedError * fusedError;
+        result.baseSquares += baseError * baseError;
+        result.fusedHeading = std::fabs(std::remainder(truth.theta - lemlib::radToDeg(fused.theta), 360));
+        result.baseHeading = std::fabs(std::remainder(truth.theta - lemlib::radToDeg(base.theta), 360));
+        result.samples++;
+    });
+
+    sim::Runtime::get().run(
+        [&] {
+            initialize();
+            // the robot sits on the field for a while before the match, calibrated by the time it starts
+            startup.waitReady();
+            if (route > 0) {
+                pros::Task auton(autonomous, "autonomous");
+                pros::delay(15000);
+                auton.remove();
+            } else {
+                world.driver = hardDriver;
+                pros::Task driver(opcontrol, "opcontrol");
+                pros::delay(30000);
+                driver.remove();
+            }
+        },
+        [&](std::uint64_t nowUs) { world.step(nowUs); });
+    return result;
+}
+
+/** run in a child process, since the robot program's globals only run once */
+bool runIsolated(int route, std::uint32_t seed, Result& result) {
+    int fds[2];
+    if (pipe(fds) != 0) return false;
+    const pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        const Result child = run(route, seed);
+        const bool ok = write(fds[1], &child, sizeof(child)) == sizeof(child);
+        _exit(ok ? 0 : 1);
+    }
+    close(fds[1]);
+    const bool ok = pid > 0 && read(fds[0], &result, sizeof(result)) == sizeof(result);
+    close(fds[0]);
+    int status = 0;
+    if (pid > 0) waitpid(pid, &status, 0);
+    return ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int runs = 5;
+    std::vector<int> routes = {1, 2, 5, 6};
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--runs") && i + 1 < argc) runs = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--routes") && i + 1 < argc) {
+            routes.clear();
+            for (char* token = std::strtok(argv[++i], ","); token != nullptr; token = std::strtok(nullptr, ",")) {
+                routes.push_back(std::atoi(token));
+            }
+        } else {
+            std::fprintf(stderr, "usage: spf_odom_bench [--runs N] [--routes 1,2,5,6]\n");
+            return 2;
+        }
+    }
+    lemlib::telemetrySink()->enabled = false;
+    routes.push_back(0); // the driving script
+
+    std::printf("%-8s %8s | %-28s | %-28s\n", "", "", "fused odometry", "drive encoders + IMU");
+    std::printf("%-8s %8s | %6s %6s %6s %6s | %6s %6s %6s %6s\n", "run", "in", "final", "max", "rms", "deg",
+                "final", "max", "rms", "deg");
+    for (int route : routes) {
+        Result total;
+        int done = 0;
+        for (int i = 0; i < runs; i++) {
+            Result result;
+            if (!runIsolated(route, 1000 + i, result) || result.samples == 0) continue;
+            total.distance += result.distance;
+            total.fusedFinal += result.fusedFinal;
+            total.fusedMax = std::max(total.fusedMax, result.fusedMax);
+            total.fusedSquares += result.fusedSquares / result.samples;
+            total.fusedHeading += result.fusedHeading;
+            total.baseFinal += result.baseFinal;
+            total.baseMax = std::max(total.baseMax, result.baseMax);
+            total.baseSquares += result.baseSquares / result.samples;
+            total.baseHeading += result.baseHeading;
+            done++;
+        }
+        if (done == 0) continue;
+        const std::string name = route > 0 ? "route " + std::to_string(route) : "driving";
+        // final and rms are means over the runs, max is the worst of them
+        std::printf("%-8s %8.0f | %6.2f %6.2f %6.2f %6.2f | %6.2f %6.2f %6.2f %6.2f\n", name.c_str(),
+                    total.distance / done, total.fusedFinal / done, total.fusedMax, std::sqrt(total.fusedSquares / done),
+                    total.fusedHeading / done, total.baseFinal / done, total.baseMax,
+                    std::sqrt(total.baseSquares / done), total.baseHeading / done);
+    }
+    std::printf("errors in inches, heading error at the end in degrees\n");
+    return 0;
+}
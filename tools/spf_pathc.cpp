@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "robot.hpp"
+#include "spf/pathFile.hpp"
+#include "spf/profile.hpp"
+
+/**
+ * Compiles a path.jerryio text path into the binary file the robot follows
+ *
+ * spf_pathc [--spacing IN] PATH.txt OUT.bin
+ *
+ * Run by the host build for every path in static/; the .bin files it writes are committed next
+ * to the text, so the PROS build embeds them without running anything. The text is resampled to
+ * evenly spaced points, and each gets its arc length, curvature and the speed the robot can take
+ * it at, so the robot does no parsing or planning before it moves.
+ */
+
+namespace {
+
+// the drive limits the routes are compiled with, from the same robot. Following a path doesn't
+// need the feedforward gains
+const spf::DriveModel driveModel(robot.trackWidth, robot.wheelDiameter, robot.wheelRpm, robot.cartridgeRpm,
+                                 driveLimits.speedHeadroom, driveLimits.maxAcceleration, driveLimits.maxDeceleration,
+                                 driveLimits.maxLateralAcceleration, 0, 0, 0, 0);
+
+// curvature is measured over a chord this long, so the corners between the text points don't
+// show up as spikes, in inches
+constexpr float curvatureSpan = 4;
+
+struct TextPoint {
+        float x;
+        float y;
+        float speed; // out of 127
+};
+
+/** the points of a path.jerryio file, up to endData */
+std::vector<TextPoint> readText(const char* name) {
+    std::vector<TextPoint> points;
+    std::FILE* in = std::fopen(name, "r");
+    if (in == nullptr) return points;
+    char line[256];
+    while (std::fgets(line, sizeof(line), in) != nullptr) {
+        if (std::strncmp(line, "endData", 7) == 0) break;
+        TextPoint point;
+        if (std::sscanf(line, "%f, %f, %f", &point.x, &point.y, &point.speed) == 3) points.push_back(point);
+    }
+    std::fclose(in);
+    return points;
+}
+
+/** signed curvature of the circle through three points, positive when turning right */
+float curvature(float ax, float ay, float bx, float by, float cx, float cy) {
+    const float cross = (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+    const float sides = std::hypot(bx - ax, by - ay) * std::hypot(cx - bx, cy - by) * std::hypot(cx - ax, cy - ay);
+    // the cross product is counterclockwise positive
+    return sides > 1e-9 ? -2 * cross / sides : 0;
+}
+
+/** the text points resampled every spacing inches, with heading and curvature */
+std::vector<spf::PathPoint> resample(const std::vector<TextPoint>& text, float spacing, float& length) {
+    std::vector<float> distances(text.size(), 0);
+    for (std::size_t i = 1; i < text.size(); i++) {
+        distances[i] = distances[i - 1] + std::hypot(text[i].x - text[i - 1].x, text[i].y - text[i - 1].y);
+    }
+    length = distances.back();
+    const int count = std::max(1, int(std::round(length / spacing)));
+    std::vector<spf::PathPoint> path;
+    path.reserve(count + 1);
+    std::size_t j = 0;
+    for (int i = 0; i <= count; i++) {
+        const float s = length * i / count;
+        while (j + 2 < text.size() && distances[j + 1] < s) j++;
+        const float span = distances[j + 1] - distances[j];
+        const float t = span > 0 ? std::clamp((s - distances[j]) / span, 0.0f, 1.0f) : 0;
+        // the speed of a text point holds until the next point
+        path.push_back({text[j].x + (text[j + 1].x - text[j].x) * t, text[j].y + (text[j + 1].y - text[j].y) * t, 0,
+                        0, driveModel.maxVelocity() * text[j].speed / 127});
+    }
+
+    const int half = std::max(1, int(std::round(curvatureSpan / 2 / (length / count))));
+    std::vector<float> raw(count + 1, 0);
+    for (int i = 0; i <= count; i++) {
+        const spf::PathPoint& a = path[std::max(i - half, 0)];
+        const spf::PathPoint& b = path[i];
+        const spf::PathPoint& c = path[std::min(i + half, count)];
+        path[i].heading = std::atan2(c.x - a.x, c.y - a.y);
+        if (i - half >= 0 && i + half <= count) raw[i] = curvature(a.x, a.y, b.x, b.y, c.x, c.y);
+    }
+    // then averaged over the same span, what's left of the corners would show up as jumps in the
+    // planned speed
+    for (int i = 0; i <= count; i++) {
+        const int from = std::max(i - half, 0);
+        const int to = std::min(i + half, count);
+        float sum = 0;
+        for (int j = from; j <= to; j++) sum += raw[j];
+        path[i].curvature = sum / (to - from + 1);
+    }
+    return path;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    float spacing = 0.5;
+    int arg = 1;
+    if (arg + 1 < argc && std::strcmp(argv[arg], "--spacing") == 0) {
+        spacing = std::atof(argv[arg + 1]);
+        arg += 2;
+    }
+    if (argc - arg != 2 || spacing <= 0) {
+        std::fprintf(stderr, "usage: spf_pathc [--spacing IN] PATH.txt OUT.bin\n");
+        return 2;
+    }
+    const char* inName = argv[arg];
+    const char* outName = argv[arg + 1];
+
+    const std::vector<TextPoint> text = readText(inName);
+    if (text.size() < 2) {
+        std::fprintf(stderr, "%s: not a path, expected \"x, y, speed\" lines up to endData\n", inName);
+        return 1;
+    }
+    float length = 0;
+    const std::vector<spf::PathPoint> path = resample(text, spacing, length);
+    if (length <= 0) {
+        std::fprintf(stderr, "%s: the path has no length\n", inName);
+        return 1;
+    }
+    const std::vector<float> velocities = spf::pathVelocities(path, driveModel);
+
+    spf::PathFileHeader header;
+    header.pointSize = sizeof(spf::PathFilePoint);
+    header.count = path.size();
+    header.spacing = length / (path.size() - 1);
+    header.length = length;
+    std::vector<spf::PathFilePoint> points;
+    points.reserve(path.size());
+    float time = 0;
+    for (std::size_t i = 0; i < path.size(); i++) {
+        // a = v dv/ds, between this point and the next
+        const std::size_t next = std::min(i + 1, path.size() - 1);
+        const float acceleration =
+            next > i ? (velocities[next] * velocities[next] - velocities[i] * velocities[i]) / (2 * header.spacing)
+                     : 0;
+        if (i > 0) time += 2 * header.spacing / std::max(velocities[i - 1] + velocities[i], 1e-3f);
+        points.push_back({path[i].x, path[i].y, header.spacing * i, path[i].heading, path[i].curvature,
+                          velocities[i], acceleration});
+    }
+
+    std::FILE* out = std::fopen(outName, "wb");
+    if (out == nullptr) {
+        std::perror(outName);
+        return 1;
+    }
+    const bool written = std::fwrite(&header, sizeof(header), 1, out) == 1 &&
+                         std::fwrite(points.data(), sizeof(spf::PathFilePoint), points.size(), out) == points.size();
+    if (std::fclose(out) != 0 || !written) {
+        std::fprintf(stderr, "%s: write failed\n", outName);
+        return 1;
+    }
+    std::printf("%s: %zu points, %.1f in, %.2f s planned\n", outName, points.size(), length, time);
+    return 0;
+}
@@ -0,0 +1,262 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include "lemlib/api.hpp"
+#include "display/lvgl.h"
+#include "main.h"
+#include "sim/runtime.hpp"
+#include "sim/world.hpp"
+#include "spf/driverInput.hpp"
+#include "spf/fieldMap.hpp"
+#include "spf/heap.hpp"
+#include "spf/profiler.hpp"
+#include "spf/route.hpp"
+#include "spf/scheduler.hpp"
+#include "spf/startup.hpp"
+#include "spf/telemetry.hpp"
+
+/**
+ * Runs the robot program in the simulator, faster than real time
+ *
+ * spf_sim [--route N] [--mode auton|driver|match] [--driver-time MS] [--seed N]
+ *         [--trace FILE] [--telemetry] [--loop-stats] [--sd DIR] [--start-temp C] [--replay FILE] [--map FILE]
+ *
+ * auton runs initialize() and then autonomous() for up to the 15 s period (a minute for skills,
+ * route 3), driver runs
+ * opcontrol() with a scripted driver, match does both back to back. Like the field, the run ends
+ * by disabling the robot. --loop-stats prints the timing, CPU share and stack use of the
+ * scheduler's loops and the timing of the profiled regions. --sd puts an SD card in the brain,
+ * backed by a directory, which is where the binary telemetry log ends up. --start-temp starts the
+ * motors warm, as they are late in a practice session. --replay plays an input log from the SD
+ * card back through a match, the recorded route and then the recorded driver control, and reports
+ * how far the robot strayed from the recorded poses. --map opens the field map on the brain screen
+ * and writes what it shows at the end to a PPM image.
+ */
+
+extern int autonRoute;
+extern lemlib::Chassis chassis;
+extern std::vector<spf::Route> routes;
+extern spf::Scheduler scheduler;
+extern spf::TelemetryLog telemetryLog;
+extern spf::DriverInput input;
+extern const char* replayFile;
+extern spf::Startup startup;
+extern spf::FieldMap fieldMap;
+
+namespace {
+
+struct Options {
+        int route = -1;
+        std::string mode = "auton";
+        int driverMs = 10000;
+        std::uint32_t seed = 1;
+        std::string trace;
+        bool telemetry = false;
+        bool loopStats = false;
+        std::string sdCard;
+        double startTemp = -1;
+        std::string replay;
+        std::string map;
+};
+
+/** a few seconds of driving that exercises the drive and the three pneumatic toggles */
+void scriptedDriver(std::uint64_t nowUs, sim::ControllerState& pad) {
+    const double t = (nowUs % 10000000) / 1e6; // repeat every 10 s
+    pad = {};
+    if (t < 1.5) pad.analog[1] = 127;
+    else if (t < 2.3) pad.analog[2] = 90;
+    else if (t < 4.0) pad.analog[1] = 100;
+    else if (t < 4.1) pad.digital[9] = true; // B: wings1
+    else if (t < 6.0) pad.analog[1] = -127;
+    else if (t < 6.1) pad.digital[10] = true; // Y: intake
+    else if (t < 7.5) pad.analog[2] = -127;
+    else if (t < 7.6) pad.digital[7] = true; // RIGHT: wings2
+    else if (t < 9.0) {
+        pad.analog[1] = 110;
+        pad.analog[2] = 40;
+    }
+}
+
+/** driver control samples in an input log, -1 if it isn't one */
+int countDriverTicks(const char* name) {
+    std::FILE* file = std::fopen(name, "rb");
+    if (file == nullptr) return -1;
+    spf::InputHeader header;
+    int ticks = -1;
+    if (std::fread(&header, sizeof(header), 1, file) == 1 && std::memcmp(header.magic, "SPFI", 4) == 0 &&
+        header.recordSize == sizeof(spf::InputRecord)) {
+        ticks = 0;
+        spf::InputRecord record;
+        while (std::fread(&record, sizeof(record), 1, file) == 1) ticks += record.mode == spf::InputMode::Driver;
+    }
+    std::fclose(file);
+    return ticks;
+}
+
+bool parse(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--route") && hasValue) options.route = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--mode") && hasValue) options.mode = argv[++i];
+        else if (!std::strcmp(argv[i], "--driver-time") && hasValue) options.driverMs = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--seed") && hasValue) options.seed = std::strtoul(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--trace") && hasValue) options.trace = argv[++i];
+        else if (!std::strcmp(argv[i], "--telemetry")) options.telemetry = true;
+        else if (!std::strcmp(argv[i], "--loop-stats")) options.loopStats = true;
+        else if (!std::strcmp(argv[i], "--sd") && hasValue) options.sdCard = argv[++i];
+        else if (!std::strcmp(argv[i], "--start-temp") && hasValue) options.startTemp = std::atof(argv[++i]);
+        else if (!std::strcmp(argv[i], "--replay") && hasValue) options.replay = argv[++i];
+        else if (!std::strcmp(argv[i], "--map") && hasValue) options.map = argv[++i];
+        else return false;
+    }
+    return options.mode == "auton" || options.mode == "driver" || options.mode == "match";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse(argc, argv, options)) {
+        std::fprintf(stderr,
+                     "usage: spf_sim [--route N] [--mode auton|driver|match] [--driver-time MS] [--seed N]\n"
+                     "               [--trace FILE] [--telemetry] [--loop-stats] [--sd DIR] [--start-temp C]\n"
+                     "               [--replay FILE] [--map FILE]\n");
+        return 2;
+    }
+    if (!options.replay.empty()) {
+        // the recording decides the route and how long driver control lasts
+        const int driverTicks = countDriverTicks(options.replay.c_str());
+        if (driverTicks < 0) {
+            std::fprintf(stderr, "%s: not an input log\n", options.replay.c_str());
+            return 1;
+        }
+        options.mode = "match";
+        options.driverMs = driverTicks * 10 + 100;
+        replayFile = options.replay.c_str();
+    }
+
+    sim::WorldConfig config;
+    config.seed = options.seed;
+    config.sdCard = options.sdCard;
+    if (options.startTemp >= 0) config.startTempC = options.startTemp;
+    sim::World world(config);
+    sim::setWorld(&world);
+    if (options.route >= 0) autonRoute = options.route;
+    lemlib::telemetrySink()->enabled = options.telemetry;
+
+    std::ofstream trace;
+    if (!options.trace.empty()) {
+        trace.open(options.trace);
+        trace << "time_ms,true_x,true_y,true_theta,odom_x,odom_y,odom_theta\n";
+        world.observers.push_back([&](sim::World& w) {
+            if (w.nowUs() % 10000 != 0) return;
+            const sim::FieldPose truth = w.truePose();
+            const lemlib::Pose odom = chassis.getPose();
+            trace << w.nowUs() / 1000 << ',' << truth.x << ',' << truth.y << ',' << truth.theta << ',' << odom.x
+                  << ',' << odom.y << ',' << odom.theta << '\n';
+        });
+    }
+
+    // how long any drive motor spends throttled by its firmware, and how hot they get
+    double throttledSeconds = 0;
+    double hottest = 0;
+    world.observers.push_back([&](sim::World& w) {
+        bool throttled = false;
+        for (const auto* side : {&w.config().leftDrive, &w.config().rightDrive}) {
+            for (const sim::DriveMotorSpec& spec : *side) {
+                hottest = std::max(hottest, w.motor(spec.port).temperature);
+                throttled = throttled || w.motor(spec.port).temperature >= 55;
+            }
+        }
+        if (throttled) throttledSeconds += 0.001;
+    });
+
+    double autonSeconds = -1;
+    spf::HeapStats heap;
+    const auto wallStart = std::chrono::steady_clock::now();
+    sim::Runtime& runtime = sim::Runtime::get();
+    runtime.run(
+        [&] {
+            initialize();
+            // the robot sits on the field for a while before the match, calibrated by the time it starts
+            startup.waitReady();
+            if (!options.map.empty()) fieldMap.setHidden(false);
+            if (options.mode != "driver") {
+                competition_initialize();
+                const std::uint64_t start = runtime.nowUs();
+                pros::Task auton(autonomous, "autonomous");
+                const std::uint64_t period = autonRoute == 3 ? 60000000 : 15000000;
+                while (runtime.nowUs() - start < period) {
+                    pros::delay(10);
+                    if (auton.get_state() == pros::E_TASK_STATE_DELETED && !chassis.isInMotion()) {
+                        autonSeconds = (runtime.nowUs() - start) / 1e6;
+                        break;
+                    }
+                }
+                auton.remove();
+                chassis.cancelAllMotions();
+            }
+            if (options.mode != "auton") {
+                if (options.replay.empty()) world.driver = scriptedDriver;
+                pros::Task driver(opcontrol, "opcontrol");
+                pros::delay(options.driverMs);
+                driver.remove();
+            }
+            // the match's heap use, before disabled() writes out stats and the run winds down
+            heap = spf::heapStats();
+            disabled();
+            // stay disabled long enough for the telemetry log to write out its last records
+            pros::delay(1100);
+        },
+        [&](std::uint64_t nowUs) { world.step(nowUs); });
+    const double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    const double simSeconds = world.nowUs() / 1e6;
+
+    const sim::FieldPose truth = world.truePose();
+    const lemlib::Pose odom = chassis.getPose();
+    if (options.mode != "driver") {
+        if (autonSeconds >= 0) std::printf("route %d: autonomous finished in %.2f s\n", autonRoute, autonSeconds);
+        else std::printf("route %d: autonomous did not finish inside %d s\n", autonRoute, autonRoute == 3 ? 60 : 15);
+        for (const spf::Route& route : routes) {
+            if (route.id != autonRoute) continue;
+            std::size_t corners = 0;
+            for (const spf::Segment& segment : route.segments) corners += segment.transitions.size();
+            std::printf("  profiles planned %.2f s, %zu chained corners save %.2f s\n", route.plannedTime() / 1e3,
+                        corners, route.savedTime() / 1e3);
+        }
+    }
+    std::printf("simulated %.2f s in %.3f s wall (%.0fx real time)\n", simSeconds, wallSeconds,
+                simSeconds / std::max(wallSeconds, 1e-6));
+    std::printf("true pose (%.2f, %.2f, %.1f)  odom pose (%.2f, %.2f, %.1f)  error %.2f in\n", truth.x, truth.y,
+                truth.theta, odom.x, odom.y, odom.theta, std::hypot(truth.x - odom.x, truth.y - odom.y));
+    for (const sim::AdiEvent& event : world.adiEvents()) {
+        std::printf("  %7.2f s  ADI %c -> %s\n", event.timeUs / 1e6, event.port, event.value ? "on" : "off");
+    }
+    std::printf("hottest drive motor %.1f C, thermally throttled for %.2f s\n", hottest, throttledSeconds);
+    if (!options.replay.empty()) {
+        std::printf("replay: at worst %.2f in from the recorded pose\n", input.replayError());
+    }
+    if (telemetryLog.isOpen()) {
+        std::printf("telemetry: %lu records written, %lu dropped\n", (unsigned long)telemetryLog.written(),
+                    (unsigned long)telemetryLog.dropped());
+    }
+    if (options.loopStats) {
+        spf::dumpHeap(stdout, heap);
+        scheduler.dump(stdout);
+        spf::dumpRegions(stdout);
+        std::printf("LVGL calls: %llu, %llu pixels invalidated\n", (unsigned long long)sim::lvglCalls(),
+                    (unsigned long long)sim::lvglPixels());
+        std::printf("field map: %lu frames, %.0f pixels redrawn a frame\n", (unsigned long)fieldMap.frames(),
+                    double(fieldMap.pixels()) / std::max<std::uint32_t>(fieldMap.frames(), 1));
+    }
+    if (!options.map.empty() && !sim::writeCanvas(fieldMap.canvas(), options.map.c_str())) {
+        std::fprintf(stderr, "%s: can't write the field map\n", options.map.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,349 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "lemlib/api.hpp"
+#include "main.h"
+#include "robot.hpp"
+#include "sim/parallel.hpp"
+#include "sim/runtime.hpp"
+#include "sim/world.hpp"
+#include "spf/startup.hpp"
+
+/**
+ * Tunes the LemLib motion controllers against the simulator
+ *
+ * Only LemLib's own motions use these controllers: route steps marked reactive, and autonomous code
+ * that calls the chassis directly. The profiled moves, turns and paths of a route are tracked by
+ * spf::RouteRunner with its own RAMSETE and wheel velocity feedback, which this doesn't tune.
+ *
+ * spf_tune [--generations N] [--population N] [--seeds N] [--disturbance F] [--jobs N]
+ *          [--overshoot-weight S] [--seed N]
+ *
+ * Every candidate set of constants drives a batch of step responses, straight moves and turns in
+ * place, and then a whole square route of chained motions, once in each of --seeds simulated
+ * robots. The robots differ by the disturbance model: traction, omni slide, mass, battery, motor
+ * temperature and IMU drift, spread by --disturbance (0 is the nominal robot). Every candidate
+ * sees the same robots, so the comparison between them isn't noise.
+ *
+ * The cost of a run is the time until the robot's true pose is within the controllers' small
+ * error range and stays there, plus --overshoot-weight seconds for every inch it overshot by;
+ * turns count the overshoot at the wheels. The search is a (1 + N) evolution strategy starting
+ * from the constants in main.cpp, over kP, kI, kD and slew of both controllers. The exit ranges
+ * and timeouts stay as they are, they decide when a motion is done. A slew of 0 is off and stays
+ * off. Each simulated robot runs in its own process, --jobs of them at once, by default one per
+ * host core, see sim::runParallel.
+ *
+ * At the end it prints the settling times of the constants in main.cpp next to the tuned ones,
+ * and the tuned constants ready to paste over linearController and angularController.
+ */
+
+extern lemlib::Chassis chassis;
+extern spf::Startup startup;
+
+namespace {
+
+enum class Kind { Move, Turn, Square };
+
+struct Scenario {
+        const char* name;
+        Kind kind;
+        float amount; // in for moves, degrees for turns
+};
+
+constexpr Scenario scenarios[] = {
+    {"move 12 in", Kind::Move, 12}, {"move 24 in", Kind::Move, 24}, {"move 48 in", Kind::Move, 48},
+    {"turn 30", Kind::Turn, 30},    {"turn 90", Kind::Turn, 90},    {"turn 135", Kind::Turn, 135},
+    {"square route", Kind::Square, 24},
+};
+constexpr std::size_t scenarioCount = sizeof(scenarios) / sizeof(scenarios[0]);
+
+// time the robot is watched for after the motion returns, for drifting out of the range again
+constexpr int holdMs = 500;
+// added to the cost of a run that never settled
+constexpr double unsettledPenalty = 1; // s
+// to count a turn's overshoot as wheel travel
+constexpr double halfTrack = robot.trackWidth / 2; // in
+
+struct Outcome {
+        double settle = 0; // s from the start of the motion
+        double done = 0; // s until the motion call returned
+        double overshoot = 0; // in, or degrees for turns
+        bool settled = false;
+};
+
+using Outcomes = std::array<Outcome, scenarioCount>;
+
+struct Candidate {
+        lemlib::ControllerSettings linear;
+        lemlib::ControllerSettings angular;
+};
+
+struct Options {
+        int generations = 30;
+        int population = 8;
+        int seeds = 3;
+        double disturbance = 1;
+        int jobs = 1;
+        double overshootWeight = 0.5; // s per inch
+        std::uint32_t seed = 1;
+};
+
+Options options;
+
+/** the simulated robot for one seed of the disturbance model */
+sim::WorldConfig disturbed(int index) {
+    sim::WorldConfig config;
+    config.seed = 2000 + index;
+    std::mt19937 random(config.seed);
+    std::uniform_real_distribution<double> unit(-1, 1);
+    std::uniform_real_distribution<double> positive(0, 1);
+    const double spread = options.disturbance;
+    config.traction *= 1 + 0.1 * spread * unit(random);
+    config.lateralTraction *= 1 + 0.2 * spread * unit(random);
+    config.massKg *= 1 + 0.1 * spread * unit(random);
+    config.inertiaKgM2 *= 1 + 0.1 * spread * unit(random);
+    config.batteryVolts -= 1.0 * spread * positive(random);
+    config.startTempC += 20 * spread * positive(random);
+    config.imuDriftDegPerMin = spread * unit(random);
+    return config;
+}
+
+/** drives every scenario with one candidate's constants, in one simulated robot */
+Outcomes run(const Candidate& candidate, int seed) {
+    sim::World world(disturbed(seed));
+    sim::setWorld(&world);
+    // the tuner puts the robot down itself, between scenarios
+    world.placeOnFirstSetPose = false;
+    chassis.setControllerSettings(candidate.linear, candidate.angular);
+
+    Outcomes outcomes;
+    // what the observer is measuring, set by the scenario running
+    bool watching = false;
+    std::uint64_t startUs = 0;
+    sim::FieldPose target;
+    Kind kind = Kind::Move;
+    Outcome* outcome = nullptr;
+    std::uint64_t lastOutUs = 0;
+    const double linearRange = candidate.linear.smallError;
+    const double angularRange = candidate.angular.smallError;
+
+    world.observers.push_back([&](sim::World& w) {
+        if (!watching) return;
+        const sim::FieldPose truth = w.truePose();
+        const double headingError = std::remainder(target.theta - truth.theta, 360);
+        const double distance = std::hypot(target.x - truth.x, target.y - truth.y);
+        bool inRange = true;
+        if (kind == Kind::Move) {
+            // along the direction of travel, negative once past the target
+            const double along = target.y - truth.y;
+            outcome->overshoot = std::max(outcome->overshoot, -along);
+            inRange = distance < linearRange;
+        } else if (kind == Kind::Turn) {
+            outcome->overshoot = std::max(outcome->overshoot, -headingError);
+            inRange = std::fabs(headingError) < angularRange;
+        } else {
+            inRange = distance < linearRange && std::fabs(headingError) < angularRange;
+        }
+        if (!inRange) lastOutUs = w.nowUs();
+    });
+
+    sim::Runtime::get().run(
+        [&] {
+            initialize();
+            // the robot sits on the field for a while before the match, calibrated by the time it starts
+            startup.waitReady();
+            for (std::size_t i = 0; i < scenarioCount; i++) {
+                const Scenario& scenario = scenarios[i];
+                const sim::FieldPose start = scenario.kind == Kind::Move ? sim::FieldPose {0, -24, 0}
+                                             : scenario.kind == Kind::Turn ? sim::FieldPose {0, 0, 0}
+                                                                           : sim::FieldPose {-12, -12, 0};
+                world.place(start);
+                chassis.setPose(start.x, start.y, start.theta);
+                // let odometry pick the pose up and the IMU settle
+                pros::delay(50);
+
+                kind = scenario.kind;
+                outcome = &outcomes[i];
+                target = scenario.kind == Kind::Move   ? sim::FieldPose {0, -24 + scenario.amount, 0}
+                         : scenario.kind == Kind::Turn ? sim::FieldPose {0, 0, scenario.amount}
+                                                       : start;
+                startUs = world.nowUs();
+                lastOutUs = startUs;
+                watching = true;
+                if (scenario.kind == Kind::Move) {
+                    chassis.moveToPose(target.x, target.y, 0, 3000, {}, false);
+                } else if (scenario.kind == Kind::Turn) {
+                    chassis.turnToHeading(scenario.amount, 1500, {}, false);
+                } else {
+                    const float side = scenario.amount / 2;
+                    chassis.moveToPose(-side, side, 0, 3000, {}, false);
+                    chassis.moveToPose(side, side, 90, 3000, {}, false);
+                    chassis.moveToPose(side, -side, 180, 3000, {}, false);
+                    chassis.moveToPose(-side, -side, 270, 3000, {}, false);
+                    chassis.turnToHeading(0, 1500, {}, false);
+                }
+                outcome->done = (world.nowUs() - startUs) / 1e6;
+                pros::delay(holdMs);
+                watching = false;
+                // still out of range at the end of the hold, it never settled
+                outcome->settled = world.nowUs() - lastOutUs > 1000;
+                outcome->settle = (lastOutUs - startUs) / 1e6;
+            }
+        },
+        [&](std::uint64_t nowUs) { world.step(nowUs); });
+    return outcomes;
+}
+
+/** cost of one run, in seconds */
+double cost(const Outcome& outcome, Kind kind) {
+    const double overshoot = kind == Kind::Turn ? outcome.overshoot * M_PI / 180 * halfTrack : outcome.overshoot;
+    return outcome.settle + options.overshootWeight * overshoot + (outcome.settled ? 0 : unsettledPenalty);
+}
+
+struct Evaluation {
+        Outcomes mean {}; // over the seeds
+        std::array<int, scenarioCount> unsettled {}; // runs that never settled
+        double cost = 0;
+        bool ok = false;
+};
+
+/** runs every candidate in every seed, up to --jobs at a time */
+std::vector<Evaluation> evaluate(const std::vector<Candidate>& candidates) {
+    const std::size_t seeds = options.seeds;
+    const std::vector<std::optional<Outcomes>> runs = sim::runParallel<Outcomes>(
+        candidates.size() * seeds, options.jobs,
+        [&](std::size_t i) { return run(candidates[i / seeds], int(i % seeds)); });
+
+    std::vector<Evaluation> evaluations(candidates.size());
+    for (std::size_t c = 0; c < candidates.size(); c++) {
+        Evaluation& evaluation = evaluations[c];
+        // a candidate that lost a run isn't comparable with the rest
+        evaluation.ok = std::all_of(runs.begin() + c * seeds, runs.begin() + (c + 1) * seeds,
+                                    [](const std::optional<Outcomes>& outcomes) { return outcomes.has_value(); });
+        if (!evaluation.ok) continue;
+        for (std::size_t seed = 0; seed < seeds; seed++) {
+            const Outcomes& outcomes = *runs[c * seeds + seed];
+            for (std::size_t i = 0; i < scenarioCount; i++) {
+                evaluation.mean[i].settle += outcomes[i].settle / seeds;
+                evaluation.mean[i].done += outcomes[i].done / seeds;
+                evaluation.mean[i].overshoot += outcomes[i].overshoot / seeds;
+                evaluation.cost += cost(outcomes[i], scenarios[i].kind) / seeds;
+                if (!outcomes[i].settled) evaluation.unsettled[i]++;
+            }
+        }
+    }
+    return evaluations;
+}
+
+/** a random step away from a candidate, about half the fields move by a factor around exp(step) */
+Candidate mutate(const Candidate& parent, double step, std::mt19937& random) {
+    std::normal_distribution<double> normal(0, 1);
+    std::bernoulli_distribution coin(0.5);
+    Candidate child = parent;
+    for (lemlib::ControllerSettings* settings : {&child.linear, &child.angular}) {
+        for (float* value : {&settings->kP, &settings->kD, &settings->slew}) {
+            if (coin(random) && *value > 0) *value *= std::exp(step * normal(random));
+        }
+        // kI starts at 0, so it moves by a fraction of kP rather than by a factor
+        if (coin(random)) settings->kI = std::max(0.0, settings->kI + 0.02 * settings->kP * step * normal(random));
+        settings->slew = std::min(settings->slew, 127.0f);
+    }
+    return child;
+}
+
+void printSettings(const char* name, const char* unit, const lemlib::ControllerSettings& s) {
+    const int indent = int(std::strlen(name)) + 28;
+    std::printf("lemlib::ControllerSettings %s(%.3g, // proportional gain (kP)\n", name, s.kP);
+    std::printf("%*s%.3g, // integral gain (kI)\n", indent, "", s.kI);
+    std::printf("%*s%.3g, // derivative gain (kD)\n", indent, "", s.kD);
+    std::printf("%*s%.3g, // anti windup\n", indent, "", s.windupRange);
+    std::printf("%*s%.3g, // small error range, in %s\n", indent, "", s.smallError, unit);
+    std::printf("%*s%.3g, // small error range timeout, in milliseconds\n", indent, "", s.smallErrorTimeout);
+    std::printf("%*s%.3g, // large error range, in %s\n", indent, "", s.largeError, unit);
+    std::printf("%*s%.3g, // large error range timeout, in milliseconds\n", indent, "", s.largeErrorTimeout);
+    std::printf("%*s%.3g // maximum acceleration (slew)\n", indent, "", s.slew);
+    std::printf(");\n");
+}
+
+bool parse(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--generations") && hasValue) options.generations = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--population") && hasValue) options.population = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--seeds") && hasValue) options.seeds = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--disturbance") && hasValue) options.disturbance = std::atof(argv[++i]);
+        else if (!std::strcmp(argv[i], "--jobs") && hasValue) options.jobs = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--overshoot-weight") && hasValue) options.overshootWeight = std::atof(argv[++i]);
+        else if (!std::strcmp(argv[i], "--seed") && hasValue) options.seed = std::strtoul(argv[++i], nullptr, 10);
+        else return false;
+    }
+    return options.generations >= 0 && options.population > 0 && options.seeds > 0 && options.jobs > 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    options.jobs = sim::hostCores();
+    if (!parse(argc, argv)) {
+        std::fprintf(stderr, "usage: spf_tune [--generations N] [--population N] [--seeds N] [--disturbance F]\n"
+                             "                [--jobs N] [--overshoot-weight S] [--seed N]\n");
+        return 2;
+    }
+    lemlib::telemetrySink()->enabled = false;
+
+    const Candidate current {chassis.getLateralSettings(), chassis.getAngularSettings()};
+    const Evaluation baseline = evaluate({current})[0];
+    if (!baseline.ok) {
+        std::fprintf(stderr, "the simulated runs of the current constants failed\n");
+        return 1;
+    }
+    std::printf("%d generations of %d, %d simulated robots each, %d jobs\n", options.generations, options.population,
+                options.seeds, options.jobs);
+    std::printf("current constants: cost %.3f s\n", baseline.cost);
+
+    std::mt19937 random(options.seed);
+    Candidate best = current;
+    Evaluation bestEvaluation = baseline;
+    double step = 0.3;
+    for (int generation = 1; generation <= options.generations; generation++) {
+        std::vector<Candidate> children;
+        for (int i = 0; i < options.population; i++) children.push_back(mutate(best, step, random));
+        const std::vector<Evaluation> evaluations = evaluate(children);
+        bool improved = false;
+        for (std::size_t i = 0; i < children.size(); i++) {
+            if (!evaluations[i].ok || evaluations[i].cost >= bestEvaluation.cost) continue;
+            best = children[i];
+            bestEvaluation = evaluations[i];
+            improved = true;
+        }
+        // the 1/5th rule, roughly: search wider while it's finding better constants
+        step = std::clamp(improved ? step * 1.3 : step * 0.8, 0.05, 1.0);
+        std::printf("generation %d: cost %.3f s, step %.2f\n", generation, bestEvaluation.cost, step);
+    }
+
+    std::printf("\n%-14s | %-25s | %-25s\n", "", "current", "tuned");
+    std::printf("%-14s | %7s  %7s %8s | %7s  %7s %8s\n", "", "settle", "done", "overshot", "settle", "done",
+                "overshot");
+    for (std::size_t i = 0; i < scenarioCount; i++) {
+        const Outcome& a = baseline.mean[i];
+        const Outcome& b = bestEvaluation.mean[i];
+        std::printf("%-14s | %7.2f%c %7.2f %8.2f | %7.2f%c %7.2f %8.2f\n", scenarios[i].name, a.settle,
+                    baseline.unsettled[i] > 0 ? '*' : ' ', a.done, a.overshoot, b.settle,
+                    bestEvaluation.unsettled[i] > 0 ? '*' : ' ', b.done, b.overshoot);
+    }
+    std::printf("%-14s | %7.2f  %16s | %7.2f\n", "cost", baseline.cost, "", bestEvaluation.cost);
+    std::printf("times in seconds, means over the simulated robots, overshoot in inches or degrees\n");
+    std::printf("* some runs never settled, their time is the end of the %d ms hold\n", holdMs);
+    std::printf("\n// lateral motion controller\n");
+    printSettings("linearController", "inches", best.linear);
+    std::printf("\n// angular motion controller\n");
+    printSettings("angularController", "degrees", best.angular);
+    return 0;
+}